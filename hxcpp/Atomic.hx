@@ -0,0 +1,92 @@
+package hxcpp;
+
+import haxe.Int32;
+import haxe.Int64;
+
+// Lock-free shared values.  Loads are acquire, stores release, and add/exchange/cas
+//  are full barriers.
+
+class AtomicInt
+{
+   var handle:Dynamic;
+
+   public function new(inValue:Int = 0) { handle = untyped __global__.__hxcpp_atomic_int_create(inValue); }
+
+   public function load():Int { return untyped __global__.__hxcpp_atomic_int_load(handle); }
+   public function store(inValue:Int):Void { untyped __global__.__hxcpp_atomic_int_store(handle,inValue); }
+   // Returns the previous value
+   public function add(inDelta:Int):Int { return untyped __global__.__hxcpp_atomic_int_add(handle,inDelta); }
+   public function exchange(inValue:Int):Int { return untyped __global__.__hxcpp_atomic_int_exchange(handle,inValue); }
+   public function cas(inExpected:Int, inValue:Int):Bool
+   {
+      return untyped __global__.__hxcpp_atomic_int_cas(handle,inExpected,inValue);
+   }
+}
+
+// 64-bit counter, as a haxe.Int64.  Values cross to the runtime as their high and low
+//  32-bit halves, so the whole range is exact.
+class AtomicInt64
+{
+   var handle:Dynamic;
+
+   public function new(?inValue:Int64)
+   {
+      handle = inValue==null ? untyped __global__.__hxcpp_atomic_int64_create(0,0) :
+               untyped __global__.__hxcpp_atomic_int64_create(high(inValue),low(inValue));
+   }
+
+   public function load():Int64 { return join(untyped __global__.__hxcpp_atomic_int64_load(handle)); }
+   public function store(inValue:Int64):Void
+   {
+      untyped __global__.__hxcpp_atomic_int64_store(handle,high(inValue),low(inValue));
+   }
+   public function add(inDelta:Int64):Int64
+   {
+      return join(untyped __global__.__hxcpp_atomic_int64_add(handle,high(inDelta),low(inDelta)));
+   }
+   public function exchange(inValue:Int64):Int64
+   {
+      return join(untyped __global__.__hxcpp_atomic_int64_exchange(handle,high(inValue),low(inValue)));
+   }
+   public function cas(inExpected:Int64, inValue:Int64):Bool
+   {
+      return untyped __global__.__hxcpp_atomic_int64_cas(handle,high(inExpected),low(inExpected),
+                                                         high(inValue),low(inValue));
+   }
+
+   // haxe.Int32 is a plain Int from haxe 3, but a cpp::CppInt32__ before that
+   static inline function high(inValue:Int64):Int
+   {
+      #if haxe3 return Int64.getHigh(inValue); #else return Int32.toNativeInt(Int64.getHigh(inValue)); #end
+   }
+   static inline function low(inValue:Int64):Int
+   {
+      #if haxe3 return Int64.getLow(inValue); #else return Int32.toNativeInt(Int64.getLow(inValue)); #end
+   }
+   static inline function join(inHalves:Array<Int>):Int64
+   {
+      #if haxe3 return Int64.make(inHalves[0],inHalves[1]);
+      #else return Int64.make(Int32.ofInt(inHalves[0]),Int32.ofInt(inHalves[1])); #end
+   }
+}
+
+// Object reference.  cas compares identity, so boxed numbers and strings rarely match.
+class AtomicObject<T>
+{
+   var handle:Dynamic;
+
+   public function new(?inValue:T) { handle = untyped __global__.__hxcpp_atomic_object_create(inValue); }
+
+   public function load():T { return untyped __global__.__hxcpp_atomic_object_load(handle); }
+   public function store(inValue:T):Void { untyped __global__.__hxcpp_atomic_object_store(handle,inValue); }
+   public function exchange(inValue:T):T { return untyped __global__.__hxcpp_atomic_object_exchange(handle,inValue); }
+   public function cas(inExpected:T, inValue:T):Bool
+   {
+      return untyped __global__.__hxcpp_atomic_object_cas(handle,inExpected,inValue);
+   }
+}
+
+class Atomic
+{
+   public static inline function fence():Void { untyped __global__.__hxcpp_atomic_fence(); }
+}
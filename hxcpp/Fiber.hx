@@ -0,0 +1,75 @@
+package hxcpp;
+
+// Stackful coroutine.  resume runs the function on the fiber's own stack until it calls
+//  Fiber.yield or returns; the yielded (or returned) value comes back from resume, and
+//  the next resume value comes back from yield.  Exceptions propagate out of resume.
+// A suspended fiber that is no longer referenced is collected along with its stack.
+
+class Fiber
+{
+   public static inline var NEW = 0;
+   public static inline var RUNNING = 1;
+   public static inline var SUSPENDED = 2;
+   public static inline var DONE = 3;
+
+   var handle:Dynamic;
+
+   // inStackSize of 0 uses the default (64k, or HXCPP_FIBER_STACK_SIZE)
+   public function new(inFunc:Void->Dynamic, inStackSize:Int = 0)
+   {
+      handle = untyped __global__.__hxcpp_fiber_create(inFunc,inStackSize);
+   }
+
+   public function resume(?inValue:Dynamic):Dynamic
+   {
+      return untyped __global__.__hxcpp_fiber_resume(handle,inValue);
+   }
+
+   public var state(get,never):Int;
+   function get_state():Int { return untyped __global__.__hxcpp_fiber_state(handle); }
+
+   public var done(get,never):Bool;
+   function get_done():Bool { return state==DONE; }
+
+   public static function yield(?inValue:Dynamic):Dynamic
+   {
+      return untyped __global__.__hxcpp_fiber_yield(inValue);
+   }
+
+   public static function inFiber():Bool
+   {
+      return untyped __global__.__hxcpp_fiber_current()!=null;
+   }
+}
+
+// Round-robin scheduler: run resumes each spawned fiber in turn until all have finished.
+class FiberScheduler
+{
+   var queue:Array<Fiber>;
+   var stackSize:Int;
+
+   public function new(inStackSize:Int = 0)
+   {
+      queue = [];
+      stackSize = inStackSize;
+   }
+
+   public function spawn(inFunc:Void->Void):Void
+   {
+      queue.push( new Fiber(function() { inFunc(); return null; }, stackSize) );
+   }
+
+   // Called from a spawned function to let the others run
+   public static function pause():Void { Fiber.yield(); }
+
+   public function run():Void
+   {
+      while(queue.length>0)
+      {
+         var fiber = queue.shift();
+         fiber.resume();
+         if (!fiber.done)
+            queue.push(fiber);
+      }
+   }
+}
@@ -0,0 +1,20 @@
+package hxcpp;
+
+// Fixed-length array of single precision floats, stored as Array<cpp.Float32>, so it takes
+//  half the memory of an Array<Float>.  Stored values are rounded to float precision.
+// See PackedArray for the rest of the interface.
+@:forward(length,getData,blit,fill,toArray)
+abstract Float32Array(PackedArray<cpp.Float32,Float>) from PackedArray<cpp.Float32,Float> to PackedArray<cpp.Float32,Float>
+{
+   public inline function new(inLength:Int) { this = new PackedArray<cpp.Float32,Float>(inLength); }
+
+   @:arrayAccess public inline function get(inIndex:Int):Float { return this.get(inIndex); }
+
+   @:arrayAccess public inline function set(inIndex:Int,inValue:Float):Float { return this.set(inIndex,inValue); }
+
+   public static inline function fromArray(inValues:Array<Float>):Float32Array
+   {
+      var data:PackedArray<cpp.Float32,Float> = PackedArray.fromArray(inValues);
+      return data;
+   }
+}
@@ -0,0 +1,20 @@
+package hxcpp;
+
+// Fixed-length array of 16-bit signed integers, stored as Array<cpp.Int16>, so it takes
+//  half the memory of an Array<Int>.  Stored values are truncated to 16 bits.
+// See PackedArray for the rest of the interface.
+@:forward(length,getData,blit,fill,toArray)
+abstract Int16Array(PackedArray<cpp.Int16,Int>) from PackedArray<cpp.Int16,Int> to PackedArray<cpp.Int16,Int>
+{
+   public inline function new(inLength:Int) { this = new PackedArray<cpp.Int16,Int>(inLength); }
+
+   @:arrayAccess public inline function get(inIndex:Int):Int { return this.get(inIndex); }
+
+   @:arrayAccess public inline function set(inIndex:Int,inValue:Int):Int { return this.set(inIndex,inValue); }
+
+   public static inline function fromArray(inValues:Array<Int>):Int16Array
+   {
+      var data:PackedArray<cpp.Int16,Int> = PackedArray.fromArray(inValues);
+      return data;
+   }
+}
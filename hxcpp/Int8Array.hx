@@ -0,0 +1,20 @@
+package hxcpp;
+
+// Fixed-length array of 8-bit signed integers, stored as Array<cpp.Int8>.
+// Stored values are truncated to -128...127.
+// See PackedArray for the rest of the interface.
+@:forward(length,getData,blit,fill,toArray)
+abstract Int8Array(PackedArray<cpp.Int8,Int>) from PackedArray<cpp.Int8,Int> to PackedArray<cpp.Int8,Int>
+{
+   public inline function new(inLength:Int) { this = new PackedArray<cpp.Int8,Int>(inLength); }
+
+   @:arrayAccess public inline function get(inIndex:Int):Int { return this.get(inIndex); }
+
+   @:arrayAccess public inline function set(inIndex:Int,inValue:Int):Int { return this.set(inIndex,inValue); }
+
+   public static inline function fromArray(inValues:Array<Int>):Int8Array
+   {
+      var data:PackedArray<cpp.Int8,Int> = PackedArray.fromArray(inValues);
+      return data;
+   }
+}
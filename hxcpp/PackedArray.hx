@@ -0,0 +1,56 @@
+package hxcpp;
+
+// Fixed-length array kept as compact STORE elements (eg. cpp.Int16) and read and written
+//  as VALUE (eg. Int).  Int8Array, Int16Array, UInt16Array and Float32Array are built on it.
+// Everything is inline, so the generated code always names the real element type.
+// Element access, blit and fill throw for positions outside 0...length.
+abstract PackedArray<STORE,VALUE>(Array<STORE>)
+{
+   public var length(get,never):Int;
+
+   public inline function new(inLength:Int)
+   {
+      this = new Array<STORE>();
+      if (inLength>0)
+         untyped this.__SetSizeExact(inLength);
+   }
+
+   inline function get_length():Int { return this.length; }
+
+   public inline function get(inIndex:Int):VALUE
+   {
+      return untyped this.__checked_get(inIndex);
+   }
+
+   public inline function set(inIndex:Int,inValue:VALUE):VALUE
+   {
+      untyped this.__checked_set(inIndex,inValue);
+      return inValue;
+   }
+
+   public inline function getData():Array<STORE> { return this; }
+
+   public inline function blit(inDestElement:Int, inSource:PackedArray<STORE,VALUE>, inSourceElement:Int, inElementCount:Int)
+   {
+      untyped this.__checked_blit(inDestElement,inSource.getData(),inSourceElement,inElementCount);
+   }
+
+   public inline function fill(inValue:VALUE, inPos:Int, inLen:Int)
+   {
+      untyped this.__checked_fill(inValue,inPos,inLen);
+   }
+
+   public static inline function fromArray<STORE,VALUE>(inValues:Array<VALUE>):PackedArray<STORE,VALUE>
+   {
+      var result = new PackedArray<STORE,VALUE>(0);
+      untyped result.getData().__convert_from(inValues);
+      return result;
+   }
+
+   public inline function toArray():Array<VALUE>
+   {
+      var result = new Array<VALUE>();
+      untyped result.__convert_from(this);
+      return result;
+   }
+}
@@ -0,0 +1,67 @@
+package hxcpp;
+
+// Synchronisation primitives that hold no OS handles, so they need no finalizer.
+// Threads spin briefly, then sleep on a futex, only entering a GC-free zone when they
+//  actually block.  Timeouts are in seconds on a monotonic clock; negative waits forever.
+
+// Recursive mutex
+class FastMutex
+{
+   @:allow(hxcpp.Condition)
+   var handle:Dynamic;
+
+   public function new() { handle = untyped __global__.__hxcpp_fast_mutex_create(); }
+
+   public function acquire():Void { untyped __global__.__hxcpp_fast_mutex_acquire(handle); }
+   public function tryAcquire():Bool { return untyped __global__.__hxcpp_fast_mutex_try(handle); }
+   public function release():Void { untyped __global__.__hxcpp_fast_mutex_release(handle); }
+}
+
+// Many readers or one writer.  Waiting writers hold off new readers.  Not recursive.
+class RWLock
+{
+   var handle:Dynamic;
+
+   public function new() { handle = untyped __global__.__hxcpp_rwlock_create(); }
+
+   public function readAcquire():Void { untyped __global__.__hxcpp_rwlock_read_acquire(handle); }
+   public function readRelease():Void { untyped __global__.__hxcpp_rwlock_read_release(handle); }
+   public function writeAcquire():Void { untyped __global__.__hxcpp_rwlock_write_acquire(handle); }
+   public function writeRelease():Void { untyped __global__.__hxcpp_rwlock_write_release(handle); }
+}
+
+// Condition variable for use with a FastMutex.  Wakes may be spurious.
+class Condition
+{
+   var handle:Dynamic;
+
+   public function new() { handle = untyped __global__.__hxcpp_condition_create(); }
+
+   // Returns false on timeout
+   public function wait(inMutex:FastMutex, inTimeout:Float = -1):Bool
+   {
+      return untyped __global__.__hxcpp_condition_wait(handle,inMutex.handle,inTimeout);
+   }
+   public function signal():Void { untyped __global__.__hxcpp_condition_signal(handle); }
+   public function broadcast():Void { untyped __global__.__hxcpp_condition_broadcast(handle); }
+}
+
+// Releases waiters once countDown has been called inCount times
+class Latch
+{
+   var handle:Dynamic;
+
+   public var count(get,never):Int;
+
+   public function new(inCount:Int) { handle = untyped __global__.__hxcpp_latch_create(inCount); }
+
+   function get_count():Int { return untyped __global__.__hxcpp_latch_count(handle); }
+
+   public function countDown():Void { untyped __global__.__hxcpp_latch_count_down(handle); }
+
+   // Returns false on timeout
+   public function wait(inTimeout:Float = -1):Bool
+   {
+      return untyped __global__.__hxcpp_latch_wait(handle,inTimeout);
+   }
+}
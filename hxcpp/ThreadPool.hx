@@ -0,0 +1,58 @@
+package hxcpp;
+
+// Result of a task submitted to a ThreadPool, or a promise completed by hand.
+// get() blocks until the value is available, and rethrows if the task threw.
+// A task that has not started is run by the caller, so tasks may get() their subtasks.
+class Future<T>
+{
+   var handle:Dynamic;
+
+   public function new(?inHandle:Dynamic)
+   {
+      handle = inHandle==null ? untyped __global__.__hxcpp_future_create() : inHandle;
+   }
+
+   public function isDone():Bool
+   {
+      return untyped __global__.__hxcpp_future_done(handle);
+   }
+
+   public function get():T
+   {
+      return untyped __global__.__hxcpp_future_get(handle);
+   }
+
+   // Returns false if the future has already completed
+   public function complete(inValue:T):Bool
+   {
+      return untyped __global__.__hxcpp_future_complete(handle,inValue,false);
+   }
+
+   public function fail(inError:Dynamic):Bool
+   {
+      return untyped __global__.__hxcpp_future_complete(handle,inError,true);
+   }
+}
+
+// Fixed set of worker threads with per-worker queues and work stealing.
+class ThreadPool
+{
+   var handle:Dynamic;
+
+   public function new(inWorkers:Int)
+   {
+      handle = untyped __global__.__hxcpp_pool_create(inWorkers);
+   }
+
+   public function submit<T>(inTask:Void->T):Future<T>
+   {
+      return new Future<T>( untyped __global__.__hxcpp_pool_submit(handle,inTask) );
+   }
+
+   // Workers finish the queued tasks, then exit.  Returns once they have, unless called
+   //  from one of this pool's tasks, which can not wait for itself.
+   public function shutdown():Void
+   {
+      untyped __global__.__hxcpp_pool_shutdown(handle);
+   }
+}
@@ -0,0 +1,20 @@
+package hxcpp;
+
+// Fixed-length array of 16-bit unsigned integers, stored as Array<cpp.UInt16>.
+// Stored values wrap to 0...65535.
+// See PackedArray for the rest of the interface.
+@:forward(length,getData,blit,fill,toArray)
+abstract UInt16Array(PackedArray<cpp.UInt16,Int>) from PackedArray<cpp.UInt16,Int> to PackedArray<cpp.UInt16,Int>
+{
+   public inline function new(inLength:Int) { this = new PackedArray<cpp.UInt16,Int>(inLength); }
+
+   @:arrayAccess public inline function get(inIndex:Int):Int { return this.get(inIndex); }
+
+   @:arrayAccess public inline function set(inIndex:Int,inValue:Int):Int { return this.set(inIndex,inValue); }
+
+   public static inline function fromArray(inValues:Array<Int>):UInt16Array
+   {
+      var data:PackedArray<cpp.UInt16,Int> = PackedArray.fromArray(inValues);
+      return data;
+   }
+}
@@ -15,6 +15,9 @@ template<> struct ReturnNull<int> { typedef Dynamic type; };
 template<> struct ReturnNull<double> { typedef Dynamic type; };
 template<> struct ReturnNull<float> { typedef Dynamic type; };
 template<> struct ReturnNull<bool> { typedef Dynamic type; };
+template<> struct ReturnNull<signed char> { typedef Dynamic type; };
+template<> struct ReturnNull<short> { typedef Dynamic type; };
+template<> struct ReturnNull<unsigned short> { typedef Dynamic type; };
 // ? template<> struct ReturnNull<unsigned char> { typedef Dynamic type; };
 
 }
@@ -49,8 +52,8 @@ public:
    void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER_NAME(mArray,"mArray"); }
    #endif
 
-   int      mIdx;
    Array<FROM> mArray;
+   int      mIdx;
 };
 
 }
@@ -97,6 +100,8 @@ public:
 
    // Dynamic interface
    Dynamic __Field(const String &inString ,bool inCallProp);
+   // Calls a method with an argument span, without making a closure for it.  For CFFI val_ocall.
+   Dynamic __FieldCall(const String &inName,const Dynamic *inArgs,int inArgCount);
    virtual Dynamic __concat(const Dynamic &a0) = 0;
    virtual Dynamic __copy() = 0;
    virtual Dynamic __insert(const Dynamic &a0,const Dynamic &a1) = 0;
@@ -114,6 +119,8 @@ public:
    virtual Dynamic __unshift(const Dynamic &a0) = 0;
    virtual Dynamic __map(const Dynamic &func) = 0;
    virtual Dynamic __filter(const Dynamic &func) = 0;
+   virtual Dynamic __indexOf(const Dynamic &a0,const Dynamic &a1) = 0;
+   virtual Dynamic __lastIndexOf(const Dynamic &a0,const Dynamic &a1) = 0;
 
 
    Dynamic concat_dyn();
@@ -133,6 +140,8 @@ public:
    Dynamic unshift_dyn();
    Dynamic map_dyn();
    Dynamic filter_dyn();
+   Dynamic indexOf_dyn();
+   Dynamic lastIndexOf_dyn();
 
    void EnsureSize(int inLen) const;
 
@@ -151,7 +160,8 @@ public:
    void reserve(int inN);
 
 
-   String join(String inSeparator);
+   // Generic version - converts each item with ItemString.  Array_obj uses typed versions where possible.
+   virtual String join(String inSeparator);
 
 
    virtual bool AllocAtomic() const { return false; }
@@ -161,10 +171,34 @@ public:
 
    mutable int length;
 protected:
+   // Move the live elements back to the start of the allocation
+   void Compact() const;
+   void ReserveHead();
+
    mutable int mAlloc;
+   // Number of unused element slots before mBase - allows O(1) shift/unshift
+   mutable int mOffset;
    mutable char  *mBase;
 };
 
+
+// Typed join - these format the elements straight into the result buffer
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const int *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const double *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const float *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const bool *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const unsigned char *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const signed char *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const short *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const unsigned short *inData,const String &inSeparator);
+HXCPP_EXTERN_CLASS_ATTRIBUTES String ArrayJoin(ArrayBase *inArray,const String *inData,const String &inSeparator);
+
+template<typename T>
+inline String ArrayJoin(ArrayBase *inArray,const T *,const String &inSeparator)
+{
+   return inArray->ArrayBase::join(inSeparator);
+}
+
 } // end namespace ArrayBase
 
 // --- Array_obj ------------------------------------------------------------------
@@ -182,6 +216,9 @@ template<> inline bool TypeContainsPointers(int *) { return false; }
 template<> inline bool TypeContainsPointers(double *) { return false; }
 template<> inline bool TypeContainsPointers(float *) { return false; }
 template<> inline bool TypeContainsPointers(unsigned char *) { return false; }
+template<> inline bool TypeContainsPointers(signed char *) { return false; }
+template<> inline bool TypeContainsPointers(short *) { return false; }
+template<> inline bool TypeContainsPointers(unsigned short *) { return false; }
 
 template<typename TYPE> inline bool ContainsPointers()
 {
@@ -198,6 +235,9 @@ template<> inline bool *NewNull<bool>() { bool b=0; return (bool *)hx::NewGCPriv
 template<> inline double *NewNull<double>() { double d=0.0; return (double *)hx::NewGCPrivate(&d,sizeof(d)); }
 template<> inline float *NewNull<float>() { float d=0.0f; return (float *)hx::NewGCPrivate(&d,sizeof(d)); }
 template<> inline unsigned char *NewNull<unsigned char>() { unsigned char u=0; return (unsigned char *)hx::NewGCPrivate(&u,sizeof(u)); }
+template<> inline signed char *NewNull<signed char>() { signed char c=0; return (signed char *)hx::NewGCPrivate(&c,sizeof(c)); }
+template<> inline short *NewNull<short>() { short s=0; return (short *)hx::NewGCPrivate(&s,sizeof(s)); }
+template<> inline unsigned short *NewNull<unsigned short>() { unsigned short s=0; return (unsigned short *)hx::NewGCPrivate(&s,sizeof(s)); }
 
 }
 
@@ -205,6 +245,106 @@ template<> inline unsigned char *NewNull<unsigned char>() { unsigned char u=0; r
 #include <algorithm>
 
 
+namespace hx
+{
+// Linear equality search over the array contents.
+// The primitive versions are plain C++, unrolled by eight with the comparisons ORed together,
+//  so there is one branch per block rather than per element.  There are no vector
+//  intrinsics - any vectorising is up to the compiler.  Bytes use the library memchr.
+template<typename T>
+inline int ArrayFind(const T *inData, int inFrom, int inTo, const T &inValue)
+{
+   for(int i=inFrom;i<inTo;i++)
+      if (inData[i]==inValue)
+         return i;
+   return -1;
+}
+
+template<typename T>
+inline int ArrayFindUnrolled(const T *inData, int inFrom, int inTo, T inValue)
+{
+   int i = inFrom;
+   for( ;i+8<=inTo;i+=8)
+   {
+      const T *e = inData + i;
+      if ( (e[0]==inValue) | (e[1]==inValue) | (e[2]==inValue) | (e[3]==inValue) |
+           (e[4]==inValue) | (e[5]==inValue) | (e[6]==inValue) | (e[7]==inValue) )
+         break;
+   }
+   for( ;i<inTo;i++)
+      if (inData[i]==inValue)
+         return i;
+   return -1;
+}
+
+template<> inline int ArrayFind(const int *inData, int inFrom, int inTo, const int &inValue)
+   { return ArrayFindUnrolled(inData,inFrom,inTo,inValue); }
+template<> inline int ArrayFind(const double *inData, int inFrom, int inTo, const double &inValue)
+   { return ArrayFindUnrolled(inData,inFrom,inTo,inValue); }
+template<> inline int ArrayFind(const float *inData, int inFrom, int inTo, const float &inValue)
+   { return ArrayFindUnrolled(inData,inFrom,inTo,inValue); }
+template<> inline int ArrayFind(const short *inData, int inFrom, int inTo, const short &inValue)
+   { return ArrayFindUnrolled(inData,inFrom,inTo,inValue); }
+template<> inline int ArrayFind(const unsigned short *inData, int inFrom, int inTo, const unsigned short &inValue)
+   { return ArrayFindUnrolled(inData,inFrom,inTo,inValue); }
+template<> inline int ArrayFind(const signed char *inData, int inFrom, int inTo, const signed char &inValue)
+{
+   if (inFrom>=inTo) return -1;
+   const signed char *found = (const signed char *)memchr(inData+inFrom, (unsigned char)inValue, inTo-inFrom);
+   return found ? (int)(found-inData) : -1;
+}
+template<> inline int ArrayFind(const unsigned char *inData, int inFrom, int inTo, const unsigned char &inValue)
+{
+   if (inFrom>=inTo) return -1;
+   const unsigned char *found = (const unsigned char *)memchr(inData+inFrom, inValue, inTo-inFrom);
+   return found ? (int)(found-inData) : -1;
+}
+
+
+template<typename T>
+inline int ArrayFindLast(const T *inData, int inFrom, const T &inValue)
+{
+   for(int i=inFrom;i>=0;i--)
+      if (inData[i]==inValue)
+         return i;
+   return -1;
+}
+
+template<typename T>
+inline int ArrayFindLastUnrolled(const T *inData, int inFrom, T inValue)
+{
+   int i = inFrom;
+   for( ;i>=7;i-=8)
+   {
+      const T *e = inData + i - 7;
+      if ( (e[0]==inValue) | (e[1]==inValue) | (e[2]==inValue) | (e[3]==inValue) |
+           (e[4]==inValue) | (e[5]==inValue) | (e[6]==inValue) | (e[7]==inValue) )
+         break;
+   }
+   for( ;i>=0;i--)
+      if (inData[i]==inValue)
+         return i;
+   return -1;
+}
+
+template<> inline int ArrayFindLast(const int *inData, int inFrom, const int &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const double *inData, int inFrom, const double &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const float *inData, int inFrom, const float &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const unsigned char *inData, int inFrom, const unsigned char &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const signed char *inData, int inFrom, const signed char &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const short *inData, int inFrom, const short &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+template<> inline int ArrayFindLast(const unsigned short *inData, int inFrom, const unsigned short &inValue)
+   { return ArrayFindLastUnrolled(inData,inFrom,inValue); }
+
+}
+
+
 template<typename T>
 struct ArrayTraits { enum { IsByteArray = 0, IsDynamic = 0 }; };
 template<>
@@ -265,13 +405,22 @@ public:
          for(int i=0;i<length;i++)
             HX_MARK_MEMBER(ptr[i]);
       }
-      HX_MARK_ARRAY(mBase);
+      if (mBase)
+      {
+         char *alloc = mBase - mOffset*sizeof(ELEM_);
+         HX_MARK_ARRAY(alloc);
+      }
    }
 
    #ifdef HXCPP_VISIT_ALLOCS
    void __Visit(hx::VisitContext *__inCtx)
    {
-      HX_VISIT_ARRAY(mBase);
+      if (mBase)
+      {
+         char *alloc = mBase - mOffset*sizeof(ELEM_);
+         HX_VISIT_ARRAY(alloc);
+         mBase = alloc + mOffset*sizeof(ELEM_);
+      }
       if (hx::ContainsPointers<ELEM_>())
       {
          ELEM_ *ptr = (ELEM_ *)mBase;
@@ -294,6 +443,8 @@ public:
 
    Array_obj<ELEM_> *Add(const ELEM_ &inItem) { push(inItem); return this; }
 
+   String join(String inSeparator) { return hx::ArrayJoin(this,(const ELEM_ *)mBase,inSeparator); }
+
 
    // Haxe API
    inline int push( const ELEM_ &inVal )
@@ -314,26 +465,40 @@ public:
 
    int Find(ELEM_ inValue)
    {
-      ELEM_ *e = (ELEM_ *)mBase;
-      for(int i=0;i<length;i++)
-         if (e[i]==inValue)
-            return i;
-      return -1;
+      return hx::ArrayFind((const ELEM_ *)mBase,0,(int)length,inValue);
    }
 
-
-   bool remove(ELEM_ inValue)
+   int indexOf(ELEM_ inValue, Dynamic fromIndex = null())
    {
-      ELEM_ *e = (ELEM_ *)mBase;
-      for(int i=0;i<length;i++)
+      int from = fromIndex==null() ? 0 : fromIndex->__ToInt();
+      if (from<0)
       {
-         if (e[i]==inValue)
-         {
-            RemoveElement((int)i);
-            return true;
-         }
+         from += length;
+         if (from<0) from = 0;
       }
-      return false;
+      return hx::ArrayFind((const ELEM_ *)mBase,from,(int)length,inValue);
+   }
+
+   int lastIndexOf(ELEM_ inValue, Dynamic fromIndex = null())
+   {
+      int from = fromIndex==null() ? length-1 : fromIndex->__ToInt();
+      if (from<0)
+         from += length;
+      else if (from>=length)
+         from = length-1;
+      return hx::ArrayFindLast((const ELEM_ *)mBase,from,inValue);
+   }
+
+   bool contains(ELEM_ inValue) { return Find(inValue)>=0; }
+
+
+   bool remove(ELEM_ inValue)
+   {
+      int idx = Find(inValue);
+      if (idx<0)
+         return false;
+      RemoveElement(idx);
+      return true;
    }
 
    NullType shift()
@@ -345,6 +510,28 @@ public:
    }
 
 
+   // Bulk operations - these work on the raw element memory
+   void blit(int inDestElement, Array<ELEM_> inSourceArray, int inSourceElement, int inElementCount);
+   void fill(ELEM_ inValue, int inPos, int inLen);
+
+   // Fixed-length forms for the typed array wrappers (hxcpp.Int16Array etc).
+   // These throw for anything outside 0...length, rather than growing or returning null.
+   inline ELEM_ __checked_get(int inIndex) const
+   {
+      if ((unsigned int)inIndex>=(unsigned int)length) hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+      return * (ELEM_ *)(mBase + inIndex*sizeof(ELEM_));
+   }
+   inline ELEM_ __checked_set(int inIndex, ELEM_ inValue)
+   {
+      if ((unsigned int)inIndex>=(unsigned int)length) hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+      return * (ELEM_ *)(mBase + inIndex*sizeof(ELEM_)) = inValue;
+   }
+   void __checked_blit(int inDestElement, Array<ELEM_> inSourceArray, int inSourceElement, int inElementCount);
+   void __checked_fill(ELEM_ inValue, int inPos, int inLen);
+   // Replaces the elements with inSource's, converted to ELEM_ (their fromArray/toArray)
+   template<typename FROM>
+   void __convert_from(Array<FROM> inSource);
+
    Array<ELEM_> concat( Array<ELEM_> inTail );
    Array<ELEM_> copy( );
    Array<ELEM_> slice(int inPos, Dynamic end = null());
@@ -352,6 +539,36 @@ public:
    Dynamic map(Dynamic inFunc);
    Array<ELEM_> filter(Dynamic inFunc);
 
+   // Typed forms for callers that hold a C++ function or functor, so elements and results
+   //  are passed unboxed.  eg. a->mapTyped<double>(toFloat), a->filterTyped(isOdd)
+   // map/filter above take these paths for closures made by hx::CreateTypedFunction1.
+   template<typename RESULT,typename FUNC>
+   Array<RESULT> mapTyped(FUNC inFunc)
+   {
+      Array<RESULT> result = Array_obj<RESULT>::__new(0,0);
+      result->__SetSizeExact(length);
+      // The function may collect, which can move the result buffer - so no cached base pointer
+      for(int i=0;i<length;i++)
+      {
+         RESULT value = inFunc(__unsafe_get(i));
+         result->__unsafe_set(i,value);
+      }
+      return result;
+   }
+
+   template<typename FUNC>
+   Array<ELEM_> filterTyped(FUNC inFunc)
+   {
+      Array_obj *result = new Array_obj(0,0);
+      for(int i=0;i<length;i++)
+      {
+         ELEM_ item = __unsafe_get(i);
+         if (inFunc(item))
+            result->push(item);
+      }
+      return result;
+   }
+
    void insert(int inPos, ELEM_ inValue)
    {
 		if (inPos<0)
@@ -426,6 +643,8 @@ public:
    virtual Dynamic __unshift(const Dynamic &a0) { unshift(a0); return null(); }
    virtual Dynamic __map(const Dynamic &func) { return map(func); }
    virtual Dynamic __filter(const Dynamic &func) { return filter(func); }
+   virtual Dynamic __indexOf(const Dynamic &a0,const Dynamic &a1) { return indexOf(a0,a1); }
+   virtual Dynamic __lastIndexOf(const Dynamic &a0,const Dynamic &a1) { return lastIndexOf(a0,a1); }
 };
 
 
@@ -475,7 +694,7 @@ public:
       Array_obj<SOURCE_> *ptr = inRHS.GetPtr(); 
       if (ptr)
       {
-         OBJ_ *arr = dynamic_cast<OBJ_ *>(ptr);
+         OBJ_ *arr = hx::DynamicCast<OBJ_>(ptr);
          if (!arr)
          {
             // Non-identical type (syntactically, should be creating from Array<Dynamic>)
@@ -496,7 +715,7 @@ public:
       hx::Object *ptr = inRHS.GetPtr(); 
       if (ptr)
       {
-         OBJ_ *arr = dynamic_cast<OBJ_ *>(ptr);
+         OBJ_ *arr = hx::DynamicCast<OBJ_>(ptr);
          if (!arr && ptr->__GetClass().mPtr == super::__SGetClass().mPtr )
          {
             // Non-identical type.
@@ -598,13 +817,66 @@ Array<ELEM_> Array_obj<ELEM_>::splice(int inPos, int len)
    return result;
 }
 
+namespace hx
+{
+// A one-argument closure around a statically typed function, eg. made for a Haxe
+//  function of type Int->Bool.  It works as any other closure through Dynamic, but map
+//  and filter on an array of ARG call it with the elements unboxed.
+template<typename ARG>
+struct TypedArgFunction1 : public hx::Object
+{
+   virtual Dynamic __runTyped(ARG inArg0) = 0;
+};
+
+template<typename RESULT,typename ARG>
+struct TypedFunction1 : public TypedArgFunction1<ARG>
+{
+   typedef RESULT (*Function)(ARG inArg0);
+   Function mFunction;
+
+   TypedFunction1(Function inFunction) : mFunction(inFunction) { }
+
+   int __Compare(const hx::Object *inRHS) const
+   {
+      const TypedFunction1 *other = hx::DynamicCast<TypedFunction1>(inRHS);
+      if (!other)
+         return -1;
+      return mFunction==other->mFunction ? 0 : -1;
+   }
+
+   int __GetType() const { return vtFunction; }
+   int __ArgCount() const { return 1; }
+   ::String __ToString() const { return HX_CSTRING("#sfunction1"); }
+   Dynamic __Run(const Array<Dynamic> &inArgs) { return mFunction(inArgs[0]); }
+   Dynamic __run(const Dynamic &inArg0) { return mFunction(inArg0); }
+   Dynamic __runTyped(ARG inArg0) { return mFunction(inArg0); }
+};
+
+template<typename RESULT,typename ARG>
+inline Dynamic CreateTypedFunction1(RESULT (*inFunction)(ARG))
+{
+   return new TypedFunction1<RESULT,ARG>(inFunction);
+}
+}
+
 template<typename ELEM_>
 Array<ELEM_> Array_obj<ELEM_>::filter(Dynamic inFunc)
 {
+   // Let push grow the result, so selective filters only pay for what they keep
    Array_obj *result = new Array_obj(0,0);
+   if (length==0)
+      return result;
+   inFunc.CheckFPtr();
+   hx::Object *func = inFunc.mPtr;
+   hx::TypedFunction1<bool,ELEM_> *typed = hx::DynamicCast< hx::TypedFunction1<bool,ELEM_> >(func);
+   if (typed)
+      return filterTyped(typed->mFunction);
    for(int i=0;i<length;i++)
-      if (inFunc(__unsafe_get(i)))
-         result->push(__unsafe_get(i));
+   {
+      ELEM_ item = __unsafe_get(i);
+      if (func->__run(item))
+         result->push(item);
+   }
    return result;
 }
 
@@ -615,12 +887,110 @@ Array<ELEM_> Array_obj<ELEM_>::__SetSizeExact(int inLen)
    return this;
 }
 
+namespace hx
+{
+// Element kernels shared by the typed arrays and the packed buffer wrappers (hxcpp.Int8Array etc).
+// The loops are simple enough for the compiler to turn into memset or vector conversions.
+template<typename T>
+inline void FillElements(T *outDest,int inCount,T inValue)
+{
+   if (sizeof(T)==1)
+      memset(outDest, *(unsigned char *)&inValue, inCount);
+   else
+      std::fill(outDest, outDest+inCount, inValue);
+}
+
+template<typename TO,typename FROM>
+inline void ConvertElements(TO *outDest,const FROM *inSource,int inCount)
+{
+   for(int i=0;i<inCount;i++)
+      outDest[i] = (TO)inSource[i];
+}
+}
+
+// Copies elements from another array of the same type, growing this array as needed.
+// The ranges may overlap.
+template<typename ELEM_>
+void Array_obj<ELEM_>::blit(int inDestElement, Array<ELEM_> inSourceArray, int inSourceElement, int inElementCount)
+{
+   if (inElementCount<=0)
+      return;
+   if (inDestElement<0 || inSourceElement<0 || inSourceElement+inElementCount>inSourceArray->length)
+      hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+   EnsureSize(inDestElement+inElementCount);
+   memmove(mBase + inDestElement*sizeof(ELEM_), inSourceArray->GetBase() + inSourceElement*sizeof(ELEM_),
+           inElementCount*sizeof(ELEM_));
+}
+
+template<typename ELEM_>
+void Array_obj<ELEM_>::fill(ELEM_ inValue, int inPos, int inLen)
+{
+   if (inLen<=0)
+      return;
+   if (inPos<0)
+      hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+   EnsureSize(inPos+inLen);
+   hx::FillElements((ELEM_ *)mBase + inPos, inLen, inValue);
+}
+
+template<typename ELEM_>
+void Array_obj<ELEM_>::__checked_blit(int inDestElement, Array<ELEM_> inSourceArray, int inSourceElement, int inElementCount)
+{
+   if (inElementCount>0 && inElementCount>length-inDestElement)
+      hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+   blit(inDestElement,inSourceArray,inSourceElement,inElementCount);
+}
+
+template<typename ELEM_>
+void Array_obj<ELEM_>::__checked_fill(ELEM_ inValue, int inPos, int inLen)
+{
+   if (inLen>0 && inLen>length-inPos)
+      hx::Throw(HX_INDEX_OUT_OF_BOUNDS);
+   fill(inValue,inPos,inLen);
+}
+
+template<typename ELEM_>
+template<typename FROM>
+void Array_obj<ELEM_>::__convert_from(Array<FROM> inSource)
+{
+   int n = inSource->length;
+   ArrayBase::__SetSizeExact(n);
+   hx::ConvertElements((ELEM_ *)mBase, (const FROM *)inSource->GetBase(), n);
+}
+
+
+namespace hx
+{
+// Element-wise conversion between array types, eg Array<Float> to Array<float>.
+template<typename TO,typename FROM>
+inline Array<TO> ArrayConvert(Array<FROM> inSource)
+{
+   int n = inSource->length;
+   Array<TO> result = Array_obj<TO>::__new(n,n);
+   ConvertElements((TO *)result->GetBase(), (const FROM *)inSource->GetBase(), n);
+   return result;
+}
+
+}
+
+
 template<typename ELEM_>
 Dynamic Array_obj<ELEM_>::map(Dynamic inFunc)
 {
-   Array_obj<Dynamic> *result = new Array_obj<Dynamic>(length,0);
+   Array_obj<Dynamic> *result = new Array_obj<Dynamic>(0,0);
+   if (length==0)
+      return result;
+   inFunc.CheckFPtr();
+   hx::Object *func = inFunc.mPtr;
+   result->__SetSizeExact(length);
+   // The result is boxed either way, but a typed function takes the element unboxed
+   hx::TypedArgFunction1<ELEM_> *typed = hx::DynamicCast< hx::TypedArgFunction1<ELEM_> >(func);
+   // The call may collect, which can move the result buffer - so no cached base pointer
    for(int i=0;i<length;i++)
-      result->__unsafe_set(i,inFunc(__unsafe_get(i)));
+   {
+      Dynamic value = typed ? typed->__runTyped(__unsafe_get(i)) : func->__run(__unsafe_get(i));
+      result->__unsafe_set(i,value);
+   }
    return result;
 }
 
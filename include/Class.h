@@ -43,6 +43,7 @@ namespace hx
 {
 typedef Dynamic (*ConstructEmptyFunc)();
 typedef Dynamic (*ConstructArgsFunc)(DynamicArray inArgs);
+typedef Dynamic (*ConstructSpanFunc)(const Dynamic *inArgs,int inArgCount);
 typedef Dynamic (*ConstructEnumFunc)(String inName,DynamicArray inArgs);
 typedef void (*MarkFunc)(hx::MarkContext *__inCtx);
 typedef bool (*CanCastFunc)(hx::Object *inPtr);
@@ -56,7 +57,7 @@ inline bool operator!=(hx::ConstructEnumFunc inFunc,const null &inNull) { return
 class HXCPP_EXTERN_CLASS_ATTRIBUTES Class_obj : public hx::Object
 {
 public:
-   Class_obj() : mSuper(0) { };
+   Class_obj() : mSuper(0), mConstructSpan(0) { };
    Class_obj(const String &inClassName, String inStatics[], String inMembers[],
              hx::ConstructEmptyFunc inConstructEmpty, hx::ConstructArgsFunc inConstructArgs,
              Class *inSuperClass, hx::ConstructEnumFunc inConstructEnum,
@@ -89,7 +90,12 @@ public:
    bool __HasField(const String &inString);
 
    virtual Dynamic ConstructEmpty();
+   // Type.createInstance comes here.  Native classes get the caller's array, uncopied.
    virtual Dynamic ConstructArgs(hx::DynamicArray inArgs);
+   // Same as ConstructArgs, from an argument span.  Script classes, and native classes that
+   //  set mConstructSpan, take the span directly.  Other native classes may keep their
+   //  argument array, so they are given a new one.
+   virtual Dynamic ConstructArgs(const Dynamic *inArgs,int inArgCount);
    virtual Dynamic ConstructEnum(String inName,hx::DynamicArray inArgs);
    virtual bool VCanCast(hx::Object *inPtr) { return false; }
 
@@ -114,6 +120,8 @@ public:
    Dynamic            __meta__;
 
 	hx::ConstructArgsFunc  mConstructArgs;
+	// Optional, set after registering, eg. by a class whose constructor does not keep its args
+	hx::ConstructSpanFunc  mConstructSpan;
 	hx::ConstructEmptyFunc mConstructEmpty;
 	hx::ConstructEnumFunc  mConstructEnum;
 
@@ -151,7 +159,7 @@ void RegisterClass(const String &inClassName, Class inClass);
 template<typename T>
 inline bool TCanCast(hx::Object *inPtr)
 {
-	return inPtr && ( dynamic_cast<T *>(inPtr->__GetRealObject()) || inPtr->__ToInterface(typeid(T)) );
+	return inPtr && ( hx::DynamicCast<T>(inPtr->__GetRealObject()) || hx::ToInterface<T>(inPtr) );
 }
 
 }
@@ -41,6 +41,9 @@ public:
    inline operator float () const { return mPtr ? (float)mPtr->__ToDouble() : 0.0f; }
    inline operator int () const { return mPtr ? mPtr->__ToInt() : 0; }
    inline operator unsigned char () const { return mPtr ? mPtr->__ToInt() : 0; }
+   inline operator signed char () const { return mPtr ? mPtr->__ToInt() : 0; }
+   inline operator short () const { return mPtr ? mPtr->__ToInt() : 0; }
+   inline operator unsigned short () const { return mPtr ? mPtr->__ToInt() : 0; }
    inline operator bool() const { return mPtr && mPtr->__ToInt(); }
    inline bool operator !() const { return !mPtr || !mPtr->__ToInt(); }
 
@@ -175,6 +178,7 @@ typedef Dynamic (*MemberFunction3)(hx::Object *inObj,const Dynamic &inArg0,const
 typedef Dynamic (*MemberFunction4)(hx::Object *inObj,const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3);
 typedef Dynamic (*MemberFunction5)(hx::Object *inObj,const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4);
 typedef Dynamic (*MemberFunctionVar)(hx::Object *inObj,const Array<Dynamic> &inArgs);
+typedef Dynamic (*MemberFunctionSpan)(hx::Object *inObj,const Dynamic *inArgs);
 
 typedef Dynamic (*StaticFunction0)();
 typedef Dynamic (*StaticFunction1)(const Dynamic &inArg0);
@@ -183,6 +187,7 @@ typedef Dynamic (*StaticFunction3)(const Dynamic &inArg0,const Dynamic &inArg1,c
 typedef Dynamic (*StaticFunction4)(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3);
 typedef Dynamic (*StaticFunction5)(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4);
 typedef Dynamic (*StaticFunctionVar)(const Array<Dynamic> &inArgs);
+typedef Dynamic (*StaticFunctionSpan)(const Dynamic *inArgs);
 
 
 HXCPP_EXTERN_CLASS_ATTRIBUTES
@@ -199,6 +204,8 @@ HXCPP_EXTERN_CLASS_ATTRIBUTES
 Dynamic CreateMemberFunction5(hx::Object *, MemberFunction5);
 HXCPP_EXTERN_CLASS_ATTRIBUTES
 Dynamic CreateMemberFunctionVar(hx::Object *, MemberFunctionVar,int inN);
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+Dynamic CreateMemberFunctionVar(hx::Object *, MemberFunctionVar,MemberFunctionSpan,int inN);
 
 HXCPP_EXTERN_CLASS_ATTRIBUTES
 Dynamic CreateStaticFunction0(StaticFunction0);
@@ -214,6 +221,8 @@ HXCPP_EXTERN_CLASS_ATTRIBUTES
 Dynamic CreateStaticFunction5(StaticFunction5);
 HXCPP_EXTERN_CLASS_ATTRIBUTES
 Dynamic CreateStaticFunctionVar(StaticFunctionVar,int inN);
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+Dynamic CreateStaticFunctionVar(StaticFunctionVar,StaticFunctionSpan,int inN);
 
 
 }
@@ -58,8 +58,12 @@ class HXCPP_EXTERN_CLASS_ATTRIBUTES EnumBase_obj : public hx::Object
       int __Compare(const hx::Object *inRHS) const
       {
          if (inRHS->__GetType()!=vtEnum) return -1;
-         const EnumBase_obj *rhs = dynamic_cast<const EnumBase_obj *>(inRHS);
-         if (tag!=rhs->tag || GetEnumName()!=rhs->GetEnumName()) return -1;
+         const EnumBase_obj *rhs = hx::DynamicCast<EnumBase_obj>(inRHS);
+         if (rhs==this) return 0;
+         // Constructors are identified by index - the tag only matters for untyped enums
+         if (index!=rhs->index || (index<0 && tag!=rhs->tag)) return -1;
+         if (__GetClass().mPtr!=rhs->__GetClass().mPtr && GetEnumName()!=rhs->GetEnumName())
+            return -1;
          if (mArgs==null() && rhs->mArgs==null())
             return 0;
          if (mArgs==null() || rhs->mArgs==null())
@@ -99,6 +103,14 @@ hx::ObjectPtr<ENUM> CreateEnum(const String &inName,int inIndex, DynamicArray in
    result->Set(inName,inIndex,inArgs);
    return result;
 }
+
+// The zero-argument constructors are statics, returned by name from the generated __Field.
+// Each enum type keeps one GC-allocated, rooted instance to look them up through.
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+hx::Object *EnumStaticLookup(hx::Object **ioLookup, hx::Object *(*inCreate)());
+
+template<typename ENUM>
+hx::Object *CreateEnumLookup() { return new ENUM; }
 } // end namespace hx
 
 inline void __hxcpp_enum_force(hx::EnumBase inEnum,String inForceName, int inIndex)
@@ -65,7 +65,7 @@ public:
 template<typename T>
 FastIterator_obj<T> *CreateFastIterator(Dynamic inValue)
 {
-   FastIterator_obj<T> *result = dynamic_cast< FastIterator_obj<T> *>(inValue.GetPtr());
+   FastIterator_obj<T> *result = hx::DynamicCast< FastIterator_obj<T> >(inValue.GetPtr());
    if (result) return result;
    return new DynamicIterator<T>(inValue);
 }
@@ -68,7 +68,7 @@ public:
 
    static hx::ObjectPtr<Class_obj> __mClass; \
    static hx::ObjectPtr<Class_obj> &__SGetClass() { return __mClass; }
-   bool __Is(hx::Object *inObj) const { return dynamic_cast<OBJ_ *>(inObj)!=0; }
+   bool __Is(hx::Object *inObj) const { return hx::DynamicCast<OBJ_>(inObj)!=0; }
    hx::ObjectPtr<Class_obj > __GetClass() const { return __mClass; }
 
    bool __Remove(String inKey);
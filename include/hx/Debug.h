@@ -7,6 +7,7 @@
 // HXCPP_STACK_VARS if stack variables need to be tracked
 // HXCPP_STACK_LINE if stack line numbers need to be tracked
 // HXCPP_STACK_TRACE if stack frames need to be tracked
+// HXCPP_PROFILE_INSTRUMENT if the profiler should time every call rather than sample
 
 // Track stack variables - only really needed for debugger
 #if defined(HXCPP_DEBUGGER) && !defined(HXCPP_STACK_VARS)
@@ -21,7 +22,7 @@
 
 // Do we need to keep a stack trace - for basic exception handelling, also
 // needed for the debugger
-#if (defined(HXCPP_DEBUG) || defined(HXCPP_DEBUGGER) || defined(HXCPP_STACK_VARS) || defined(HXCPP_STACK_LINE)) && !defined(HXCPP_STACK_TRACE)
+#if (defined(HXCPP_DEBUG) || defined(HXCPP_DEBUGGER) || defined(HXCPP_STACK_VARS) || defined(HXCPP_STACK_LINE) || defined(HXCPP_PROFILE_INSTRUMENT)) && !defined(HXCPP_STACK_TRACE)
 #define HXCPP_STACK_TRACE
 #endif
 
@@ -37,6 +38,15 @@ void __hx_dump_stack();
 HXCPP_EXTERN_CLASS_ATTRIBUTES
 void __hxcpp_stack_begin_catch();
 
+// Used by fibers to carry the frames they pushed (those above inBase, a value
+// of __hxcpp_stack_top) across a switch.  Detach returns 0 if there are none.
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void *__hxcpp_stack_top();
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void *__hxcpp_stack_detach(void *inBase);
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void __hxcpp_stack_attach(void *inFrames);
+
 
 namespace hx
 {
@@ -71,6 +81,22 @@ enum StepType
 class StackArgument;
 class StackVariable;
 class StackCatchable;
+struct InstrumentEntry;
+
+// The lines of one file that have breakpoints.  bits[0] is the number of
+// words of bits that follow it, and is zero when there are none.
+struct BreakLines
+{
+    const unsigned int * volatile bits;
+
+    bool IsBreakLine(int line) const
+    {
+        const unsigned int *words = (const unsigned int *)
+            HxAtomicLoadAcquirePtr((void * volatile *) &bits);
+        unsigned int word = ((unsigned int) line) >> 5;
+        return (word < words[0]) && (words[word + 1] & (1U << (line & 31)));
+    }
+};
 
 class StackFrame
 {
@@ -108,6 +134,30 @@ public:
 
     // The list of types that can be currently caught in the stack frame.
     StackCatchable *catchables;
+
+    // The calling frame, or NULL at the bottom of this thread's stack
+    StackFrame *parent;
+
+#ifdef HXCPP_DEBUGGER
+    // Breakpoint lines of fileName, and whether a class:function breakpoint
+    // is waiting for this call's first line
+    BreakLines *breakLines;
+    bool breakOnEntry;
+
+    bool IsBreakLine(int line) const
+    {
+        return breakOnEntry || breakLines->IsBreakLine(line);
+    }
+#endif
+
+#ifdef HXCPP_PROFILE_INSTRUMENT
+    // The function's counters (NULL if the call is not being timed), the
+    // profiling run they belong to, the entry time and the time in callees
+    InstrumentEntry *instrumentEntry;
+    int instrumentGeneration;
+    unsigned long long instrumentStart;
+    unsigned long long instrumentChildren;
+#endif
 };
 
 
@@ -250,6 +300,65 @@ private:
 
 
 extern volatile bool gShouldCallHandleBreakpoints;
+// Set while the debugger is stepping or breaking, when every line must check
+extern volatile bool gDebuggerStepping;
+
+
+// Timeline tracing, written out by __hxcpp_trace_flush.  The runtime marks
+// spans with static names through the HX_TRACE_ macros, which cost a single
+// test while tracing is off.
+enum TraceType
+{
+    traceBegin,
+    traceEnd,
+    traceInstant,
+    traceCounter
+};
+
+extern HXCPP_EXTERN_CLASS_ATTRIBUTES volatile bool gTraceEnabled;
+
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void TraceEvent(int inType, const char *inName, double inValue = 0);
+
+// Releases the thread's trace buffer once it has been flushed
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void TraceThreadExit();
+
+// Unregisters the thread's call stack, and stops its profiler
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void CallStackThreadExit();
+
+#define HX_TRACE_EVENT(type, name, value)                               \
+    do {                                                                \
+        if (hx::gTraceEnabled) {                                        \
+            hx::TraceEvent(type, name, value);                          \
+        }                                                               \
+    } while (0)
+
+#define HX_TRACE_BEGIN(name) HX_TRACE_EVENT(hx::traceBegin, name, 0)
+#define HX_TRACE_END() HX_TRACE_EVENT(hx::traceEnd, 0, 0)
+#define HX_TRACE_INSTANT(name) HX_TRACE_EVENT(hx::traceInstant, name, 0)
+#define HX_TRACE_COUNTER(name, value) HX_TRACE_EVENT(hx::traceCounter, name, value)
+
+// A span that ends with the enclosing scope, including when it unwinds
+struct TraceScope
+{
+    TraceScope(const char *inName) : mActive(gTraceEnabled)
+    {
+        if (mActive) {
+            TraceEvent(traceBegin, inName);
+        }
+    }
+    ~TraceScope()
+    {
+        if (mActive) {
+            TraceEvent(traceEnd, 0);
+        }
+    }
+    bool mActive;
+};
+
+#define HX_TRACE_SCOPE(name) hx::TraceScope __traceScope(name)
 
 
 // Only if HXCPP_STACK_TRACE is defined do any of the stack trace macros
@@ -307,7 +416,8 @@ extern volatile bool gShouldCallHandleBreakpoints;
     /* This is incorrect - a read memory barrier is needed here. */     \
     /* For now, just live with the exceedingly rare cases where */      \
     /* breakpoints are missed */                                        \
-    if (hx::gShouldCallHandleBreakpoints) {                             \
+    if (hx::gShouldCallHandleBreakpoints &&                             \
+        (hx::gDebuggerStepping || __stackframe.IsBreakLine(number))) {  \
         __hxcpp_dbg_HandleBreakpoints();                               \
     }
 #else
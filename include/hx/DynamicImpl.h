@@ -18,7 +18,7 @@ struct CMemberFunction0 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction0 *other = dynamic_cast<const CMemberFunction0 *>(inRHS);
+      const CMemberFunction0 *other = hx::DynamicCast<CMemberFunction0>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -58,7 +58,7 @@ struct CStaticFunction0 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction0 *other = dynamic_cast<const CStaticFunction0 *>(inRHS);
+      const CStaticFunction0 *other = hx::DynamicCast<CStaticFunction0>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -106,7 +106,7 @@ struct CMemberFunction1 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction1 *other = dynamic_cast<const CMemberFunction1 *>(inRHS);
+      const CMemberFunction1 *other = hx::DynamicCast<CMemberFunction1>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -146,7 +146,7 @@ struct CStaticFunction1 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction1 *other = dynamic_cast<const CStaticFunction1 *>(inRHS);
+      const CStaticFunction1 *other = hx::DynamicCast<CStaticFunction1>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -194,7 +194,7 @@ struct CMemberFunction2 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction2 *other = dynamic_cast<const CMemberFunction2 *>(inRHS);
+      const CMemberFunction2 *other = hx::DynamicCast<CMemberFunction2>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -234,7 +234,7 @@ struct CStaticFunction2 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction2 *other = dynamic_cast<const CStaticFunction2 *>(inRHS);
+      const CStaticFunction2 *other = hx::DynamicCast<CStaticFunction2>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -282,7 +282,7 @@ struct CMemberFunction3 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction3 *other = dynamic_cast<const CMemberFunction3 *>(inRHS);
+      const CMemberFunction3 *other = hx::DynamicCast<CMemberFunction3>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -322,7 +322,7 @@ struct CStaticFunction3 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction3 *other = dynamic_cast<const CStaticFunction3 *>(inRHS);
+      const CStaticFunction3 *other = hx::DynamicCast<CStaticFunction3>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -370,7 +370,7 @@ struct CMemberFunction4 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction4 *other = dynamic_cast<const CMemberFunction4 *>(inRHS);
+      const CMemberFunction4 *other = hx::DynamicCast<CMemberFunction4>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -410,7 +410,7 @@ struct CStaticFunction4 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction4 *other = dynamic_cast<const CStaticFunction4 *>(inRHS);
+      const CStaticFunction4 *other = hx::DynamicCast<CStaticFunction4>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -458,7 +458,7 @@ struct CMemberFunction5 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction5 *other = dynamic_cast<const CMemberFunction5 *>(inRHS);
+      const CMemberFunction5 *other = hx::DynamicCast<CMemberFunction5>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -498,7 +498,7 @@ struct CStaticFunction5 : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction5 *other = dynamic_cast<const CStaticFunction5 *>(inRHS);
+      const CStaticFunction5 *other = hx::DynamicCast<CStaticFunction5>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -533,105 +533,120 @@ Dynamic CreateStaticFunction5(StaticFunction5 inFunc)
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,6)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5 };
+   return mPtr->__runArgs(args,6);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,7)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6 };
+   return mPtr->__runArgs(args,7);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,8)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7 };
+   return mPtr->__runArgs(args,8);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,9)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8 };
+   return mPtr->__runArgs(args,9);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,10)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9 };
+   return mPtr->__runArgs(args,10);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,11)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10 };
+   return mPtr->__runArgs(args,11);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,12)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11 };
+   return mPtr->__runArgs(args,12);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,13)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12 };
+   return mPtr->__runArgs(args,13);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,14)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13 };
+   return mPtr->__runArgs(args,14);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,15)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14 };
+   return mPtr->__runArgs(args,15);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14,const Dynamic &inArg15)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,16)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14)->Add(inArg15));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14,inArg15 };
+   return mPtr->__runArgs(args,16);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14,const Dynamic &inArg15,const Dynamic &inArg16)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,17)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14)->Add(inArg15)->Add(inArg16));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14,inArg15,inArg16 };
+   return mPtr->__runArgs(args,17);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14,const Dynamic &inArg15,const Dynamic &inArg16,const Dynamic &inArg17)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,18)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14)->Add(inArg15)->Add(inArg16)->Add(inArg17));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14,inArg15,inArg16,inArg17 };
+   return mPtr->__runArgs(args,18);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14,const Dynamic &inArg15,const Dynamic &inArg16,const Dynamic &inArg17,const Dynamic &inArg18)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,19)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14)->Add(inArg15)->Add(inArg16)->Add(inArg17)->Add(inArg18));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14,inArg15,inArg16,inArg17,inArg18 };
+   return mPtr->__runArgs(args,19);
 }
 
  
 Dynamic Dynamic::operator()(const Dynamic &inArg0,const Dynamic &inArg1,const Dynamic &inArg2,const Dynamic &inArg3,const Dynamic &inArg4,const Dynamic &inArg5,const Dynamic &inArg6,const Dynamic &inArg7,const Dynamic &inArg8,const Dynamic &inArg9,const Dynamic &inArg10,const Dynamic &inArg11,const Dynamic &inArg12,const Dynamic &inArg13,const Dynamic &inArg14,const Dynamic &inArg15,const Dynamic &inArg16,const Dynamic &inArg17,const Dynamic &inArg18,const Dynamic &inArg19)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::__new(0,20)->Add(inArg0)->Add(inArg1)->Add(inArg2)->Add(inArg3)->Add(inArg4)->Add(inArg5)->Add(inArg6)->Add(inArg7)->Add(inArg8)->Add(inArg9)->Add(inArg10)->Add(inArg11)->Add(inArg12)->Add(inArg13)->Add(inArg14)->Add(inArg15)->Add(inArg16)->Add(inArg17)->Add(inArg18)->Add(inArg19));
+   const Dynamic args[] = { inArg0,inArg1,inArg2,inArg3,inArg4,inArg5,inArg6,inArg7,inArg8,inArg9,inArg10,inArg11,inArg12,inArg13,inArg14,inArg15,inArg16,inArg17,inArg18,inArg19 };
+   return mPtr->__runArgs(args,20);
 }
 
 
@@ -644,18 +659,20 @@ struct CMemberFunctionVar : public hx::Object
 { 
    hx::ObjectPtr<Object> mThis; 
    MemberFunctionVar mFunction;
+   MemberFunctionSpan mSpanFunction;
    int N;
 
 
-   CMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunction,int inN)
+   CMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunction,int inN,MemberFunctionSpan inSpanFunction=0)
    {
       mThis = inObj;
       mFunction = inFunction;
+      mSpanFunction = inSpanFunction;
       N = inN;
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunctionVar *other = dynamic_cast<const CMemberFunctionVar *>(inRHS);
+      const CMemberFunctionVar *other = hx::DynamicCast<CMemberFunctionVar>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -674,6 +691,12 @@ struct CMemberFunctionVar : public hx::Object
    { 
       return mFunction(mThis.GetPtr(), inArgs);
    } 
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      if (mSpanFunction && inArgCount==N)
+         return mSpanFunction(mThis.GetPtr(), inArgs);
+      return hx::Object::__runArgs(inArgs,inArgCount);
+   }
 }; 
 
 
@@ -681,16 +704,18 @@ struct CMemberFunctionVar : public hx::Object
 struct CStaticFunctionVar : public hx::Object 
 { 
    StaticFunctionVar mFunction;
+   StaticFunctionSpan mSpanFunction;
    int N;
 
-   CStaticFunctionVar( StaticFunctionVar inFunction,int inN)
+   CStaticFunctionVar( StaticFunctionVar inFunction,int inN,StaticFunctionSpan inSpanFunction=0)
    {
       mFunction = inFunction;
+      mSpanFunction = inSpanFunction;
       N = inN;
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunctionVar *other = dynamic_cast<const CStaticFunctionVar *>(inRHS);
+      const CStaticFunctionVar *other = hx::DynamicCast<CStaticFunctionVar>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -704,15 +729,27 @@ struct CStaticFunctionVar : public hx::Object
    { 
       return mFunction(inArgs);
    } 
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      if (mSpanFunction && inArgCount==N)
+         return mSpanFunction(inArgs);
+      return hx::Object::__runArgs(inArgs,inArgCount);
+   }
 }; 
 
 
 Dynamic CreateMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunc,int inN)
    { return new CMemberFunctionVar(inObj,inFunc,inN); }
 
+Dynamic CreateMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunc,MemberFunctionSpan inSpanFunc,int inN)
+   { return new CMemberFunctionVar(inObj,inFunc,inN,inSpanFunc); }
+
 Dynamic CreateStaticFunctionVar(StaticFunctionVar inFunc,int inN)
    { return new CStaticFunctionVar(inFunc,inN); }
 
+Dynamic CreateStaticFunctionVar(StaticFunctionVar inFunc,StaticFunctionSpan inSpanFunc,int inN)
+   { return new CStaticFunctionVar(inFunc,inN,inSpanFunc); }
+
 }
 
 
@@ -3,7 +3,8 @@
 Dynamic Dynamic::NS::operator()(::DYNAMIC_ARG_LIST::)
 {
    CheckFPtr();
-   return mPtr->__Run(Array_obj<Dynamic>::NS::__new(0,::ARG::)::DYNAMIC_ADDS::);
+   const Dynamic args[] = { ::ARG_LIST:: };
+   return mPtr->__runArgs(args,::ARG::);
 }
 ::else::
 
@@ -22,7 +23,7 @@ struct CMemberFunction::ARG:: : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunction::ARG:: *other = dynamic_cast<const CMemberFunction::ARG:: *>(inRHS);
+      const CMemberFunction::ARG:: *other = hx::DynamicCast<CMemberFunction::ARG::>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -66,7 +67,7 @@ struct CStaticFunction::ARG:: : public hx::Object
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunction::ARG:: *other = dynamic_cast<const CStaticFunction::ARG:: *>(inRHS);
+      const CStaticFunction::ARG:: *other = hx::DynamicCast<CStaticFunction::ARG::>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -107,18 +108,20 @@ struct CMemberFunctionVar : public hx::Object
 { 
    hx::ObjectPtr<Object> mThis; 
    MemberFunctionVar mFunction;
+   MemberFunctionSpan mSpanFunction;
    int N;
 
 
-   CMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunction,int inN)
+   CMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunction,int inN,MemberFunctionSpan inSpanFunction=0)
    {
       mThis = inObj;
       mFunction = inFunction;
+      mSpanFunction = inSpanFunction;
       N = inN;
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CMemberFunctionVar *other = dynamic_cast<const CMemberFunctionVar *>(inRHS);
+      const CMemberFunctionVar *other = hx::DynamicCast<CMemberFunctionVar>(inRHS);
       if (!other)
          return -1;
       return (mFunction==other->mFunction && mThis.GetPtr()==other->mThis.GetPtr())? 0 : -1;
@@ -137,6 +140,12 @@ struct CMemberFunctionVar : public hx::Object
    { 
       return mFunction(mThis.GetPtr(), inArgs);
    } 
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      if (mSpanFunction && inArgCount==N)
+         return mSpanFunction(mThis.GetPtr(), inArgs);
+      return hx::Object::__runArgs(inArgs,inArgCount);
+   }
 }; 
 
 
@@ -144,16 +153,18 @@ struct CMemberFunctionVar : public hx::Object
 struct CStaticFunctionVar : public hx::Object 
 { 
    StaticFunctionVar mFunction;
+   StaticFunctionSpan mSpanFunction;
    int N;
 
-   CStaticFunctionVar( StaticFunctionVar inFunction,int inN)
+   CStaticFunctionVar( StaticFunctionVar inFunction,int inN,StaticFunctionSpan inSpanFunction=0)
    {
       mFunction = inFunction;
+      mSpanFunction = inSpanFunction;
       N = inN;
    }
    int __Compare(const hx::Object *inRHS) const
    {
-      const CStaticFunctionVar *other = dynamic_cast<const CStaticFunctionVar *>(inRHS);
+      const CStaticFunctionVar *other = hx::DynamicCast<CStaticFunctionVar>(inRHS);
       if (!other)
          return -1;
       return mFunction==other->mFunction ? 0 : -1;
@@ -167,15 +178,27 @@ struct CStaticFunctionVar : public hx::Object
    { 
       return mFunction(inArgs);
    } 
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      if (mSpanFunction && inArgCount==N)
+         return mSpanFunction(inArgs);
+      return hx::Object::__runArgs(inArgs,inArgCount);
+   }
 }; 
 
 
 Dynamic CreateMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunc,int inN)
    { return new CMemberFunctionVar(inObj,inFunc,inN); }
 
+Dynamic CreateMemberFunctionVar(hx::Object *inObj, MemberFunctionVar inFunc,MemberFunctionSpan inSpanFunc,int inN)
+   { return new CMemberFunctionVar(inObj,inFunc,inN,inSpanFunc); }
+
 Dynamic CreateStaticFunctionVar(StaticFunctionVar inFunc,int inN)
    { return new CStaticFunctionVar(inFunc,inN); }
 
+Dynamic CreateStaticFunctionVar(StaticFunctionVar inFunc,StaticFunctionSpan inSpanFunc,int inN)
+   { return new CStaticFunctionVar(inFunc,inN,inSpanFunc); }
+
 }
 
 
@@ -61,6 +61,10 @@ public:
 void GCAddRoot(hx::Object **inRoot);
 void GCRemoveRoot(hx::Object **inRoot);
 
+// Report malloc'd memory owned by a collectable object, so it adds to the pressure for a
+//  collection.  Growth may collect, so only report it where allocating would be safe.
+void GCChangeExternalMemory(int inDelta);
+
 
 
 
@@ -89,6 +93,10 @@ void  GCSetFinalizer( hx::Object *, hx::finalizer f );
 
 
 void *InternalNew(int inSize,bool inIsObject);
+// Per-thread cache of the wrappers returned by __ToInterface, keyed on the real object
+//  and interface.  Emptied by every collection.
+HXCPP_EXTERN_CLASS_ATTRIBUTES hx::Object *GetCachedInterface(hx::Object *inReal,const void *inInterface);
+HXCPP_EXTERN_CLASS_ATTRIBUTES void SetCachedInterface(hx::Object *inReal,const void *inInterface,hx::Object *inWrapper);
 void *InternalRealloc(void *inData,int inSize);
 void InternalEnableGC(bool inEnable);
 void *InternalCreateConstBuffer(const void *inData,int inSize);
@@ -104,6 +112,24 @@ void RegisterCurrentThread(void *inTopOfStack);
 void UnregisterCurrentThread();
 void EnterSafePoint();
 void GCPrepareMultiThreaded();
+// Moves on with every collection.  Once it has, every thread has been at a safe point
+//  since it was read, so memory unlinked before then is no longer being read.
+int GCCollectEpoch();
+
+// Fibers: a stack that is switched away from, but still live.  The collector scans
+//  [mBottom,mTop) and the saved register block.
+struct SuspendedStack
+{
+   int  *mBottom;
+   int  *mTop;
+   void *mRegisters;
+   int  mRegisterSize;
+   SuspendedStack *mNext;
+};
+// Suspend the current stack (caller fills in mBottom and the registers) and continue
+//  on the stack whose top is inNewTop.  Pop returns to the most recently suspended one.
+HXCPP_EXTERN_CLASS_ATTRIBUTES void GCPushSuspendedStack(SuspendedStack *inStack,void *inNewTop);
+HXCPP_EXTERN_CLASS_ATTRIBUTES void GCPopSuspendedStack();
 
 
 
@@ -115,6 +141,10 @@ HXCPP_EXTERN_CLASS_ATTRIBUTES
 void MarkAlloc(void *inPtr ,hx::MarkContext *__inCtx);
 HXCPP_EXTERN_CLASS_ATTRIBUTES
 void MarkObjectAlloc(hx::Object *inPtr ,hx::MarkContext *__inCtx);
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void MarkConservative(void *inBottom,void *inTop,hx::MarkContext *__inCtx);
+HXCPP_EXTERN_CLASS_ATTRIBUTES
+void MarkSuspendedStack(SuspendedStack *inStack,hx::MarkContext *__inCtx);
 
 #ifdef HXCPP_DEBUG
 HXCPP_EXTERN_CLASS_ATTRIBUTES
@@ -153,7 +183,7 @@ inline void EnsureObjPtr(hx::Object *) { }
 #define HX_GC_CONST_STRING  0xffffffff
 
 #define HX_MARK_STRING(ioPtr) \
-   if (ioPtr && (((int *)ioPtr)[-1] != HX_GC_CONST_STRING) ) hx::MarkAlloc((void *)ioPtr, __inCtx );
+   if (ioPtr && (((unsigned int *)ioPtr)[-1] != HX_GC_CONST_STRING) ) hx::MarkAlloc((void *)ioPtr, __inCtx );
 
 #define HX_MARK_ARRAY(ioPtr) { if (ioPtr) hx::MarkAlloc((void *)ioPtr, __inCtx ); }
 
@@ -167,7 +197,7 @@ inline void EnsureObjPtr(hx::Object *) { }
   { hx::EnsureObjPtr(ioPtr); if (ioPtr) __inCtx->visitObject( (hx::Object **)&ioPtr); }
 
 #define HX_VISIT_STRING(ioPtr) \
-   if (ioPtr && (((int *)ioPtr)[-1] != HX_GC_CONST_STRING) ) __inCtx->visitAlloc((void **)&ioPtr);
+   if (ioPtr && (((unsigned int *)ioPtr)[-1] != HX_GC_CONST_STRING) ) __inCtx->visitAlloc((void **)&ioPtr);
 
 #define HX_VISIT_ARRAY(ioPtr) { if (ioPtr) __inCtx->visitAlloc((void **)&ioPtr); }
 
@@ -5,7 +5,7 @@
 
 
 #define HX_DO_RTTI_BASE \
-   bool __Is(hx::Object *inObj) const { return dynamic_cast<OBJ_ *>(inObj)!=0; } \
+   bool __Is(hx::Object *inObj) const { return hx::DynamicCast<OBJ_>(inObj)!=0; } \
 
 
 #define HX_DO_RTTI \
@@ -160,9 +160,13 @@ Dynamic __##class##func(hx::Object *inObj, const Array<Dynamic> &inArgs) \
 { \
       ret reinterpret_cast<class *>(inObj)->func(array_list); return Dynamic(); \
 }; \
+Dynamic __span_##class##func(hx::Object *inObj, const Dynamic *inArgs) \
+{ \
+      ret reinterpret_cast<class *>(inObj)->func(array_list); return Dynamic(); \
+}; \
 Dynamic class::func##_dyn() \
 {\
-   return hx::CreateMemberFunctionVar(this,__##class##func,N); \
+   return hx::CreateMemberFunctionVar(this,__##class##func,__span_##class##func,N); \
 }
 
 
@@ -314,9 +318,13 @@ Dynamic __##class##func(const Array<Dynamic> &inArgs) \
 { \
       ret class::func(array_list); return Dynamic(); \
 }; \
+Dynamic __span_##class##func(const Dynamic *inArgs) \
+{ \
+      ret class::func(array_list); return Dynamic(); \
+}; \
 Dynamic class::func##_dyn() \
 {\
-   return hx::CreateStaticFunctionVar(__##class##func,N); \
+   return hx::CreateStaticFunctionVar(__##class##func,__span_##class##func,N); \
 }
 
 
@@ -432,7 +440,12 @@ static Dynamic Create##enum_obj(::String inName,hx::DynamicArray inArgs) \
    int count =  enum_obj::__FindArgCount(inName); \
    int args = inArgs.GetPtr() ? inArgs.__length() : 0; \
    if (args!=count)  throw HX_INVALID_ARG_COUNT; \
-   if (args==0) { Dynamic result =(new enum_obj())->__Field(inName,true); if (result!=null()) return result; } \
+   if (args==0) \
+   { \
+      static hx::Object *sLookup = 0; \
+      Dynamic result = hx::EnumStaticLookup(&sLookup,hx::CreateEnumLookup<enum_obj >)->__Field(inName,true); \
+      if (result!=null()) return result; \
+   } \
    return hx::CreateEnum<enum_obj >(inName,idx,inArgs); \
 }
 
@@ -457,6 +470,15 @@ static Dynamic Create##enum_obj(::String inName,hx::DynamicArray inArgs) \
    Dynamic __Run(const Array<Dynamic> &inArgs) { ret func( array_args ); return null();} \
    Dynamic __run(dyn_arg_list) { ret func( arg_list ); return null();}
 
+#define HX_DYNAMIC_CALL_EXTRA(ret,func,N,array_args,dyn_arg_list,arg_list) \
+   Dynamic __Run(const Array<Dynamic> &inArgs) { ret func( array_args ); return null();} \
+   Dynamic __run(dyn_arg_list) { ret func( arg_list ); return null();} \
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount) \
+   { \
+      if (inArgCount!=N) return hx::Object::__runArgs(inArgs,inArgCount); \
+      ret func( array_args ); return null(); \
+   }
+
 
 #define HX_DYNAMIC_CALL0(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST0,HX_DYNAMIC_ARG_LIST0,HX_ARG_LIST0)
 #define HX_DYNAMIC_CALL1(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST1,HX_DYNAMIC_ARG_LIST1,HX_ARG_LIST1)
@@ -464,21 +486,21 @@ static Dynamic Create##enum_obj(::String inName,hx::DynamicArray inArgs) \
 #define HX_DYNAMIC_CALL3(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST3,HX_DYNAMIC_ARG_LIST3,HX_ARG_LIST3)
 #define HX_DYNAMIC_CALL4(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST4,HX_DYNAMIC_ARG_LIST4,HX_ARG_LIST4)
 #define HX_DYNAMIC_CALL5(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST5,HX_DYNAMIC_ARG_LIST5,HX_ARG_LIST5)
-#define HX_DYNAMIC_CALL6(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST6,HX_DYNAMIC_ARG_LIST6,HX_ARG_LIST6)
-#define HX_DYNAMIC_CALL7(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST7,HX_DYNAMIC_ARG_LIST7,HX_ARG_LIST7)
-#define HX_DYNAMIC_CALL8(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST8,HX_DYNAMIC_ARG_LIST8,HX_ARG_LIST8)
-#define HX_DYNAMIC_CALL9(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST9,HX_DYNAMIC_ARG_LIST9,HX_ARG_LIST9)
-#define HX_DYNAMIC_CALL10(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST10,HX_DYNAMIC_ARG_LIST10,HX_ARG_LIST10)
-#define HX_DYNAMIC_CALL11(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST11,HX_DYNAMIC_ARG_LIST11,HX_ARG_LIST11)
-#define HX_DYNAMIC_CALL12(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST12,HX_DYNAMIC_ARG_LIST12,HX_ARG_LIST12)
-#define HX_DYNAMIC_CALL13(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST13,HX_DYNAMIC_ARG_LIST13,HX_ARG_LIST13)
-#define HX_DYNAMIC_CALL14(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST14,HX_DYNAMIC_ARG_LIST14,HX_ARG_LIST14)
-#define HX_DYNAMIC_CALL15(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST15,HX_DYNAMIC_ARG_LIST15,HX_ARG_LIST15)
-#define HX_DYNAMIC_CALL16(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST16,HX_DYNAMIC_ARG_LIST16,HX_ARG_LIST16)
-#define HX_DYNAMIC_CALL17(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST17,HX_DYNAMIC_ARG_LIST17,HX_ARG_LIST17)
-#define HX_DYNAMIC_CALL18(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST18,HX_DYNAMIC_ARG_LIST18,HX_ARG_LIST18)
-#define HX_DYNAMIC_CALL19(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST19,HX_DYNAMIC_ARG_LIST19,HX_ARG_LIST19)
-#define HX_DYNAMIC_CALL20(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST20,HX_DYNAMIC_ARG_LIST20,HX_ARG_LIST20)
+#define HX_DYNAMIC_CALL6(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,6,HX_ARR_LIST6,HX_DYNAMIC_ARG_LIST6,HX_ARG_LIST6)
+#define HX_DYNAMIC_CALL7(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,7,HX_ARR_LIST7,HX_DYNAMIC_ARG_LIST7,HX_ARG_LIST7)
+#define HX_DYNAMIC_CALL8(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,8,HX_ARR_LIST8,HX_DYNAMIC_ARG_LIST8,HX_ARG_LIST8)
+#define HX_DYNAMIC_CALL9(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,9,HX_ARR_LIST9,HX_DYNAMIC_ARG_LIST9,HX_ARG_LIST9)
+#define HX_DYNAMIC_CALL10(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,10,HX_ARR_LIST10,HX_DYNAMIC_ARG_LIST10,HX_ARG_LIST10)
+#define HX_DYNAMIC_CALL11(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,11,HX_ARR_LIST11,HX_DYNAMIC_ARG_LIST11,HX_ARG_LIST11)
+#define HX_DYNAMIC_CALL12(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,12,HX_ARR_LIST12,HX_DYNAMIC_ARG_LIST12,HX_ARG_LIST12)
+#define HX_DYNAMIC_CALL13(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,13,HX_ARR_LIST13,HX_DYNAMIC_ARG_LIST13,HX_ARG_LIST13)
+#define HX_DYNAMIC_CALL14(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,14,HX_ARR_LIST14,HX_DYNAMIC_ARG_LIST14,HX_ARG_LIST14)
+#define HX_DYNAMIC_CALL15(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,15,HX_ARR_LIST15,HX_DYNAMIC_ARG_LIST15,HX_ARG_LIST15)
+#define HX_DYNAMIC_CALL16(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,16,HX_ARR_LIST16,HX_DYNAMIC_ARG_LIST16,HX_ARG_LIST16)
+#define HX_DYNAMIC_CALL17(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,17,HX_ARR_LIST17,HX_DYNAMIC_ARG_LIST17,HX_ARG_LIST17)
+#define HX_DYNAMIC_CALL18(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,18,HX_ARR_LIST18,HX_DYNAMIC_ARG_LIST18,HX_ARG_LIST18)
+#define HX_DYNAMIC_CALL19(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,19,HX_ARR_LIST19,HX_DYNAMIC_ARG_LIST19,HX_ARG_LIST19)
+#define HX_DYNAMIC_CALL20(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,20,HX_ARR_LIST20,HX_DYNAMIC_ARG_LIST20,HX_ARG_LIST20)
 
 #define HX_BEGIN_DEFAULT_FUNC(name,t0) \
 	namespace { \
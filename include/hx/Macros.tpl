@@ -3,7 +3,7 @@
 
 
 #define HX_DO_RTTI_BASE \
-   bool __Is(hx::Object *inObj) const { return dynamic_cast<OBJ_ *>(inObj)!=0; } \
+   bool __Is(hx::Object *inObj) const { return hx::DynamicCast<OBJ_>(inObj)!=0; } \
 
 
 #define HX_DO_RTTI \
@@ -98,9 +98,13 @@ Dynamic __##class##func(hx::NS::Object *inObj, const Array<Dynamic> &inArgs) \
 { \
       ret reinterpret_cast<class *>(inObj)->func(array_list); return Dynamic(); \
 }; \
+Dynamic __span_##class##func(hx::NS::Object *inObj, const Dynamic *inArgs) \
+{ \
+      ret reinterpret_cast<class *>(inObj)->func(array_list); return Dynamic(); \
+}; \
 Dynamic class::func##_dyn() \
 {\
-   return hx::NS::CreateMemberFunctionVar(this,__##class##func,N); \
+   return hx::NS::CreateMemberFunctionVar(this,__##class##func,__span_##class##func,N); \
 }
 
 
@@ -159,9 +163,13 @@ Dynamic __##class##func(const Array<Dynamic> &inArgs) \
 { \
       ret class::func(array_list); return Dynamic(); \
 }; \
+Dynamic __span_##class##func(const Dynamic *inArgs) \
+{ \
+      ret class::func(array_list); return Dynamic(); \
+}; \
 Dynamic class::func##_dyn() \
 {\
-   return hx::NS::CreateStaticFunctionVar(__##class##func,N); \
+   return hx::NS::CreateStaticFunctionVar(__##class##func,__span_##class##func,N); \
 }
 
 
@@ -184,7 +192,12 @@ static Dynamic Create##enum_obj(::String inName,hx::DynamicArray inArgs) \
    int count =  enum_obj::__FindArgCount(inName); \
    int args = inArgs.GetPtr() ? inArgs.__length() : 0; \
    if (args!=count)  throw HX_INVALID_ARG_COUNT; \
-   if (args==0) { Dynamic result =(new enum_obj())->__Field(inName,true); if (result!=null()) return result; } \
+   if (args==0) \
+   { \
+      static hx::Object *sLookup = 0; \
+      Dynamic result = hx::EnumStaticLookup(&sLookup,hx::CreateEnumLookup<enum_obj >)->__Field(inName,true); \
+      if (result!=null()) return result; \
+   } \
    return hx::CreateEnum<enum_obj >(inName,idx,inArgs); \
 }
 
@@ -209,8 +222,18 @@ static Dynamic Create##enum_obj(::String inName,hx::DynamicArray inArgs) \
    Dynamic __Run(const Array<Dynamic> &inArgs) { ret func( array_args ); return null();} \
    Dynamic __run(dyn_arg_list) { ret func( arg_list ); return null();}
 
-::foreach PARAMS::
-#define HX_DYNAMIC_CALL::ARG::(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST::ARG::,HX_DYNAMIC_ARG_LIST::ARG::,HX_ARG_LIST::ARG::)::end::
+#define HX_DYNAMIC_CALL_EXTRA(ret,func,N,array_args,dyn_arg_list,arg_list) \
+   Dynamic __Run(const Array<Dynamic> &inArgs) { ret func( array_args ); return null();} \
+   Dynamic __run(dyn_arg_list) { ret func( arg_list ); return null();} \
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount) \
+   { \
+      if (inArgCount!=N) return hx::Object::__runArgs(inArgs,inArgCount); \
+      ret func( array_args ); return null(); \
+   }
+
+::foreach PARAMS::::if (ARG<6)::
+#define HX_DYNAMIC_CALL::ARG::(ret,func) HX_DYNAMIC_CALL(ret,func,HX_ARR_LIST::ARG::,HX_DYNAMIC_ARG_LIST::ARG::,HX_ARG_LIST::ARG::)::else::
+#define HX_DYNAMIC_CALL::ARG::(ret,func) HX_DYNAMIC_CALL_EXTRA(ret,func,::ARG::,HX_ARR_LIST::ARG::,HX_DYNAMIC_ARG_LIST::ARG::,HX_ARG_LIST::ARG::)::end::::end::
 
 #define HX_BEGIN_DEFAULT_FUNC(name,t0) \
 	namespace { \
@@ -91,6 +91,8 @@ public:
    virtual Dynamic __SetField(const String &inField,const Dynamic &inValue, bool inCallProp);
    virtual void  __SetThis(Dynamic inThis);
    virtual Dynamic __Run(const Array<Dynamic> &inArgs);
+   // Argument span call - the default uses __run up to 5 args, then __Run
+   virtual Dynamic __runArgs(const Dynamic *inArgs,int inArgCount);
    virtual hx::FieldMap *__GetFieldMap();
    virtual void __GetFields(Array<String> &outFields);
    virtual Class __GetClass() const;
@@ -128,6 +130,84 @@ public:
    static void __boot();
 };
 
+// Runs a function object with an argument span, throwing if it is null
+HXCPP_EXTERN_CLASS_ATTRIBUTES Dynamic RunArgs(hx::Object *inFunc,const Dynamic *inArgs,int inArgCount);
+
+// Copies a short argument span into outPadded, whose remaining slots stay null
+template<int N>
+inline const Dynamic *PadArgs(Dynamic (&outPadded)[N],const Dynamic *inArgs,int inArgCount)
+{
+   for(int i=0;i<inArgCount;i++)
+      outPadded[i] = inArgs[i];
+   return outPadded;
+}
+
+
+// --- hx::DynamicCast -------------------------------------------------------------
+//
+// dynamic_cast that remembers, for each vtable and target type, the pointer adjustment or
+//  the failure, so repeat casts of the same concrete class are a table lookup rather than an
+//  RTTI walk.  The table belongs to the thread's allocator, so threads never write to each
+//  other's entries.  Threads that are not registered with the GC have no table, and use
+//  dynamic_cast every time.
+
+struct CastCacheEntry
+{
+   const void *mVTable;
+   const void *mType;
+   int         mOffset;
+};
+enum { HX_CAST_CACHE_BITS = 9, HX_CAST_CACHE_SLOTS = 1<<HX_CAST_CACHE_BITS, HX_CAST_FAILED = 0x7fffffff };
+HXCPP_EXTERN_CLASS_ATTRIBUTES CastCacheEntry *GetCastCache();
+
+template<typename T>
+inline T *DynamicCast(hx::Object *inPtr)
+{
+   if (!inPtr)
+      return 0;
+   CastCacheEntry *cache = GetCastCache();
+   if (!cache)
+      return dynamic_cast<T *>(inPtr);
+   const void *vtable = *(const void **)inPtr;
+   const void *type = &typeid(T);
+   size_t key = ((size_t)vtable>>3) ^ ((size_t)type>>4);
+   CastCacheEntry &entry = cache[ (key ^ (key>>HX_CAST_CACHE_BITS)) & (HX_CAST_CACHE_SLOTS-1) ];
+   if (entry.mVTable==vtable && entry.mType==type)
+      return entry.mOffset==HX_CAST_FAILED ? 0 : (T *)((char *)inPtr + entry.mOffset);
+   T *result = dynamic_cast<T *>(inPtr);
+   entry.mVTable = vtable;
+   entry.mType = type;
+   entry.mOffset = result ? (int)((char *)(void *)result - (char *)inPtr) : HX_CAST_FAILED;
+   return result;
+}
+
+template<typename T>
+inline const T *DynamicCast(const hx::Object *inPtr)
+{
+   return DynamicCast<T>(const_cast<hx::Object *>(inPtr));
+}
+
+
+// --- hx::ToInterface -------------------------------------------------------------
+//
+// __ToInterface allocates a new wrapper on every call.  Wrappers are stateless apart
+//  from the real object, so each thread reuses the ones it made until the next collection.
+
+template<typename T>
+inline hx::Object *ToInterface(hx::Object *inPtr)
+{
+   const void *iface = &typeid(T);
+   hx::Object *real = inPtr->__GetRealObject();
+   hx::Object *wrapper = hx::GetCachedInterface(real,iface);
+   if (wrapper)
+      return wrapper;
+   wrapper = inPtr->__ToInterface(typeid(T));
+   if (wrapper && wrapper!=real)
+      hx::SetCachedInterface(real,iface,wrapper);
+   return wrapper;
+}
+
+
 // --- hx::ObjectPtr ---------------------------------------------------------------
 //
 // This class simply provides syntax so that pointers can be written as objects,
@@ -147,9 +227,9 @@ class ObjectPtr
    {
       if (inPtr)
       {
-         mPtr = dynamic_cast<OBJ_ *>(inPtr->__GetRealObject());
+         mPtr = hx::DynamicCast<OBJ_>(inPtr->__GetRealObject());
          if (!mPtr)
-            mPtr = (Ptr)inPtr->__ToInterface(typeid(Obj));
+            mPtr = (Ptr)hx::ToInterface<Obj>(inPtr);
       }
       else
          mPtr = 0;
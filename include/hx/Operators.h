@@ -272,6 +272,12 @@ inline Array<Dynamic> TCastToArray(Dynamic inVal)
    inline Array<float> ArrayElemCast(const Dynamic &d,const Array_obj<float> *) { return d; } 
    template<typename T>
    inline Array<unsigned char> ArrayElemCast(const Dynamic &d,const Array_obj<unsigned char> *) { return d; } 
+   template<typename T>
+   inline Array<signed char> ArrayElemCast(const Dynamic &d,const Array_obj<signed char> *) { return d; } 
+   template<typename T>
+   inline Array<short> ArrayElemCast(const Dynamic &d,const Array_obj<short> *) { return d; } 
+   template<typename T>
+   inline Array<unsigned short> ArrayElemCast(const Dynamic &d,const Array_obj<unsigned short> *) { return d; } 
 
    template<typename RESULT>
    inline RESULT ArrayElemCast(const Dynamic &d,...) { return (RESULT)d.mPtr; } 
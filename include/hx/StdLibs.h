@@ -135,11 +135,67 @@ Dynamic __hxcpp_lock_create();
 bool    __hxcpp_lock_wait(Dynamic inlock,double inTime);
 void    __hxcpp_lock_release(Dynamic inlock);
 
-Dynamic __hxcpp_deque_create();
+Dynamic __hxcpp_fast_mutex_create();
+void    __hxcpp_fast_mutex_acquire(Dynamic);
+bool    __hxcpp_fast_mutex_try(Dynamic);
+void    __hxcpp_fast_mutex_release(Dynamic);
+Dynamic __hxcpp_rwlock_create();
+void    __hxcpp_rwlock_read_acquire(Dynamic);
+void    __hxcpp_rwlock_read_release(Dynamic);
+void    __hxcpp_rwlock_write_acquire(Dynamic);
+void    __hxcpp_rwlock_write_release(Dynamic);
+Dynamic __hxcpp_condition_create();
+bool    __hxcpp_condition_wait(Dynamic inCondition,Dynamic inMutex,double inTimeout);
+void    __hxcpp_condition_signal(Dynamic inCondition);
+void    __hxcpp_condition_broadcast(Dynamic inCondition);
+Dynamic __hxcpp_latch_create(int inCount);
+void    __hxcpp_latch_count_down(Dynamic inLatch);
+bool    __hxcpp_latch_wait(Dynamic inLatch,double inTimeout);
+int     __hxcpp_latch_count(Dynamic inLatch);
+
+Dynamic __hxcpp_atomic_int_create(int inValue);
+int     __hxcpp_atomic_int_load(Dynamic inAtomic);
+void    __hxcpp_atomic_int_store(Dynamic inAtomic,int inValue);
+int     __hxcpp_atomic_int_add(Dynamic inAtomic,int inDelta);
+int     __hxcpp_atomic_int_exchange(Dynamic inAtomic,int inValue);
+bool    __hxcpp_atomic_int_cas(Dynamic inAtomic,int inExpected,int inValue);
+// 64-bit values travel as their high and low 32-bit halves, as haxe.Int64 holds them.
+//  Values come back as a new [high,low] array.
+Dynamic    __hxcpp_atomic_int64_create(int inHigh,int inLow);
+Array<int> __hxcpp_atomic_int64_load(Dynamic inAtomic);
+void       __hxcpp_atomic_int64_store(Dynamic inAtomic,int inHigh,int inLow);
+Array<int> __hxcpp_atomic_int64_add(Dynamic inAtomic,int inHigh,int inLow);
+Array<int> __hxcpp_atomic_int64_exchange(Dynamic inAtomic,int inHigh,int inLow);
+bool       __hxcpp_atomic_int64_cas(Dynamic inAtomic,int inExpectedHigh,int inExpectedLow,int inHigh,int inLow);
+Dynamic __hxcpp_atomic_object_create(Dynamic inValue);
+Dynamic __hxcpp_atomic_object_load(Dynamic inAtomic);
+void    __hxcpp_atomic_object_store(Dynamic inAtomic,Dynamic inValue);
+Dynamic __hxcpp_atomic_object_exchange(Dynamic inAtomic,Dynamic inValue);
+bool    __hxcpp_atomic_object_cas(Dynamic inAtomic,Dynamic inExpected,Dynamic inValue);
+void    __hxcpp_atomic_fence();
+
+// Fibers - stackful coroutines scanned by the GC while suspended
+Dynamic __hxcpp_fiber_create(Dynamic inFunc,int inStackSize);
+Dynamic __hxcpp_fiber_resume(Dynamic inFiber,Dynamic inValue);
+Dynamic __hxcpp_fiber_yield(Dynamic inValue);
+Dynamic __hxcpp_fiber_current();
+int     __hxcpp_fiber_state(Dynamic inFiber);
+
+// A capacity>0 makes add/push wait for room.  A single-consumer deque must only be
+//  popped by one thread, which makes popping cheaper
+Dynamic __hxcpp_deque_create(int inCapacity=0,bool inSingleConsumer=false);
 void    __hxcpp_deque_add(Dynamic q,Dynamic inVal);
 void    __hxcpp_deque_push(Dynamic q,Dynamic inVal);
 Dynamic __hxcpp_deque_pop(Dynamic q,bool block);
 
+Dynamic __hxcpp_pool_create(int inWorkers);
+Dynamic __hxcpp_pool_submit(Dynamic inPool,Dynamic inFunc);
+void    __hxcpp_pool_shutdown(Dynamic inPool);
+Dynamic __hxcpp_future_create();
+bool    __hxcpp_future_complete(Dynamic inFuture,Dynamic inValue,bool inFailed);
+bool    __hxcpp_future_done(Dynamic inFuture);
+Dynamic __hxcpp_future_get(Dynamic inFuture);
+
 Dynamic __hxcpp_tls_get(int inID);
 void    __hxcpp_tls_set(int inID,Dynamic inVal);
 
@@ -147,11 +203,27 @@ void    __hxcpp_tls_set(int inID,Dynamic inVal);
 
 Array<String> __hxcpp_get_call_stack(bool inSkipLast);
 Array<String> __hxcpp_get_exception_stack();
+// Exceptions of inClass (or a subclass) are thrown without capturing a stack
+void __hxcpp_set_control_flow_exception(Class inClass,bool inControlFlow);
 
 // --- Profile -------------------------------------------------------------------
 
 void __hxcpp_start_profiler(::String inDumpFile);
 void __hxcpp_stop_profiler();
+// Writes the results so far without stopping.  With HXCPP_PROFILE_INSTRUMENT, figures
+//  for threads still inside timed calls may be a call behind.
+void __hxcpp_dump_profiler(::String inDumpFile);
+
+// --- Trace ---------------------------------------------------------------------
+
+// Timeline spans, instants and counters per thread.  Flush writes everything
+// since the last flush as Chrome/Perfetto trace-event JSON.
+void __hxcpp_trace_enable(bool inEnable);
+void __hxcpp_trace_begin(::String inName);
+void __hxcpp_trace_end();
+void __hxcpp_trace_instant(::String inName);
+void __hxcpp_trace_counter(::String inName,double inValue);
+void __hxcpp_trace_flush(::String inFile);
 
 
 
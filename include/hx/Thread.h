@@ -14,10 +14,14 @@
 
 #include <windows.h>
 #include <process.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #else
 #include <errno.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <time.h>
 #endif
 
 #ifdef RegisterClass
@@ -27,6 +31,8 @@
 // Some functions used by AdvancedDebug.cpp
 // Returns the thread number of the calling thread
 int __hxcpp_GetCurrentThreadNumber();
+// Frees the calling thread's wait state, as it unregisters from the GC
+void __hxcpp_thread_release_waiter();
 
 #if defined(HX_WINDOWS)
 
@@ -145,6 +151,118 @@ struct TAutoLock
 typedef TAutoLock<MyMutex> AutoLock;
 
 
+// --- Atomics ------------------------------------------------------------
+//
+// Full-barrier read-modify-write helpers.  The Add functions return the previous value.
+
+#if defined(HX_WINDOWS)
+
+inline int HxAtomicAdd(volatile int *ioWhere, int inDelta)
+   { return InterlockedExchangeAdd((volatile LONG *)ioWhere, inDelta); }
+inline bool HxAtomicCas(volatile int *ioWhere, int inOld, int inNew)
+   { return InterlockedCompareExchange((volatile LONG *)ioWhere, inNew, inOld)==inOld; }
+inline bool HxAtomicCasPtr(void * volatile *ioWhere, void *inOld, void *inNew)
+   { return InterlockedCompareExchangePointer(ioWhere, inNew, inOld)==inOld; }
+inline int HxAtomicExchange(volatile int *ioWhere, int inValue)
+   { return InterlockedExchange((volatile LONG *)ioWhere, inValue); }
+inline void *HxAtomicExchangePtr(void * volatile *ioWhere, void *inValue)
+   { return InterlockedExchangePointer(ioWhere, inValue); }
+#ifdef _MSC_VER
+inline bool HxAtomicCas64(volatile long long *ioWhere, long long inOld, long long inNew)
+   { return _InterlockedCompareExchange64(ioWhere, inNew, inOld)==inOld; }
+#else
+inline bool HxAtomicCas64(volatile long long *ioWhere, long long inOld, long long inNew)
+   { return __sync_bool_compare_and_swap(ioWhere, inOld, inNew); }
+#endif
+inline void HxMemoryBarrier() { MemoryBarrier(); }
+
+#else
+
+inline int HxAtomicAdd(volatile int *ioWhere, int inDelta)
+   { return __sync_fetch_and_add(ioWhere, inDelta); }
+inline bool HxAtomicCas(volatile int *ioWhere, int inOld, int inNew)
+   { return __sync_bool_compare_and_swap(ioWhere, inOld, inNew); }
+inline bool HxAtomicCasPtr(void * volatile *ioWhere, void *inOld, void *inNew)
+   { return __sync_bool_compare_and_swap(ioWhere, inOld, inNew); }
+inline int HxAtomicExchange(volatile int *ioWhere, int inValue)
+{
+   int old;
+   do { old = *ioWhere; } while(!__sync_bool_compare_and_swap(ioWhere, old, inValue));
+   return old;
+}
+inline void *HxAtomicExchangePtr(void * volatile *ioWhere, void *inValue)
+{
+   void *old;
+   do { old = *ioWhere; } while(!__sync_bool_compare_and_swap(ioWhere, old, inValue));
+   return old;
+}
+inline bool HxAtomicCas64(volatile long long *ioWhere, long long inOld, long long inNew)
+   { return __sync_bool_compare_and_swap(ioWhere, inOld, inNew); }
+inline void HxMemoryBarrier() { __sync_synchronize(); }
+
+#endif
+
+// Publishing a fully built object through a shared pointer: the release store orders the
+//  construction before the pointer, and the acquire load orders the pointer before any
+//  reads through it.
+#if defined(HX_WINDOWS)
+// MSVC volatile accesses are already acquire/release on x86 and x64
+inline void *HxAtomicLoadAcquirePtr(void * volatile *ioWhere)
+{
+   void *value = *ioWhere;
+   #if !defined(_M_IX86) && !defined(_M_X64)
+   MemoryBarrier();
+   #endif
+   return value;
+}
+inline void HxAtomicStoreReleasePtr(void * volatile *ioWhere, void *inValue)
+{
+   #if !defined(_M_IX86) && !defined(_M_X64)
+   MemoryBarrier();
+   #endif
+   *ioWhere = inValue;
+}
+#elif defined(__ATOMIC_ACQUIRE)
+inline void *HxAtomicLoadAcquirePtr(void * volatile *ioWhere)
+   { return __atomic_load_n(ioWhere, __ATOMIC_ACQUIRE); }
+inline void HxAtomicStoreReleasePtr(void * volatile *ioWhere, void *inValue)
+   { __atomic_store_n(ioWhere, inValue, __ATOMIC_RELEASE); }
+#else
+inline void *HxAtomicLoadAcquirePtr(void * volatile *ioWhere)
+{
+   void *value = *ioWhere;
+   __sync_synchronize();
+   return value;
+}
+inline void HxAtomicStoreReleasePtr(void * volatile *ioWhere, void *inValue)
+{
+   __sync_synchronize();
+   *ioWhere = inValue;
+}
+#endif
+
+// 64-bit values may tear on 32-bit targets, so even plain loads go through a CAS
+inline long long HxAtomicLoad64(volatile long long *ioWhere)
+{
+   long long value;
+   do { value = *ioWhere; } while(!HxAtomicCas64(ioWhere, value, value));
+   return value;
+}
+inline long long HxAtomicAdd64(volatile long long *ioWhere, long long inDelta)
+{
+   long long old;
+   do { old = *ioWhere; } while(!HxAtomicCas64(ioWhere, old, old+inDelta));
+   return old;
+}
+inline long long HxAtomicExchange64(volatile long long *ioWhere, long long inValue)
+{
+   long long old;
+   do { old = *ioWhere; } while(!HxAtomicCas64(ioWhere, old, inValue));
+   return old;
+}
+
+
+
 #if defined(HX_WINDOWS)
 
 struct MySemaphore
@@ -221,7 +339,16 @@ struct MySemaphore
    {
       mSet = false;
       mValid = true;
+      #ifdef __APPLE__
       pthread_cond_init(&mCondition,0);
+      #else
+      // Time out against the monotonic clock, so changing the wall clock does not affect waits
+      pthread_condattr_t attr;
+      pthread_condattr_init(&attr);
+      pthread_condattr_setclock(&attr,CLOCK_MONOTONIC);
+      pthread_cond_init(&mCondition,&attr);
+      pthread_condattr_destroy(&attr);
+      #endif
    }
    ~MySemaphore()
    {
@@ -269,41 +396,37 @@ struct MySemaphore
    // Returns true if the wait was success, false on timeout.
    bool WaitFor(double inMilliseconds)
    {
-      struct timeval tv;
-      gettimeofday(&tv, 0);
-
-      int isec = ((int)inMilliseconds) / 1000;
-      int usec = (((int)inMilliseconds) % 1000) * 1000;
-      timespec spec;
-      spec.tv_nsec = (tv.tv_usec + usec) * 1000;
-      if (spec.tv_nsec>1000000000)
-      {
-         spec.tv_nsec-=1000000000;
-         isec++;
-      }
-      spec.tv_sec = tv.tv_sec + isec;
+      struct timespec deadline;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      long long ns = deadline.tv_nsec + (long long)(inMilliseconds*1000000.0);
+      deadline.tv_sec += (time_t)(ns / 1000000000);
+      deadline.tv_nsec = (long)(ns % 1000000000);
 
       AutoLock lock(mMutex);
-      if (mSet) {
-          mSet = false;
-          return true;
-      }
-
-      while (pthread_cond_timedwait
-           ( &mCondition, &mMutex.mMutex, &spec ) != ETIMEDOUT) {
-          if (mSet) {
-              mSet = false;
-              return true;
-          }
+      while(!mSet)
+      {
+         #ifdef __APPLE__
+         // No monotonic condition clock here, so wait for what is left
+         struct timespec now;
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         long long left = (long long)(deadline.tv_sec-now.tv_sec)*1000000000 + (deadline.tv_nsec-now.tv_nsec);
+         if (left<=0)
+            break;
+         struct timespec rel;
+         rel.tv_sec = (time_t)(left / 1000000000);
+         rel.tv_nsec = (long)(left % 1000000000);
+         pthread_cond_timedwait_relative_np( &mCondition, &mMutex.mMutex, &rel );
+         #else
+         if (pthread_cond_timedwait( &mCondition, &mMutex.mMutex, &deadline )==ETIMEDOUT)
+            break;
+         #endif
       }
 
       if (mSet) {
           mSet = false;
           return true;
       }
-      else {
-          return false;
-      }
+      return false;
    }
    void Clean()
    {
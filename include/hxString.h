@@ -159,6 +159,8 @@ public:
 
 	// This is used by the string-wrapped-as-dynamic class
    Dynamic __Field(const ::String &inString, bool inCallProp);
+   // Calls a method with an argument span, without making a closure for it.  For CFFI val_ocall.
+   Dynamic __FieldCall(const ::String &inName, const Dynamic *inArgs, int inArgCount);
 
 	// The actual implementation.
 	// Note that "__s" is const - if you want to change it, you should create a new string.
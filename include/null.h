@@ -81,6 +81,9 @@ class null
      operator double () { return 0; }
      operator float () { return 0; }
      operator unsigned char () { return 0; }
+     operator signed char () { return 0; }
+     operator short () { return 0; }
+     operator unsigned short () { return 0; }
 
      bool operator == (null inRHS) const { return true; }
      bool operator != (null inRHS) const { return false; }
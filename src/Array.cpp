@@ -11,6 +11,7 @@ namespace hx
 ArrayBase::ArrayBase(int inSize,int inReserve,int inElementSize,bool inAtomic)
 {
    length = inSize;
+   mOffset = 0;
    mAlloc = inSize < inReserve ? inReserve : inSize;
    if (mAlloc)
    {
@@ -27,6 +28,8 @@ void ArrayBase::EnsureSize(int inSize) const
    int s = inSize;
    if (s>length)
    {
+      if (s>mAlloc && mOffset)
+         Compact();
       if (s>mAlloc)
       {
          mAlloc = s*3/2 + 10;
@@ -81,8 +84,9 @@ void ArrayBase::__SetSize(int inSize)
  
 void ArrayBase::__SetSizeExact(int inSize)
 {
-   if (inSize!=length || inSize!=mAlloc)
+   if (inSize!=length || inSize!=mAlloc || mOffset)
    {
+      Compact();
       mAlloc = length = inSize;
       int bytes = mAlloc * GetElementSize();
       if (mBase)
@@ -105,9 +109,56 @@ void ArrayBase::__SetSizeExact(int inSize)
 
 
 
+void ArrayBase::Compact() const
+{
+   if (mOffset)
+   {
+      int s = GetElementSize();
+      char *alloc = mBase - mOffset*s;
+      memmove(alloc, mBase, length*s);
+      // Clear the slots vacated at the end of the live range
+      memset(alloc + length*s, 0, mOffset*s);
+      mBase = alloc;
+      mAlloc += mOffset;
+      mOffset = 0;
+   }
+}
+
+// Make some room before the first element, so repeated unshifts do not need to move the data
+void ArrayBase::ReserveHead()
+{
+   int s = GetElementSize();
+   int head = length/2 + 4;
+   if (mAlloc-length >= head)
+   {
+      memmove(mBase + head*s, mBase, length*s);
+      memset(mBase, 0, head*s);
+      mAlloc -= head;
+   }
+   else
+   {
+      int bytes = (head + mAlloc) * s;
+      char *alloc = (char *)( AllocAtomic() ? hx::NewGCPrivate(0,bytes) : hx::NewGCBytes(0,bytes) );
+      memcpy(alloc + head*s, mBase, length*s);
+      mBase = alloc;
+   }
+   mBase += head*s;
+   mOffset = head;
+}
+
 void ArrayBase::Insert(int inPos)
 {
-   if (inPos>=length)
+   if (inPos==0 && length>0)
+   {
+      if (!mOffset)
+         ReserveHead();
+      int s = GetElementSize();
+      mBase -= s;
+      mOffset--;
+      mAlloc++;
+      length++;
+   }
+   else if (inPos>=length)
       __SetSize(length+1);
    else
    {
@@ -166,7 +217,19 @@ void ArrayBase::Slice(ArrayBase *outResult,int inPos,int inEnd)
 
 void ArrayBase::RemoveElement(int inPos)
 {
-   if (inPos<length)
+   if (inPos==0 && length>0)
+   {
+      int s = GetElementSize();
+      memset(mBase, 0, s);
+      mBase += s;
+      mOffset++;
+      mAlloc--;
+      length--;
+      // Only pay for the move once the wasted space exceeds the live data
+      if (mOffset>length)
+         Compact();
+   }
+   else if (inPos<length)
    {
       int s = GetElementSize();
       memmove(mBase + inPos*s, mBase+inPos*s + s, (length-inPos-1)*s );
@@ -186,29 +249,179 @@ void ArrayBase::Concat(ArrayBase *outResult,const char *inSecond,int inLen)
 }
 
 
+#ifdef HX_WINDOWS
+#define JOIN_SNPRINTF _snprintf
+#else
+#define JOIN_SNPRINTF snprintf
+#endif
+
+// Growable, non-GC buffer used to build the joined string.
+// Only the final result is allocated as a GC string.
+class JoinBuffer
+{
+public:
+   JoinBuffer(const String &inSeparator,int inReserve) :
+      mSep(inSeparator.__s), mSepLen(inSeparator.length), mSize(0), mAlloc(0), mData(0)
+   {
+      Reserve(inReserve);
+   }
+   ~JoinBuffer() { free(mData); }
+
+   inline HX_CHAR *Reserve(int inChars)
+   {
+      if (mSize+inChars>mAlloc)
+      {
+         mAlloc = (mSize+inChars)*3/2 + 64;
+         mData = (HX_CHAR *)realloc(mData,mAlloc*sizeof(HX_CHAR));
+      }
+      return mData + mSize;
+   }
+
+   inline void Append(const HX_CHAR *inStr,int inLen)
+   {
+      memcpy(Reserve(inLen),inStr,inLen*sizeof(HX_CHAR));
+      mSize += inLen;
+   }
+   inline void Separate(int inIndex) { if (inIndex && mSepLen) Append(mSep,mSepLen); }
+
+   void AppendInt(int inVal)
+   {
+      HX_CHAR *dest = Reserve(12);
+      unsigned int val = inVal<0 ? 0u-(unsigned int)inVal : (unsigned int)inVal;
+      HX_CHAR digits[12];
+      int n = 0;
+      do {
+         digits[n++] = '0' + (val % 10);
+         val /= 10;
+      } while(val);
+      if (inVal<0)
+         *dest++ = '-';
+      mSize += n + (inVal<0);
+      while(n)
+         *dest++ = digits[--n];
+   }
+
+   void AppendDouble(double inVal)
+   {
+      HX_CHAR *dest = Reserve(32);
+      int n = JOIN_SNPRINTF(dest,32,"%.10g",inVal);
+      if (n>0)
+         mSize += n<32 ? n : 31;
+   }
+
+   String ToString()
+   {
+      HX_CHAR *result = hx::NewString(mSize);
+      memcpy(result,mData,mSize*sizeof(HX_CHAR));
+      return String(result,mSize);
+   }
+
+   const HX_CHAR *mSep;
+   int      mSepLen;
+   int      mSize;
+   int      mAlloc;
+   HX_CHAR  *mData;
+};
+
+
 String ArrayBase::join(String inSeparator)
 {
-   int len = 0;
+   JoinBuffer buf(inSeparator,length*(inSeparator.length+4));
    for(int i=0;i<length;i++)
    {
-      len += ItemString(i).length;
+      buf.Separate(i);
+      String s = ItemString(i);
+      buf.Append(s.__s,s.length);
    }
-   if (length) len += (length-1) * inSeparator.length;
+   return buf.ToString();
+}
 
-   HX_CHAR *buf = hx::NewString(len);
+template<typename T>
+static String JoinInts(ArrayBase *inArray,const T *inData,const String &inSeparator)
+{
+   int n = inArray->length;
+   JoinBuffer buf(inSeparator,n*(inSeparator.length+4));
+   for(int i=0;i<n;i++)
+   {
+      buf.Separate(i);
+      buf.AppendInt(inData[i]);
+   }
+   return buf.ToString();
+}
+
+template<typename T>
+static String JoinFloats(ArrayBase *inArray,const T *inData,const String &inSeparator)
+{
+   int n = inArray->length;
+   JoinBuffer buf(inSeparator,n*(inSeparator.length+10));
+   for(int i=0;i<n;i++)
+   {
+      buf.Separate(i);
+      buf.AppendDouble(inData[i]);
+   }
+   return buf.ToString();
+}
 
+String ArrayJoin(ArrayBase *inArray,const int *inData,const String &inSeparator)
+   { return JoinInts(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const unsigned char *inData,const String &inSeparator)
+   { return JoinInts(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const signed char *inData,const String &inSeparator)
+   { return JoinInts(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const short *inData,const String &inSeparator)
+   { return JoinInts(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const unsigned short *inData,const String &inSeparator)
+   { return JoinInts(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const double *inData,const String &inSeparator)
+   { return JoinFloats(inArray,inData,inSeparator); }
+String ArrayJoin(ArrayBase *inArray,const float *inData,const String &inSeparator)
+   { return JoinFloats(inArray,inData,inSeparator); }
+
+String ArrayJoin(ArrayBase *inArray,const bool *inData,const String &inSeparator)
+{
+   int n = inArray->length;
+   JoinBuffer buf(inSeparator,n*(inSeparator.length+5));
+   for(int i=0;i<n;i++)
+   {
+      buf.Separate(i);
+      if (inData[i])
+         buf.Append("true",4);
+      else
+         buf.Append("false",5);
+   }
+   return buf.ToString();
+}
+
+String ArrayJoin(ArrayBase *inArray,const String *inData,const String &inSeparator)
+{
+   // Strings are already in memory, so measure once and copy once directly into the result
+   int n = inArray->length;
+   int len = 0;
+   for(int i=0;i<n;i++)
+      len += inData[i].__s ? inData[i].length : 4;
+   if (n) len += (n-1) * inSeparator.length;
+
+   HX_CHAR *buf = hx::NewString(len);
    int pos = 0;
    bool separated = inSeparator.length>0;
-   for(int i=0;i<length;i++)
+   for(int i=0;i<n;i++)
    {
-      String s = ItemString(i);
-      memcpy(buf+pos,s.__s,s.length*sizeof(HX_CHAR));
-      pos += s.length;
-      if (separated && (i+1<length) )
+      if (separated && i)
       {
          memcpy(buf+pos,inSeparator.__s,inSeparator.length*sizeof(HX_CHAR));
          pos += inSeparator.length;
       }
+      const String &s = inData[i];
+      if (s.__s)
+      {
+         memcpy(buf+pos,s.__s,s.length*sizeof(HX_CHAR));
+         pos += s.length;
+      }
+      else
+      {
+         memcpy(buf+pos,"null",4*sizeof(HX_CHAR));
+         pos += 4;
+      }
    }
    buf[len] = '\0';
 
@@ -262,6 +475,8 @@ DEFINE_ARRAY_FUNC0(toString);
 DEFINE_ARRAY_FUNC1(unshift);
 DEFINE_ARRAY_FUNC1(map);
 DEFINE_ARRAY_FUNC1(filter);
+DEFINE_ARRAY_FUNC2(indexOf);
+DEFINE_ARRAY_FUNC2(lastIndexOf);
 
 Dynamic ArrayBase::__Field(const String &inString, bool inCallProp)
 {
@@ -283,9 +498,48 @@ Dynamic ArrayBase::__Field(const String &inString, bool inCallProp)
    if (inString==HX_CSTRING("unshift")) return unshift_dyn();
    if (inString==HX_CSTRING("filter")) return filter_dyn();
    if (inString==HX_CSTRING("map")) return map_dyn();
+   if (inString==HX_CSTRING("indexOf")) return indexOf_dyn();
+   if (inString==HX_CSTRING("lastIndexOf")) return lastIndexOf_dyn();
    return null();
 }
 
+// Methods take between MIN and N arguments.  Missing optional arguments are passed as null,
+//  and any other count goes through the closure so it reports the error as before.
+#define ARRAY_FIELD_CALL(func,MIN,N) \
+   if (inName==HX_CSTRING(#func)) \
+   { \
+      if (inArgCount<MIN || inArgCount>N) \
+         return hx::RunArgs(func##_dyn().GetPtr(),inArgs,inArgCount); \
+      if (inArgCount<N) \
+         inArgs = hx::PadArgs(padded,inArgs,inArgCount); \
+      return __##func(HX_ARR_LIST##N); \
+   }
+
+Dynamic ArrayBase::__FieldCall(const String &inName,const Dynamic *inArgs,int inArgCount)
+{
+   Dynamic padded[2];
+   ARRAY_FIELD_CALL(push,1,1)
+   ARRAY_FIELD_CALL(pop,0,0)
+   ARRAY_FIELD_CALL(shift,0,0)
+   ARRAY_FIELD_CALL(unshift,1,1)
+   ARRAY_FIELD_CALL(insert,2,2)
+   ARRAY_FIELD_CALL(remove,1,1)
+   ARRAY_FIELD_CALL(indexOf,1,2)
+   ARRAY_FIELD_CALL(lastIndexOf,1,2)
+   ARRAY_FIELD_CALL(join,1,1)
+   ARRAY_FIELD_CALL(concat,1,1)
+   ARRAY_FIELD_CALL(copy,0,0)
+   ARRAY_FIELD_CALL(iterator,0,0)
+   ARRAY_FIELD_CALL(reverse,0,0)
+   ARRAY_FIELD_CALL(slice,1,2)
+   ARRAY_FIELD_CALL(splice,2,2)
+   ARRAY_FIELD_CALL(sort,1,1)
+   ARRAY_FIELD_CALL(toString,0,0)
+   ARRAY_FIELD_CALL(map,1,1)
+   ARRAY_FIELD_CALL(filter,1,1)
+   return hx::RunArgs(__Field(inName,true).GetPtr(),inArgs,inArgCount);
+}
+
 
 static String sArrayFields[] = {
    HX_CSTRING("length"),
@@ -306,6 +560,8 @@ static String sArrayFields[] = {
    HX_CSTRING("unshift"),
    HX_CSTRING("filter"),
    HX_CSTRING("map"),
+   HX_CSTRING("indexOf"),
+   HX_CSTRING("lastIndexOf"),
    String(null())
 };
 
@@ -1,5 +1,5 @@
 #include <hxcpp.h>
-#include <map>
+#include <vector>
 
 #ifdef ANDROID
 #include <android/log.h>
@@ -9,7 +9,88 @@
 namespace hx
 {
 
-typedef std::map<String,Class> ClassMap;
+// Registered classes, open-addressed on the hash of the name.  The hash is kept
+//  with each entry so a lookup only compares names whose hashes match.
+class ClassMap
+{
+public:
+   struct Entry
+   {
+      String       name;
+      unsigned int hash;
+      Class        value;
+   };
+
+   ClassMap() : mMask(63) { mSlots.resize(mMask+1,-1); }
+
+   static unsigned int Hash(const String &inName)
+   {
+      unsigned int h = 2166136261U;
+      for(int i=0;i<inName.length;i++)
+         h = (h ^ (unsigned int)inName.__s[i]) * 16777619U;
+      return h;
+   }
+
+   Class_obj *Find(const String &inName) const
+   {
+      int idx = FindSlot(inName,Hash(inName));
+      return mSlots[idx]<0 ? 0 : mEntries[ mSlots[idx] ].value.mPtr;
+   }
+
+   void Set(const String &inName, Class inClass)
+   {
+      unsigned int hash = Hash(inName);
+      int idx = FindSlot(inName,hash);
+      if (mSlots[idx]>=0)
+      {
+         mEntries[ mSlots[idx] ].value = inClass;
+         return;
+      }
+      Entry e;
+      e.name = inName;
+      e.hash = hash;
+      e.value = inClass;
+      mSlots[idx] = (int)mEntries.size();
+      mEntries.push_back(e);
+      if (mEntries.size()*2 > mSlots.size())
+         Rehash();
+   }
+
+   int size() const { return (int)mEntries.size(); }
+   Entry &operator[](int inIndex) { return mEntries[inIndex]; }
+
+private:
+   int FindSlot(const String &inName,unsigned int inHash) const
+   {
+      int idx = inHash & mMask;
+      while(mSlots[idx]>=0)
+      {
+         const Entry &e = mEntries[ mSlots[idx] ];
+         if (e.hash==inHash && e.name==inName)
+            break;
+         idx = (idx+1) & mMask;
+      }
+      return idx;
+   }
+
+   void Rehash()
+   {
+      mMask = mMask*2+1;
+      mSlots.assign(mMask+1,-1);
+      for(int i=0;i<(int)mEntries.size();i++)
+      {
+         int idx = mEntries[i].hash & mMask;
+         while(mSlots[idx]>=0)
+            idx = (idx+1) & mMask;
+         mSlots[idx] = i;
+      }
+   }
+
+   unsigned int       mMask;
+   std::vector<int>   mSlots;
+   std::vector<Entry> mEntries;
+};
+
 static ClassMap *sClassMap = 0;
 
 Class RegisterClass(const String &inClassName, CanCastFunc inCanCast,
@@ -33,7 +114,7 @@ Class RegisterClass(const String &inClassName, CanCastFunc inCanCast,
                                   #endif
                                   );
    Class c(obj);
-   (*sClassMap)[inClassName] = c;
+   sClassMap->Set(inClassName,c);
    return c;
 }
 
@@ -41,7 +122,7 @@ void RegisterClass(const String &inClassName, Class inClass)
 {
    if (sClassMap==0)
       sClassMap = new ClassMap;
-   (*sClassMap)[inClassName] = inClass;
+   sClassMap->Set(inClassName,inClass);
 }
 
 
@@ -66,6 +147,7 @@ Class_obj::Class_obj(const String &inClassName,String inStatics[], String inMemb
    mSuper = inSuperClass;
    mConstructEmpty = inConstructEmpty;
    mConstructArgs = inConstructArgs;
+   mConstructSpan = 0;
    mConstructEnum = inConstructEnum;
    mMarkFunc = inFunc;
    #ifdef HXCPP_VISIT_ALLOCS
@@ -140,10 +222,10 @@ void Class_obj::VisitStatics(hx::VisitContext *__inCtx)
 
 Class Class_obj::Resolve(String inName)
 {
-   ClassMap::const_iterator i = sClassMap->find(inName);
-   if (i==sClassMap->end())
+   Class_obj *result = sClassMap ? sClassMap->Find(inName) : 0;
+   if (!result)
       return null();
-   return i->second;
+   return result;
 }
 
 Dynamic Class_obj::ConstructEmpty()
@@ -156,6 +238,16 @@ Dynamic Class_obj::ConstructArgs(DynamicArray inArgs)
    return mConstructArgs(inArgs);
 }
 
+Dynamic Class_obj::ConstructArgs(const Dynamic *inArgs,int inArgCount)
+{
+   if (mConstructSpan)
+      return mConstructSpan(inArgs,inArgCount);
+   Array<Dynamic> args = Array_obj<Dynamic>::__new(inArgCount,inArgCount);
+   for(int i=0;i<inArgCount;i++)
+      args->__unsafe_set(i,inArgs[i]);
+   return ConstructArgs(args);
+}
+
 Dynamic Class_obj::ConstructEnum(String inName,DynamicArray inArgs)
 {
    if (mConstructEnum==0)
@@ -245,20 +337,20 @@ void MarkClassStatics(hx::MarkContext *__inCtx)
    #ifdef HXCPP_DEBUG
    MarkPushClass("MarkClassStatics",__inCtx);
    #endif
-   ClassMap::iterator end = sClassMap->end();
-   for(ClassMap::iterator i = sClassMap->begin(); i!=end; ++i)
+   for(int c=0;c<sClassMap->size();c++)
    {
-      HX_MARK_MEMBER(i->first);
+      ClassMap::Entry &entry = (*sClassMap)[c];
+      HX_MARK_MEMBER(entry.name);
 
-      // all strings should be constants anyhow - HX_MARK_MEMBER(i->first);
-      HX_MARK_OBJECT(i->second.mPtr);
+      // all strings should be constants anyhow - HX_MARK_MEMBER(entry.name);
+      HX_MARK_OBJECT(entry.value.mPtr);
 
       #ifdef HXCPP_DEBUG
-      hx::MarkPushClass(i->first.__s,__inCtx);
+      hx::MarkPushClass(entry.name.__s,__inCtx);
       hx::MarkSetMember("statics",__inCtx);
       #endif
    
-      i->second->MarkStatics(__inCtx);
+      entry.value->MarkStatics(__inCtx);
 
       #ifdef HXCPP_DEBUG
       hx::MarkPopClass(__inCtx);
@@ -274,15 +366,15 @@ void MarkClassStatics(hx::MarkContext *__inCtx)
 void VisitClassStatics(hx::VisitContext *__inCtx)
 {
    HX_VISIT_MEMBER(Class_obj__mClass);
-   ClassMap::iterator end = sClassMap->end();
-   for(ClassMap::iterator i = sClassMap->begin(); i!=end; ++i)
+   for(int c=0;c<sClassMap->size();c++)
    {
+      ClassMap::Entry &entry = (*sClassMap)[c];
       // all strings should be constants anyhow - should not be needed?
-      HX_VISIT_STRING(i->first.__s);
+      HX_VISIT_STRING(entry.name.__s);
 
-      HX_VISIT_OBJECT(i->second.mPtr);
+      HX_VISIT_OBJECT(entry.value.mPtr);
 
-      i->second->VisitStatics(__inCtx);
+      entry.value->VisitStatics(__inCtx);
    }
 }
 
@@ -42,7 +42,7 @@ public:
    IntData(int inValue=0) : mValue(inValue) {};
 
    Class __GetClass() const { return __IntClass; }
-   bool __Is(hx::Object *inClass) const { return dynamic_cast< IntData *>(inClass); }
+   bool __Is(hx::Object *inClass) const { return hx::DynamicCast<IntData>(inClass); }
 
    virtual int __GetType() const { return vtInt; }
 
@@ -68,7 +68,7 @@ public:
    BoolData(bool inValue=false) : mValue(inValue) {};
 
    Class __GetClass() const { return __BoolClass; }
-   bool __Is(hx::Object *inClass) const { return dynamic_cast< BoolData *>(inClass); }
+   bool __Is(hx::Object *inClass) const { return hx::DynamicCast<BoolData>(inClass); }
 
    virtual int __GetType() const { return vtBool; }
 
@@ -95,7 +95,7 @@ public:
    DoubleData(double inValue=0) : mValue(inValue) {};
 
    Class __GetClass() const { return __FloatClass; }
-   bool __Is(hx::Object *inClass) const { return dynamic_cast< DoubleData *>(inClass); }
+   bool __Is(hx::Object *inClass) const { return hx::DynamicCast<DoubleData>(inClass); }
 
    virtual int __GetType() const { return vtFloat; }
    String toString() { return String(mValue); }
@@ -114,7 +114,57 @@ public:
 };
 
 
+// Immortal boxes for small ints.  These live outside the GC heap with a zero
+//  header, so marking only touches the mark byte and they are never moved or swept.
+#ifndef HXCPP_INT_CACHE_MIN
+#define HXCPP_INT_CACHE_MIN -128
+#endif
+#ifndef HXCPP_INT_CACHE_MAX
+#define HXCPP_INT_CACHE_MAX 1023
+#endif
+
+enum { INT_CACHE_STRIDE = sizeof(void *) + sizeof(IntData) };
+
+static char *sIntCache = 0;
+
+inline bool IsCachedInt(int inVal)
+{
+   return inVal>=HXCPP_INT_CACHE_MIN && inVal<=HXCPP_INT_CACHE_MAX;
+}
+
+inline hx::Object *CachedInt(int inVal)
+{
+   return (hx::Object *)(sIntCache + (inVal-HXCPP_INT_CACHE_MIN)*INT_CACHE_STRIDE + sizeof(void *));
+}
 
+inline hx::Object *NewInt(int inVal)
+{
+   if (IsCachedInt(inVal) && sIntCache)
+      return CachedInt(inVal);
+   return new IntData(inVal);
+}
+
+inline hx::Object *NewDouble(double inVal)
+{
+   if (inVal>=HXCPP_INT_CACHE_MIN && inVal<=HXCPP_INT_CACHE_MAX && sIntCache)
+   {
+      int i = (int)inVal;
+      if (i==inVal)
+         return CachedInt(i);
+   }
+   return new DoubleData(inVal);
+}
+
+static void InitIntCache()
+{
+   if (sIntCache)
+      return;
+   int count = HXCPP_INT_CACHE_MAX - HXCPP_INT_CACHE_MIN + 1;
+   char *cache = (char *)calloc(count,INT_CACHE_STRIDE);
+   for(int i=0;i<count;i++)
+      ::new(cache + i*INT_CACHE_STRIDE + sizeof(void *)) IntData(i+HXCPP_INT_CACHE_MIN);
+   sIntCache = cache;
+}
 
 }
 
@@ -125,14 +175,10 @@ public:
 
 
 Dynamic::Dynamic(bool inVal) : super( inVal ? hx::DynTrue.mPtr : hx::DynFalse.mPtr ) { }
-Dynamic::Dynamic(int inVal) :
-  super( inVal==0 ? hx::DynZero.mPtr : inVal==1 ? hx::DynOne.mPtr : (hx::Object *)new IntData(inVal) ) { }
-Dynamic::Dynamic(double inVal) :
-  super(inVal==0 ? hx::DynZero.mPtr : inVal==1 ? hx::DynOne.mPtr :  (hx::Object *)new DoubleData(inVal) ) { }
-Dynamic::Dynamic(float inVal) :
-  super(inVal==0 ? hx::DynZero.mPtr : inVal==1 ? hx::DynOne.mPtr :  (hx::Object *)new DoubleData(inVal) ) { }
-Dynamic::Dynamic(const cpp::CppInt32__ &inVal) :
-  super(inVal.mValue==0 ? hx::DynZero.mPtr : inVal.mValue==1 ? hx::DynOne.mPtr :  (hx::Object *)new IntData((int)inVal) ) { }
+Dynamic::Dynamic(int inVal) : super( hx::NewInt(inVal) ) { }
+Dynamic::Dynamic(double inVal) : super( hx::NewDouble(inVal) ) { }
+Dynamic::Dynamic(float inVal) : super( hx::NewDouble(inVal) ) { }
+Dynamic::Dynamic(const cpp::CppInt32__ &inVal) : super( hx::NewInt(inVal.mValue) ) { }
 Dynamic::Dynamic(const String &inVal) :
   super( inVal.__s ? (inVal.length==0 ? DynEmptyString.mPtr : inVal.__ToObject() ) : 0 ) { }
 Dynamic::Dynamic(const HX_CHAR *inVal) :
@@ -233,7 +279,7 @@ static bool IsInt(hx::Object *inPtr)
       return false;
    if (TCanCast<IntData>(inPtr))
       return true;
-   DoubleData *d = dynamic_cast<DoubleData *>(inPtr);
+   DoubleData *d = hx::DynamicCast<DoubleData>(inPtr);
    if (!d)
       return false;
    double val = d->__ToDouble();
@@ -293,8 +339,9 @@ void Dynamic::__boot()
    Static(__BoolClass) = hx::RegisterClass(HX_CSTRING("Bool"),TCanCast<BoolData>,sNone,sNone, 0,0, 0);
    Static(__IntClass) = hx::RegisterClass(HX_CSTRING("Int"),IsInt,sNone,sNone,0,0, 0 );
    Static(__FloatClass) = hx::RegisterClass(HX_CSTRING("Float"),IsFloat,sNone,sNone, 0,0,&__IntClass );
-   DynZero = Dynamic( new hx::IntData(0) );
-   DynOne = Dynamic( new hx::IntData(1) );
+   hx::InitIntCache();
+   DynZero = Dynamic( hx::NewInt(0) );
+   DynOne = Dynamic( hx::NewInt(1) );
    DynTrue = Dynamic( new hx::BoolData(true) );
    DynFalse = Dynamic( new hx::BoolData(false) );
    DynEmptyString = Dynamic(HX_CSTRING("").__ToObject());
@@ -1,4 +1,5 @@
 #include <hxcpp.h>
+#include <hx/Thread.h>
 
 
 // -------- Enums ---------------------------------
@@ -9,6 +10,21 @@ namespace hx
 Dynamic EnumBase_obj::__Create(DynamicArray inArgs) { return new hx::EnumBase_obj; }
 Dynamic EnumBase_obj::__CreateEmpty() { return new hx::EnumBase_obj; }
 
+hx::Object *EnumStaticLookup(hx::Object **ioLookup, hx::Object *(*inCreate)())
+{
+   void * volatile *slot = (void * volatile *)ioLookup;
+   hx::Object *lookup = (hx::Object *)HxAtomicLoadAcquirePtr(slot);
+   if (!lookup)
+   {
+      // Adding the same root twice is harmless, and the loser of a race is just garbage
+      lookup = inCreate();
+      GCAddRoot(ioLookup);
+      if (!HxAtomicCasPtr(slot,0,lookup))
+         lookup = (hx::Object *)HxAtomicLoadAcquirePtr(slot);
+   }
+   return lookup;
+}
+
 
 int EnumBase_obj::__FindIndex(String inName)
 {
@@ -973,6 +973,32 @@ Dynamic String::__Field(const String &inString, bool inCallProp)
    return null();
 }
 
+// As ARRAY_FIELD_CALL - methods take between MIN and N arguments
+#define STRING_FIELD_CALL(func,MIN,N) \
+   if (HX_FIELD_EQ(inName,#func)) \
+   { \
+      if (inArgCount<MIN || inArgCount>N) \
+         return hx::RunArgs(func##_dyn().GetPtr(),inArgs,inArgCount); \
+      if (inArgCount<N) \
+         inArgs = hx::PadArgs(padded,inArgs,inArgCount); \
+      return Dynamic(func(HX_ARR_LIST##N)); \
+   }
+
+Dynamic String::__FieldCall(const String &inName, const Dynamic *inArgs, int inArgCount)
+{
+   Dynamic padded[2];
+   STRING_FIELD_CALL(charAt,1,1)
+   STRING_FIELD_CALL(charCodeAt,1,1)
+   STRING_FIELD_CALL(indexOf,1,2)
+   STRING_FIELD_CALL(lastIndexOf,1,2)
+   STRING_FIELD_CALL(split,1,1)
+   STRING_FIELD_CALL(substr,1,2)
+   STRING_FIELD_CALL(toLowerCase,0,0)
+   STRING_FIELD_CALL(toUpperCase,0,0)
+   STRING_FIELD_CALL(toString,0,0)
+   return hx::RunArgs(__Field(inName,true).GetPtr(),inArgs,inArgCount);
+}
+
 
 static String sStringStatics[] = {
    HX_CSTRING("fromCharCode"),
@@ -1051,7 +1077,7 @@ public:
    StringData(String inValue) : mValue(inValue) {};
 
    Class __GetClass() const { return __StringClass; }
-   bool __Is(hx::Object *inClass) const { return dynamic_cast< StringData *>(inClass); }
+   bool __Is(hx::Object *inClass) const { return hx::DynamicCast<StringData>(inClass); }
 
    virtual int __GetType() const { return vtString; }
    String __ToString() const { return mValue; }
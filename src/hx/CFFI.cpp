@@ -331,7 +331,7 @@ void val_array_set_size(hx::Object * arg1,int inLen)
 
 void val_array_push(hx::Object * arg1,hx::Object *inValue)
 {
-   hx::ArrayBase *base = dynamic_cast<hx::ArrayBase *>(arg1);
+   hx::ArrayBase *base = hx::DynamicCast<hx::ArrayBase>(arg1);
    if (base==0) return;
    base->__push(inValue);
 }
@@ -349,7 +349,7 @@ hx::Object * alloc_array(int arg1)
 // Resizing the array may invalidate the pointer
 bool * val_array_bool(hx::Object * arg1)
 {
-   Array_obj<bool> *a = dynamic_cast< Array_obj<bool> * >(arg1);
+   Array_obj<bool> *a = hx::DynamicCast< Array_obj<bool> >(arg1);
    if (a==0)
       return 0;
    return (bool *)a->GetBase();
@@ -358,7 +358,7 @@ bool * val_array_bool(hx::Object * arg1)
 
 int * val_array_int(hx::Object * arg1)
 {
-   Array_obj<int> *a = dynamic_cast< Array_obj<int> * >(arg1);
+   Array_obj<int> *a = hx::DynamicCast< Array_obj<int> >(arg1);
    if (a==0)
       return 0;
    return (int *)a->GetBase();
@@ -367,7 +367,7 @@ int * val_array_int(hx::Object * arg1)
 
 double * val_array_double(hx::Object * arg1)
 {
-   Array_obj<double> *a = dynamic_cast< Array_obj<double> * >(arg1);
+   Array_obj<double> *a = hx::DynamicCast< Array_obj<double> >(arg1);
    if (a==0)
       return 0;
    return (double *)a->GetBase();
@@ -376,7 +376,7 @@ double * val_array_double(hx::Object * arg1)
 
 float * val_array_float(hx::Object * arg1)
 {
-   Array_obj<float> *a = dynamic_cast< Array_obj<float> * >(arg1);
+   Array_obj<float> *a = hx::DynamicCast< Array_obj<float> >(arg1);
    if (a==0)
       return 0;
    return (float *)a->GetBase();
@@ -396,7 +396,7 @@ typedef Array_obj<unsigned char> *ByteArray;
 // The byte array may be a string or a Array<bytes> depending on implementation
 buffer val_to_buffer(hx::Object * arg1)
 {
-   ByteArray b = dynamic_cast< ByteArray >(arg1);
+   ByteArray b = hx::DynamicCast< Array_obj<unsigned char> >(arg1);
    return (buffer)b;
 }
 
@@ -549,39 +549,55 @@ hx::Object * val_call3(hx::Object * arg1,hx::Object * arg2,hx::Object * arg3,hx:
 hx::Object * val_callN(hx::Object * arg1,hx::Object ** arg2, int nCount) THROWS
 {
    if (!arg1) Dynamic::ThrowBadFunctionError();
-   Array<Dynamic> args = Array_obj<Dynamic>::__new(0, nCount);
-   while (nCount--)
-     args << *arg2++;
-   return arg1->__Run( args ).GetPtr();
+   return arg1->__runArgs( (const Dynamic *)arg2, nCount ).GetPtr();
 }
 
 
 // Call object field
+// Array and string methods are called directly, rather than through a new closure
+static Dynamic FieldCall(hx::Object *inObj,int inFieldID,const Dynamic *inArgs,int inArgCount)
+{
+   hx::Object *real = inObj->__GetRealObject();
+   int type = real->__GetType();
+   if (type==vtArray)
+   {
+      hx::ArrayBase *array = hx::DynamicCast<hx::ArrayBase>(real);
+      if (array)
+         return array->__FieldCall(__hxcpp_field_from_id(inFieldID),inArgs,inArgCount);
+   }
+   else if (type==vtString)
+      return real->toString().__FieldCall(__hxcpp_field_from_id(inFieldID),inArgs,inArgCount);
+   return hx::RunArgs(inObj->__IField(inFieldID).GetPtr(),inArgs,inArgCount);
+}
+
 hx::Object * val_ocall0(hx::Object * arg1,int arg2) THROWS
 {
    if (!arg1) hx::Throw(HX_INVALID_OBJECT);
-   return arg1->__IField(arg2)->__run().GetPtr();
+   return FieldCall(arg1,arg2,0,0).GetPtr();
 }
 
 
 hx::Object * val_ocall1(hx::Object * arg1,int arg2,hx::Object * arg3) THROWS
 {
    if (!arg1) hx::Throw(HX_INVALID_OBJECT);
-   return arg1->__IField(arg2)->__run(arg3).GetPtr();
+   Dynamic args[] = { arg3 };
+   return FieldCall(arg1,arg2,args,1).GetPtr();
 }
 
 
 hx::Object * val_ocall2(hx::Object * arg1,int arg2,hx::Object * arg3,hx::Object * arg4) THROWS
 {
    if (!arg1) hx::Throw(HX_INVALID_OBJECT);
-   return arg1->__IField(arg2)->__run(arg3,arg4).GetPtr();
+   Dynamic args[] = { arg3, arg4 };
+   return FieldCall(arg1,arg2,args,2).GetPtr();
 }
 
 
 hx::Object * val_ocall3(hx::Object * arg1,int arg2,hx::Object * arg3,hx::Object * arg4,hx::Object * arg5) THROWS
 {
    if (!arg1) hx::Throw(HX_INVALID_OBJECT);
-   return arg1->__IField(arg2)->__run(arg3,arg4,arg5).GetPtr();
+   Dynamic args[] = { arg3, arg4, arg5 };
+   return FieldCall(arg1,arg2,args,3).GetPtr();
 }
 
 
@@ -676,7 +692,7 @@ void * alloc_private(int arg1)
 
 void  val_gc(hx::Object * arg1,hx::finalizer arg2) THROWS
 {
-   hx::Abstract_obj *abstract = dynamic_cast<hx::Abstract_obj *>(arg1);
+   hx::Abstract_obj *abstract = hx::DynamicCast<hx::Abstract_obj>(arg1);
    if (!abstract)
    {
       hx::GCSetFinalizer(arg1,arg2);
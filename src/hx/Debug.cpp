@@ -1,6 +1,8 @@
 #include "hxcpp.h"
 #include <list>
 #include <map>
+#include <set>
+#include <string>
 #include <vector>
 #include <hxcpp.h>
 #include <hx/Debug.h>
@@ -17,17 +19,27 @@
 #define snprintf _snprintf
 #endif
 
-// These should implement a write memory barrier, but since there are no
-// obvious portable implementations, they are currently left unimplemented
-static void write_memory_barrier()
-{
-    // currently unimplemented
-}
-
-static void read_memory_barrier()
-{
-    // currently unimplemented
-}
+// Profiling samples are taken from a SIGPROF handler where there are signals
+#if !defined(HX_WINDOWS) && !defined(EMSCRIPTEN)
+#define HX_PROFILE_SIGNAL
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#if defined(__linux__) && defined(SIGEV_THREAD_ID)
+#define HX_PROFILE_THREAD_TIMER
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+// Keeps the frame chain consistent as seen by the signal handler
+#define HX_PROFILE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define HX_PROFILE_BARRIER()
+#endif
 
 // This marker allows class names to exist within the __hxcpp_all_files
 // array
@@ -50,6 +62,7 @@ extern const char *__hxcpp_all_files[];
 // not cached in a register and thus not properly checked within the function
 // call.
 volatile bool gShouldCallHandleBreakpoints;
+volatile bool gDebuggerStepping;
 
 // This is the event notification handler, as registered by the debugger
 // thread.
@@ -91,12 +104,51 @@ DECLARE_TLS_DATA(CallStack, tlsCallStack);
 // counted and the last thread to reference it deletes it.
 DECLARE_TLS_DATA(Breakpoints, tlsBreakpoints);
 
+// The innermost stack frame of each thread.  Frames link to their callers, so
+// pushing and popping is just an exchange with this slot.
+#if defined(_MSC_VER)
+static __declspec(thread) StackFrame *tlsTopFrame = 0;
+#define HX_TOP_FRAME_SLOT (&hx::tlsTopFrame)
+#elif defined(__GNUC__) && !defined(HXCPP_NO_THREAD_KEYWORD)
+static __thread StackFrame *tlsTopFrame = 0;
+#define HX_TOP_FRAME_SLOT (&hx::tlsTopFrame)
+#else
+DECLARE_TLS_DATA(StackFrame *, tlsTopFrameSlot);
+static StackFrame **GetTopFrameSlot()
+{
+    StackFrame **slot = tlsTopFrameSlot;
+    if (slot == NULL) {
+        slot = (StackFrame **)calloc(1, sizeof(StackFrame *));
+        tlsTopFrameSlot = slot;
+    }
+    return slot;
+}
+#define HX_TOP_FRAME_SLOT hx::GetTopFrameSlot()
+#define HX_TOP_FRAME_SLOT_ALLOCATED
+#endif
+
+
+static bool HasExtension(const char *inFile, const char *inExtension)
+{
+    int len = strlen(inFile);
+    int extLen = strlen(inExtension);
+    return (len > extLen) &&
+           !strcmp(inFile + len - extLen, inExtension);
+}
+
 
-// Profiler functionality separated into this class
+// Profiler functionality separated into this class.
+// Sampling is driven by a timer rather than by the frames being pushed: on posix the
+// profiled thread gets SIGPROF (from a per-thread CPU timer on linux, the process
+// profiling timer elsewhere) and the handler copies the frame names into a ring.
+// Without signals, the clock thread's tick is noticed as frames are pushed instead.
+// The clock thread drains the rings, so all the map work happens off the thread.
 class Profiler
 {
 public:
 
+    enum { RING_SIZE = 256, MAX_FRAMES = 64, SAMPLE_MICROS = 1000 };
+
     // Do not use the Garbage Collector for managing Profiler objects
     void *operator new(size_t size)
     {
@@ -109,14 +161,18 @@ public:
         free(ptr);
     }
 
-    Profiler(const String &inDumpFile)
-        : mT0(0)
+    Profiler(const String &inDumpFile, int inThreadNumber)
+        : mT0(gProfileClock), mThreadNumber(inThreadNumber), mHead(0),
+          mTail(0), mDropped(0), mRegistered(true)
     {
-        mDumpFile = inDumpFile;
+        // Not a String, since nothing marks this object
+        mDumpFile = strdup(inDumpFile.__CStr());
+        mRing = (Sample *)malloc(RING_SIZE * sizeof(Sample));
         
         // When a profiler exists, the profiler thread needs to exist
         gThreadMutex.Lock();
 
+        gProfilers.push_back(this);
         gThreadRefCount += 1;
 
         if (gThreadRefCount == 1) {
@@ -133,27 +189,97 @@ public:
         }
 
         gThreadMutex.Unlock();
+
+        StartTimer();
     }
 
     ~Profiler()
     {
+        Finish();
+        free(mRing);
+        free(mDumpFile);
+    }
+
+    // Stops sampling and collects whatever the clock thread has not
+    void Finish()
+    {
+        StopTimer();
+
         gThreadMutex.Lock();
 
-        gThreadRefCount -= 1;
+        if (mRegistered) {
+            gProfilers.remove(this);
+            gThreadRefCount -= 1;
+            mRegistered = false;
+        }
+        Drain();
 
         gThreadMutex.Unlock();
     }
 
-    void Sample(CallStack *stack);
+    // Records the stack into the ring.  Only ever called on the profiled
+    // thread, possibly from the signal handler, so no locks or allocation.
+    void Capture(CallStack *stack, int weight);
+
+    static bool IsRunning()
+    {
+        return gThreadRefCount > 0;
+    }
+
+#ifndef HX_PROFILE_SIGNAL
+    static void TickCurrentThread();
+
+    void Tick(CallStack *stack)
+    {
+        if (mT0 == gProfileClock) {
+            return;
+        }
+
+        // Latch the profile clock and calculate the time since the last
+        // profile clock tick
+        int clock = gProfileClock;
+        int delta = clock - mT0;
+        if (delta < 0) {
+            delta = 1;
+        }
+        mT0 = clock;
+
+        Capture(stack, delta);
+    }
+#endif
+
+    static void OnSignal(CallStack *stack);
 
     void DumpStats()
+    {
+        DumpStats(mDumpFile);
+    }
+
+    // Writes the samples so far, leaving the profiler running
+    void DumpNow(const String &inDumpFile)
+    {
+        gThreadMutex.Lock();
+        Drain();
+        DumpStats(inDumpFile.__CStr());
+        gThreadMutex.Unlock();
+    }
+
+    // pprof's profile.proto is not written: that needs protobuf and gzip, which the
+    // runtime does not link.  The collapsed stacks convert to it with standard tools.
+    void DumpStats(const char *inDumpFile)
     {
         FILE *out = 0;
-        if (mDumpFile.length > 0) {
-            out = fopen(mDumpFile.c_str(), "wb");
+        if (inDumpFile[0]) {
+            out = fopen(inDumpFile, "wb");
             if (out == NULL) {
                 return;
             }
+            if (HasExtension(inDumpFile, ".folded") ||
+                HasExtension(inDumpFile, ".collapsed")) {
+                DumpCollapsed(out);
+                fclose(out);
+                return;
+            }
         }
 
         std::vector<ResultsEntry> results;
@@ -221,11 +347,32 @@ public:
             }
         }
         
+        if (mDropped) {
+            PROFILE_PRINT("(%d samples dropped)\n", (int)mDropped);
+        }
+
         if (out) {
             fclose(out);
         }
     }
 
+    // One line per distinct stack, "thread-N;outer;...;inner count", as read
+    // by flamegraph.pl, speedscope and similar tools
+    void DumpCollapsed(FILE *out)
+    {
+        std::map<std::vector<const char *>, int>::iterator iter =
+            mStacks.begin();
+        while (iter != mStacks.end()) {
+            fprintf(out, "thread-%d", mThreadNumber);
+            const std::vector<const char *> &frames = iter->first;
+            for (size_t i = 0; i < frames.size(); i++) {
+                fprintf(out, ";%s", frames[i]);
+            }
+            fprintf(out, " %d\n", iter->second);
+            iter++;
+        }
+    }
+
 private:
 
     struct ProfileEntry
@@ -266,9 +413,138 @@ private:
         int childrenPlusSelf;
     };
 
+    struct Sample
+    {
+        int weight;
+        int depth;
+        bool truncated;
+        const char *frames[MAX_FRAMES];
+    };
+
+    // Called with gThreadMutex held
+    void Drain()
+    {
+        int head = mHead;
+        HxMemoryBarrier();
+        while (mTail != head) {
+            Record(mRing[mTail & (RING_SIZE - 1)]);
+            HxMemoryBarrier();
+            mTail = mTail + 1;
+        }
+    }
+
+    void Record(const Sample &sample)
+    {
+        std::vector<const char *> frames(sample.frames,
+                                         sample.frames + sample.depth);
+        if (sample.truncated) {
+            frames.insert(frames.begin(), "...");
+        }
+        int weight = sample.weight;
+        mStacks[frames] += weight;
+
+        int depth = frames.size();
+        std::map<const char *, bool> alreadySeen;
+
+        // Add children time in to each stack element
+        for (int i = 0; i < depth; i++) {
+            const char *fullName = frames[i];
+            ProfileEntry &pe = mProfileStats[fullName];
+            if (!alreadySeen.count(fullName)) {
+                pe.total += weight;
+                alreadySeen[fullName] = true;
+            }
+            // For everything except the very top of the stack, add the time
+            // to that child's total with this entry
+            if (i < depth - 1) {
+                pe.children[frames[i + 1]] += weight;
+            }
+            else {
+                pe.self += weight;
+            }
+        }
+    }
+
+    void StartTimer()
+    {
+#ifdef HX_PROFILE_SIGNAL
+        gThreadMutex.Lock();
+        if (!gHandlerInstalled) {
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = SignalHandler;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGPROF, &action, 0);
+            gHandlerInstalled = true;
+        }
+#ifdef HX_PROFILE_THREAD_TIMER
+        gThreadMutex.Unlock();
+
+        struct sigevent event;
+        memset(&event, 0, sizeof(event));
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = syscall(SYS_gettid);
+        mTimerValid = timer_create(CLOCK_THREAD_CPUTIME_ID, &event,
+                                   &mTimer) == 0;
+        if (mTimerValid) {
+            struct itimerspec spec;
+            spec.it_interval.tv_sec = 0;
+            spec.it_interval.tv_nsec = SAMPLE_MICROS * 1000;
+            spec.it_value = spec.it_interval;
+            timer_settime(mTimer, 0, &spec, 0);
+        }
+#else
+        // One timer for the process, whichever thread it lands on
+        if (gTimerUsers++ == 0) {
+            struct itimerval value;
+            value.it_interval.tv_sec = 0;
+            value.it_interval.tv_usec = SAMPLE_MICROS;
+            value.it_value = value.it_interval;
+            setitimer(ITIMER_PROF, &value, 0);
+        }
+        gThreadMutex.Unlock();
+#endif
+#endif
+    }
+
+    void StopTimer()
+    {
+#ifdef HX_PROFILE_SIGNAL
+#ifdef HX_PROFILE_THREAD_TIMER
+        if (mTimerValid) {
+            timer_delete(mTimer);
+            mTimerValid = false;
+        }
+#else
+        gThreadMutex.Lock();
+        if (mRegistered && --gTimerUsers == 0) {
+            struct itimerval value;
+            memset(&value, 0, sizeof(value));
+            setitimer(ITIMER_PROF, &value, 0);
+        }
+        gThreadMutex.Unlock();
+#endif
+#endif
+    }
+
+#ifdef HX_PROFILE_SIGNAL
+    static void SignalHandler(int)
+    {
+        int savedErrno = errno;
+        CallStack *stack = tlsCallStack;
+        if (stack != NULL) {
+            OnSignal(stack);
+        }
+        errno = savedErrno;
+    }
+#endif
+
     static THREAD_FUNC_TYPE ProfileMainLoop(void *)
     {
         int millis = 1;
+        int ticks = 0;
 
         while (gThreadRefCount > 0) { 
 #ifdef HX_WINDOWS
@@ -287,22 +563,678 @@ private:
 
             int count = gProfileClock + 1;
             gProfileClock = (count < 0) ? 0 : count;
+
+            // Often enough that the rings do not fill
+            if (++ticks % 10 == 0) {
+                gThreadMutex.Lock();
+                std::list<Profiler *>::iterator iter = gProfilers.begin();
+                while (iter != gProfilers.end()) {
+                    (*iter++)->Drain();
+                }
+                gThreadMutex.Unlock();
+            }
         }
 
         THREAD_FUNC_RET
     }
 
-    String mDumpFile;
+    char *mDumpFile;
     int mT0;
+    int mThreadNumber;
+    Sample *mRing;
+    volatile int mHead;
+    volatile int mTail;
+    volatile int mDropped;
+    bool mRegistered;
+#ifdef HX_PROFILE_THREAD_TIMER
+    timer_t mTimer;
+    bool mTimerValid;
+#endif
+    // Owned by the clock thread while registered
     std::map<const char *, ProfileEntry> mProfileStats;
+    std::map<std::vector<const char *>, int> mStacks;
 
     static MyMutex gThreadMutex;
     static int gThreadRefCount;
     static int gProfileClock;
+    static std::list<Profiler *> gProfilers;
+#ifdef HX_PROFILE_SIGNAL
+    static bool gHandlerInstalled;
+    static int gTimerUsers;
+#endif
 };
 /* static */ MyMutex Profiler::gThreadMutex;
 /* static */ int Profiler::gThreadRefCount;
 /* static */ int Profiler::gProfileClock;
+/* static */ std::list<Profiler *> Profiler::gProfilers;
+#ifdef HX_PROFILE_SIGNAL
+/* static */ bool Profiler::gHandlerInstalled;
+/* static */ int Profiler::gTimerUsers;
+#endif
+
+
+static unsigned long long MonotonicNanos()
+{
+#ifdef HX_WINDOWS
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (unsigned long long)(count.QuadPart * (1e9 / freq.QuadPart));
+#elif defined(CLOCK_MONOTONIC_RAW)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#else
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec * 1000000000ULL + t.tv_usec * 1000ULL;
+#endif
+}
+
+
+#ifdef HXCPP_PROFILE_INSTRUMENT
+
+// Per-function timing for HXCPP_PROFILE_INSTRUMENT, used in place of the
+// sampling profiler.  Every call is timed on entry and exit, with the cycle
+// counter where there is one.  Each thread counts into its own open-addressed
+// table keyed by the fullName pointer, so frames never lock.  A new run bumps
+// the generation, and each thread clears its own table when it notices.
+// Other threads' tables are only read when merging, so figures taken while
+// they run are approximate.
+struct InstrumentEntry
+{
+    const char *fullName;
+    unsigned int calls;
+    // Recursion depth, so that inclusive time is only counted once
+    int active;
+    unsigned long long inclusive;
+    unsigned long long exclusive;
+    unsigned long long max;
+};
+
+enum { INSTRUMENT_TABLE_SIZE = 4096 };
+
+struct InstrumentTable
+{
+    int generation;
+    int used;
+    InstrumentEntry entries[INSTRUMENT_TABLE_SIZE];
+    // Takes everything once the table is three quarters full
+    InstrumentEntry overflow;
+};
+
+DECLARE_TLS_DATA(InstrumentTable, tlsInstrumentTable);
+
+class Instrument
+{
+public:
+
+    enum { TABLE_SIZE = INSTRUMENT_TABLE_SIZE,
+           TABLE_LIMIT = TABLE_SIZE * 3 / 4 };
+    typedef InstrumentTable Table;
+
+    static inline unsigned long long Now()
+    {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+        unsigned int lo, hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return ((unsigned long long)hi << 32) | lo;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        return __rdtsc();
+#else
+        return Nanos();
+#endif
+    }
+
+    // Wall clock, to convert Now() to time
+    static unsigned long long Nanos()
+    {
+        return MonotonicNanos();
+    }
+
+    static void Enter(StackFrame *frame)
+    {
+        Table *table = tlsInstrumentTable;
+        if ((table == NULL) || (table->generation != gGeneration)) {
+            table = GetTable();
+        }
+
+        InstrumentEntry *entry = Find(table, frame->fullName);
+        entry->active++;
+        frame->instrumentEntry = entry;
+        frame->instrumentGeneration = table->generation;
+        frame->instrumentChildren = 0;
+        frame->instrumentStart = Now();
+    }
+
+    static void Leave(StackFrame *frame)
+    {
+        unsigned long long elapsed = Now() - frame->instrumentStart;
+        if (frame->parent != NULL) {
+            frame->parent->instrumentChildren += elapsed;
+        }
+        // Entries from before a restart may have been reused
+        if (frame->instrumentGeneration != gGeneration) {
+            return;
+        }
+
+        InstrumentEntry *entry = frame->instrumentEntry;
+        entry->calls++;
+        entry->exclusive += elapsed - frame->instrumentChildren;
+        if (--entry->active == 0) {
+            entry->inclusive += elapsed;
+        }
+        if (elapsed > entry->max) {
+            entry->max = elapsed;
+        }
+    }
+
+    static void Start(const String &inDumpFile)
+    {
+        gMutex.Lock();
+        // Not a String, since nothing marks this
+        free(gDumpFile);
+        gDumpFile = strdup(inDumpFile.__CStr());
+        gGeneration++;
+        gStartTicks = Now();
+        gStartNanos = Nanos();
+        gActive = true;
+        gMutex.Unlock();
+    }
+
+    static void Stop()
+    {
+        gActive = false;
+        gMutex.Lock();
+        std::string dumpFile = gDumpFile ? gDumpFile : "";
+        gMutex.Unlock();
+        Dump(dumpFile.c_str());
+    }
+
+    // Merges every thread's table, and writes JSON if the file name ends in
+    // .json, otherwise CSV.  No file name prints the CSV.
+    // The tables are read without stopping their threads, so the figures
+    // are only exact for threads that have finished their instrumented
+    // calls.  A thread still running may be a call or so behind, and on
+    // 32-bit systems one of its 64-bit counters may be read mid-update.
+    // Call this once the threads of interest have stopped.
+    static void Dump(const char *inDumpFile)
+    {
+        gMutex.Lock();
+
+        std::map<const char *, InstrumentEntry> merged;
+        std::list<Table *>::iterator iter = gTables.begin();
+        while (iter != gTables.end()) {
+            Table *table = *iter++;
+            if (table->generation != gGeneration) {
+                continue;
+            }
+            for (int i = 0; i <= TABLE_SIZE; i++) {
+                InstrumentEntry &entry = (i < TABLE_SIZE) ?
+                    table->entries[i] : table->overflow;
+                if (entry.fullName == NULL) {
+                    continue;
+                }
+                InstrumentEntry &total = merged[entry.fullName];
+                total.calls += entry.calls;
+                total.inclusive += entry.inclusive;
+                total.exclusive += entry.exclusive;
+                if (entry.max > total.max) {
+                    total.max = entry.max;
+                }
+            }
+        }
+
+        double nanosPerTick = 1.0;
+        unsigned long long ticks = Now() - gStartTicks;
+        if (ticks > 0) {
+            nanosPerTick = (double)(Nanos() - gStartNanos) / ticks;
+        }
+
+        gMutex.Unlock();
+
+        std::vector<ResultsEntry> results;
+        std::map<const char *, InstrumentEntry>::iterator m = merged.begin();
+        while (m != merged.end()) {
+            ResultsEntry re;
+            re.fullName = m->first;
+            re.calls = m->second.calls;
+            re.inclusive = m->second.inclusive * nanosPerTick;
+            re.exclusive = m->second.exclusive * nanosPerTick;
+            re.max = m->second.max * nanosPerTick;
+            results.push_back(re);
+            m++;
+        }
+        std::sort(results.begin(), results.end());
+
+        FILE *out = stdout;
+        if (inDumpFile[0]) {
+            out = fopen(inDumpFile, "wb");
+            if (out == NULL) {
+                return;
+            }
+        }
+
+        bool json = HasExtension(inDumpFile, ".json");
+        fprintf(out, json ? "[\n" :
+                "function,calls,inclusive_ns,exclusive_ns,max_ns\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            ResultsEntry &re = results[i];
+            if (json) {
+                fprintf(out, "  {\"function\":\"%s\",\"calls\":%u,"
+                        "\"inclusive_ns\":%.0f,\"exclusive_ns\":%.0f,"
+                        "\"max_ns\":%.0f}%s\n", re.fullName, re.calls,
+                        re.inclusive, re.exclusive, re.max,
+                        (i + 1 < results.size()) ? "," : "");
+            }
+            else {
+                fprintf(out, "%s,%u,%.0f,%.0f,%.0f\n", re.fullName, re.calls,
+                        re.inclusive, re.exclusive, re.max);
+            }
+        }
+        if (json) {
+            fprintf(out, "]\n");
+        }
+
+        if (out != stdout) {
+            fclose(out);
+        }
+    }
+
+    static volatile bool gActive;
+
+private:
+
+    struct ResultsEntry
+    {
+        bool operator <(const ResultsEntry &inRHS) const
+        {
+            return exclusive > inRHS.exclusive;
+        }
+
+        const char *fullName;
+        unsigned int calls;
+        double inclusive;
+        double exclusive;
+        double max;
+    };
+
+    static InstrumentEntry *Find(Table *table, const char *fullName)
+    {
+        unsigned int slot = (unsigned int)(((size_t)fullName >> 3) *
+                                           2654435761u) & (TABLE_SIZE - 1);
+        while (true) {
+            InstrumentEntry &entry = table->entries[slot];
+            if (entry.fullName == fullName) {
+                return &entry;
+            }
+            if (entry.fullName == NULL) {
+                if (table->used >= TABLE_LIMIT) {
+                    table->overflow.fullName = "(other)";
+                    return &table->overflow;
+                }
+                table->used++;
+                entry.fullName = fullName;
+                return &entry;
+            }
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+    }
+
+    // First use on this thread, or the first since a restart
+    static Table *GetTable()
+    {
+        Table *table = tlsInstrumentTable;
+        if (table == NULL) {
+            table = (Table *)calloc(1, sizeof(Table));
+            gMutex.Lock();
+            gTables.push_back(table);
+            gMutex.Unlock();
+            tlsInstrumentTable = table;
+        }
+        else {
+            // Hidden from merging until cleared
+            table->generation = 0;
+            HxMemoryBarrier();
+            memset(table->entries, 0, sizeof(table->entries));
+            memset(&table->overflow, 0, sizeof(table->overflow));
+            table->used = 0;
+        }
+        HxMemoryBarrier();
+        table->generation = gGeneration;
+        return table;
+    }
+
+    static MyMutex gMutex;
+    static std::list<Table *> gTables;
+    static volatile int gGeneration;
+    static char *gDumpFile;
+    static unsigned long long gStartTicks;
+    static unsigned long long gStartNanos;
+};
+/* static */ volatile bool Instrument::gActive;
+/* static */ MyMutex Instrument::gMutex;
+/* static */ std::list<Instrument::Table *> Instrument::gTables;
+/* static */ volatile int Instrument::gGeneration;
+/* static */ char *Instrument::gDumpFile;
+/* static */ unsigned long long Instrument::gStartTicks;
+/* static */ unsigned long long Instrument::gStartNanos;
+
+#endif // HXCPP_PROFILE_INSTRUMENT
+
+
+// Timeline tracing.  Each thread writes fixed-size records into its own ring,
+// overwriting the oldest when it is full, and a flush turns everything since the
+// last flush into Chrome/Perfetto trace-event JSON.  Names are static strings;
+// haxe strings are interned so they outlive the string object.
+// Rings start small and double while unflushed records fill them, up to
+// HXCPP_TRACE_RING_SIZE records (a power of two), so threads that only pass the
+// odd GC wait stay cheap.
+volatile bool gTraceEnabled = false;
+
+#ifndef HXCPP_TRACE_RING_SIZE
+#define HXCPP_TRACE_RING_SIZE (1 << 15)
+#endif
+
+enum { TRACE_RING_START = 256, TRACE_NAME_CACHE = 64 };
+
+struct TraceRecord
+{
+    unsigned long long time;
+    const char *name;
+    double value;
+    int type;
+};
+
+struct TraceBuffer
+{
+    int threadNumber;
+    volatile unsigned int head;
+    // Owned by the flush
+    unsigned int tail;
+    bool exited;
+    struct
+    {
+        const char *source;
+        const char *name;
+    } names[TRACE_NAME_CACHE];
+    // Only replaced by the owning thread, with gTraceMutex held
+    unsigned int size;
+    TraceRecord *records;
+};
+
+DECLARE_TLS_DATA(TraceBuffer, tlsTraceBuffer);
+
+// gTraceMutex protects gTraceBuffers
+static MyMutex gTraceMutex;
+static std::list<TraceBuffer *> gTraceBuffers;
+static unsigned long long gTraceStart;
+static MyMutex gTraceNameMutex;
+static std::set<std::string> gTraceNames;
+
+static TraceBuffer *GetTraceBuffer()
+{
+    TraceBuffer *buffer = tlsTraceBuffer;
+    if (buffer == NULL) {
+        buffer = (TraceBuffer *)calloc(1, sizeof(TraceBuffer));
+        buffer->threadNumber = __hxcpp_GetCurrentThreadNumber();
+        buffer->size = (TRACE_RING_START < HXCPP_TRACE_RING_SIZE) ?
+            TRACE_RING_START : HXCPP_TRACE_RING_SIZE;
+        buffer->records = (TraceRecord *)malloc(buffer->size * sizeof(TraceRecord));
+        gTraceMutex.Lock();
+        gTraceBuffers.push_back(buffer);
+        gTraceMutex.Unlock();
+        tlsTraceBuffer = buffer;
+    }
+    return buffer;
+}
+
+static void FreeTraceBuffer(TraceBuffer *inBuffer)
+{
+    free(inBuffer->records);
+    free(inBuffer);
+}
+
+// Called with gTraceMutex held, so no flush is copying the old ring
+static void GrowTraceRing(TraceBuffer *inBuffer)
+{
+    unsigned int size = inBuffer->size * 2;
+    TraceRecord *records = (TraceRecord *)malloc(size * sizeof(TraceRecord));
+    for (unsigned int i = inBuffer->tail; i != inBuffer->head; i++) {
+        records[i & (size - 1)] = inBuffer->records[i & (inBuffer->size - 1)];
+    }
+    free(inBuffer->records);
+    inBuffer->records = records;
+    inBuffer->size = size;
+}
+
+void TraceEvent(int inType, const char *inName, double inValue)
+{
+    TraceBuffer *buffer = GetTraceBuffer();
+    unsigned int head = buffer->head;
+    if (((head - buffer->tail) >= buffer->size) &&
+        (buffer->size < HXCPP_TRACE_RING_SIZE)) {
+        gTraceMutex.Lock();
+        if ((head - buffer->tail) >= buffer->size) {
+            GrowTraceRing(buffer);
+        }
+        gTraceMutex.Unlock();
+    }
+    TraceRecord &record = buffer->records[head & (buffer->size - 1)];
+    record.time = MonotonicNanos();
+    record.name = inName;
+    record.value = inValue;
+    record.type = inType;
+    // Publish the record after its contents
+    HxMemoryBarrier();
+    buffer->head = head + 1;
+}
+
+static const char *InternTraceName(const String &inName)
+{
+    const char *source = inName.c_str();
+    if (source == NULL) {
+        return "null";
+    }
+
+    // Cached by address, and checked in case the string has been collected
+    TraceBuffer *buffer = GetTraceBuffer();
+    int slot = (int)(((size_t)source >> 3) & (TRACE_NAME_CACHE - 1));
+    if ((buffer->names[slot].source == source) &&
+        !strcmp(buffer->names[slot].name, source)) {
+        return buffer->names[slot].name;
+    }
+
+    gTraceNameMutex.Lock();
+    const char *name = gTraceNames.insert(std::string(source)).first->c_str();
+    gTraceNameMutex.Unlock();
+
+    buffer->names[slot].source = source;
+    buffer->names[slot].name = name;
+    return name;
+}
+
+void TraceThreadExit()
+{
+    TraceBuffer *buffer = tlsTraceBuffer;
+    if (buffer == NULL) {
+        return;
+    }
+    tlsTraceBuffer = NULL;
+
+    gTraceMutex.Lock();
+    if (buffer->head == buffer->tail) {
+        gTraceBuffers.remove(buffer);
+        FreeTraceBuffer(buffer);
+    }
+    else {
+        // Freed once flushed
+        buffer->exited = true;
+    }
+    gTraceMutex.Unlock();
+}
+
+static void WriteTraceString(FILE *out, const char *inString)
+{
+    fputc('"', out);
+    for (const char *c = inString; *c; c++) {
+        if ((*c == '"') || (*c == '\\')) {
+            fputc('\\', out);
+            fputc(*c, out);
+        }
+        else if ((unsigned char)*c < ' ') {
+            fprintf(out, "\\u%04x", *c);
+        }
+        else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void FlushTrace(const char *inFile)
+{
+    FILE *out = stdout;
+    if (inFile && inFile[0]) {
+        out = fopen(inFile, "wb");
+        if (out == NULL) {
+            return;
+        }
+    }
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    bool first = true;
+
+    gTraceMutex.Lock();
+
+    std::vector<TraceRecord> records;
+    std::list<TraceBuffer *>::iterator iter = gTraceBuffers.begin();
+    while (iter != gTraceBuffers.end()) {
+        TraceBuffer *buffer = *iter;
+
+        unsigned int head = buffer->head;
+        HxMemoryBarrier();
+        unsigned int size = buffer->size;
+        unsigned int start = buffer->tail;
+        if ((head - start) > size) {
+            start = head - size;
+        }
+        records.clear();
+        for (unsigned int i = start; i != head; i++) {
+            records.push_back(buffer->records[i & (size - 1)]);
+        }
+        // Drop anything the thread wrote over while it was being copied
+        HxMemoryBarrier();
+        unsigned int now = buffer->head;
+        unsigned int skip = 0;
+        if ((now - start) > size) {
+            skip = now - start - size;
+        }
+        buffer->tail = head;
+
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}",
+                first ? "" : ",\n", buffer->threadNumber,
+                buffer->threadNumber);
+        first = false;
+
+        for (size_t i = skip; i < records.size(); i++) {
+            TraceRecord &record = records[i];
+            double ts = (record.time >= gTraceStart) ?
+                (record.time - gTraceStart) / 1000.0 : 0.0;
+            static const char *phases[] = { "B", "E", "i", "C" };
+            fprintf(out, ",\n{\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                    phases[record.type], ts, buffer->threadNumber);
+            if (record.name != NULL) {
+                fprintf(out, ",\"name\":");
+                WriteTraceString(out, record.name);
+            }
+            if (record.type == traceInstant) {
+                fprintf(out, ",\"s\":\"t\"");
+            }
+            else if (record.type == traceCounter) {
+                fprintf(out, ",\"args\":{\"value\":%.17g}", record.value);
+            }
+            fputc('}', out);
+        }
+
+        if (buffer->exited) {
+            iter = gTraceBuffers.erase(iter);
+            FreeTraceBuffer(buffer);
+        }
+        else {
+            iter++;
+        }
+    }
+
+    gTraceMutex.Unlock();
+
+    fprintf(out, "\n]}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+
+// A frame of an exception stack.  The names are the frame's constants, so
+// they outlive it; the frame pointer is only used to find the catching frame.
+struct ExceptionFrame
+{
+    ExceptionFrame()
+        : frame(NULL), className(NULL), functionName(NULL), fileName(NULL),
+          lineNumber(0)
+    {
+    }
+
+    ExceptionFrame(StackFrame *inFrame)
+        : frame(inFrame)
+    {
+        if (inFrame != NULL) {
+            className = inFrame->className;
+            functionName = inFrame->functionName;
+            fileName = inFrame->fileName;
+            lineNumber = inFrame->lineNumber;
+        }
+    }
+
+    bool IsFrame(const ExceptionFrame &inOther) const
+    {
+        return (frame == inOther.frame) &&
+            (functionName == inOther.functionName);
+    }
+
+    StackFrame *frame;
+    const char *className;
+    const char *functionName;
+    const char *fileName;
+    int lineNumber;
+};
+
+
+// Exceptions of these classes, and their subclasses, are used for control flow
+// and are thrown without capturing the exception stack
+#ifdef HXCPP_STACK_TRACE
+enum { MAX_CONTROL_FLOW_CLASSES = 16 };
+
+static hx::Object *gControlFlowClasses[MAX_CONTROL_FLOW_CLASSES];
+static volatile int gControlFlowClassCount;
+static MyMutex gControlFlowMutex;
+
+static bool IsControlFlowException(hx::Object *inException)
+{
+    if (inException == NULL) {
+        return false;
+    }
+    for (Class cls = inException->__GetClass(); cls.mPtr; cls = cls->GetSuper()) {
+        for (int i = 0; i < gControlFlowClassCount; i++) {
+            if (gControlFlowClasses[i] == cls.mPtr) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+#endif
 
 
 class CallStack
@@ -342,17 +1274,34 @@ public:
         return stack;
     }
     
-    static void RemoveCallStack(int threadNumber)
+    // Called as the calling thread exits.  The call stack points into the
+    // thread's own storage, so it must be gone before that is, whether or
+    // not a debugger is attached.  Readers on other threads hold gMutex.
+    static void RemoveCallerCallStack()
     {
+        CallStack *stack = tlsCallStack;
+        if (stack == NULL) {
+            return;
+        }
+        tlsCallStack = NULL;
+
+        if (stack->mProfiler != NULL) {
+            Profiler *profiler = stack->mProfiler;
+            stack->mProfiler = NULL;
+            profiler->Finish();
+            profiler->DumpStats();
+            delete profiler;
+        }
+
         gMutex.Lock();
 
-        CallStack *stack = gMap[threadNumber];
-        if (stack != NULL) {
-            gMap.erase(threadNumber);
-            gList.remove(stack);
-            delete stack;
-            tlsCallStack = NULL;
+        if (gMap.count(stack->mThreadNumber) &&
+            (gMap[stack->mThreadNumber] == stack)) {
+            gMap.erase(stack->mThreadNumber);
         }
+        gList.remove(stack);
+        stack->mTopFrame = NULL;
+        delete stack;
 
         gMutex.Unlock();
     }
@@ -362,30 +1311,24 @@ public:
         GetCallerCallStack()->mCanStop = enable;
     }
 
-    // Note that the stack frames are manipulated without holding any locks.
-    // This is because the manipulation of stack frames can only be done by
-    // the thread that "owns" that stack frame.  The only other contention on
-    // the call stack is from calls to GetThreadInfo() and GetThreadInfos(),
-    // and these should only be called when the thread for which the call
-    // stack is being acquired is stopped in a breakpoint anyway, thus there
-    // can be no contention on the contents of the CallStack in that case
-    // either.
-    static void PushStackFrame(StackFrame *frame)
-    {
-        CallStack *stack = GetCallerCallStack();
-        if (stack->mProfiler != NULL) {
-            stack->mProfiler->Sample(stack);
-        }
-        stack->mStackFrames.push_back(frame);
-    }
+    // Note that the stack frames are manipulated without holding any locks,
+    // by the thread that "owns" them, in the StackFrame constructor and
+    // destructor.  The only other readers are GetThreadInfo() and
+    // GetThreadInfos(), and these should only be called when the thread for
+    // which the call stack is being acquired is stopped in a breakpoint, and
+    // the profiler's signal handler, which runs on the owning thread.
 
-    static void PopStackFrame()
+    // Frames from the outermost in, as the debugger numbers them
+    void GetFrames(std::vector<StackFrame *> &outFrames) const
     {
-        CallStack *stack = GetCallerCallStack();
-        if (stack->mProfiler != NULL) {
-            stack->mProfiler->Sample(stack);
+        int count = 0;
+        for (StackFrame *frame = *mTopFrame; frame; frame = frame->parent) {
+            count++;
+        }
+        outFrames.resize(count);
+        for (StackFrame *frame = *mTopFrame; frame; frame = frame->parent) {
+            outFrames[--count] = frame;
         }
-        stack->mStackFrames.pop_back();
     }
 
     static void ContinueThreads(int specialThreadNumber, int count)
@@ -415,7 +1358,7 @@ public:
         while (iter != gList.end()) {
             CallStack *stack = *iter++;
             if (stack->mThreadNumber == threadNumber) {
-                stackLevel = stack->mStackFrames.size() - 1;
+                stackLevel = stack->GetDepth();
                 stack->Continue(1);
                 break;
             }
@@ -424,34 +1367,42 @@ public:
         gMutex.Unlock();
     }
 
+    static ::String FormatFrame(const char *className,
+                                const char *functionName,
+                                const char *fileName, int lineNumber)
+    {
+        // Not sure if the following is even possible but the old debugger
+        // did it so ...
+        char buf[1024];
+        if ((fileName == NULL) || (fileName[0] == '?')) {
+            snprintf(buf, sizeof(buf), "%s::%s", className, functionName);
+        }
+        else {
+#ifdef HXCPP_STACK_LINE
+            snprintf(buf, sizeof(buf), "%s::%s::%s::%d",
+                     className, functionName, fileName, lineNumber);
+#else
+            snprintf(buf, sizeof(buf), "%s::%s::%s::0",
+                     className, functionName, fileName);
+#endif
+        }
+        return ::String(buf);
+    }
+
     static void GetCurrentCallStackAsStrings(Array<String> &result,
                                              bool skipLast)
     {
         CallStack *stack = CallStack::GetCallerCallStack();
 
-        int n = stack->mStackFrames.size() - (skipLast ? 1 : 0);
+        std::vector<StackFrame *> frames;
+        stack->GetFrames(frames);
+
+        int n = frames.size() - (skipLast ? 1 : 0);
         
         for (int i = 0; i < n; i++) {
-            StackFrame *frame = stack->mStackFrames[i];
-            // Not sure if the following is even possible but the old debugger
-            // did it so ...
-            char buf[1024];
-            if ((frame->fileName == NULL) || (frame->fileName[0] == '?')) {
-                snprintf(buf, sizeof(buf), "%s::%s",
-                         frame->className, frame->functionName);
-            }
-            else {
-#ifdef HXCPP_STACK_LINE
-                snprintf(buf, sizeof(buf), "%s::%s::%s::%d",
-                         frame->className, frame->functionName,
-                         frame->fileName, frame->lineNumber);
-#else
-                snprintf(buf, sizeof(buf), "%s::%s::%s::0",
-                         frame->className, frame->functionName,
-                         frame->fileName);
-#endif
-            }
-            result->push(String(buf));
+            StackFrame *frame = frames[i];
+            result->push(FormatFrame(frame->className, frame->functionName,
+                                     frame->fileName, frame->lineNumber));
         }
     }
 
@@ -468,7 +1419,7 @@ public:
 
         if (gMap.count(threadNumber) == 0) {
             gMutex.Unlock();
-            return NULL;
+            return null();
         }
         else {
             stack = gMap[threadNumber];
@@ -531,11 +1482,12 @@ public:
                     return ret;
                 }
                 // Some kind of error signalling here would be nice I guess
-                if (stack->mStackFrames.size() <= stackFrameNumber) {
+                std::vector<StackFrame *> frames;
+                stack->GetFrames(frames);
+                if (frames.size() <= stackFrameNumber) {
                     break;
                 }
-                StackVariable *variable = 
-                    stack->mStackFrames[stackFrameNumber]->variables;
+                StackVariable *variable = frames[stackFrameNumber]->variables;
                 while (variable != NULL) {
                     ret->push(::String(variable->mHaxeName));
                     variable = variable->mNext;
@@ -579,7 +1531,9 @@ public:
         gMutex.Unlock();
 
         // Check to ensure that the stack frame is valid
-        int size = stack->mStackFrames.size();
+        std::vector<StackFrame *> frames;
+        stack->GetFrames(frames);
+        int size = frames.size();
 
         if ((stackFrameNumber < 0) || (stackFrameNumber >= size)) {
             return markNonexistent;
@@ -587,7 +1541,7 @@ public:
         
         const char *nameToFind = name.c_str();
 
-        StackVariable *sv = stack->mStackFrames[stackFrameNumber]->variables;
+        StackVariable *sv = frames[stackFrameNumber]->variables;
 
         while (sv != NULL) {
             if (!strcmp(sv->mHaxeName, nameToFind)) {
@@ -614,7 +1568,7 @@ public:
 
         if (gMap.count(threadNumber) == 0) {
             gMutex.Unlock();
-            return NULL;
+            return null();
         }
         else {
             stack = gMap[threadNumber];
@@ -629,7 +1583,9 @@ public:
         gMutex.Unlock();
 
         // Check to ensure that the stack frame is valid
-        int size = stack->mStackFrames.size();
+        std::vector<StackFrame *> frames;
+        stack->GetFrames(frames);
+        int size = frames.size();
 
         if ((stackFrameNumber < 0) || (stackFrameNumber >= size)) {
             return null();
@@ -641,7 +1597,7 @@ public:
             return markNonexistent;
         }
 
-        StackVariable *sv = stack->mStackFrames[stackFrameNumber]->variables;
+        StackVariable *sv = frames[stackFrameNumber]->variables;
 
         while (sv != NULL) {
             if (!strcmp(sv->mHaxeName, nameToFind)) {
@@ -731,10 +1687,8 @@ public:
     {
         CallStack *stack = GetCallerCallStack();
 
-        std::vector<StackFrame *>::reverse_iterator iter = 
-            stack->mStackFrames.rbegin();
-        while (iter != stack->mStackFrames.rend()) {
-            StackFrame *frame = *iter++;
+        StackFrame *frame = *stack->mTopFrame;
+        for (; frame != NULL; frame = frame->parent) {
             StackCatchable *catchable = frame->catchables;
             while (catchable != NULL) {
                 if (catchable->Catches(e)) {
@@ -752,38 +1706,65 @@ public:
         CallStack *stack = GetCallerCallStack();
 
         if (stack->mProfiler != NULL) {
-            delete stack->mProfiler;
+            Profiler *old = stack->mProfiler;
+            stack->mProfiler = NULL;
+            delete old;
+        }
+
+        stack->mProfiler = new Profiler(inDumpFile, stack->mThreadNumber);
+    }
+
+    static void StopCurrentThreadProfiler()
+    {
+        CallStack *stack = GetCallerCallStack();
+
+        if (stack->mProfiler != NULL) {
+            // Detach first so that a late signal finds nothing to sample
+            Profiler *profiler = stack->mProfiler;
+            stack->mProfiler = NULL;
+            profiler->Finish();
+            profiler->DumpStats();
+            delete profiler;
         }
-
-        stack->mProfiler = new Profiler(inDumpFile);
     }
 
-    static void StopCurrentThreadProfiler()
+    static void DumpCurrentThreadProfiler(String inDumpFile)
     {
         CallStack *stack = GetCallerCallStack();
 
         if (stack->mProfiler != NULL) {
-            stack->mProfiler->DumpStats();
-            delete stack->mProfiler;
-            stack->mProfiler = NULL;
+            stack->mProfiler->DumpNow(inDumpFile);
         }
     }
 
+    Profiler *GetProfiler() const
+    {
+        return mProfiler;
+    }
+
     static void GetCurrentExceptionStackAsStrings(Array<String> &result)
     {
         CallStack *stack = CallStack::GetCallerCallStack();
 
-        int size = stack->mExceptionStack.size();
+        ExceptionFrame *frames;
+        int size = stack->GetExceptionFrames(frames);
 
         for (int i = 0; i < size; i++) {
-            result->push(stack->mExceptionStack[i]);
+            ExceptionFrame &frame = frames[i];
+            result->push(FormatFrame(frame.className, frame.functionName,
+                                     frame.fileName, frame.lineNumber));
         }
     }
 
     // Gets the current stack frame of the calling thread
     StackFrame *GetCurrentStackFrame()
     {
-        return mStackFrames.back();
+        return *mTopFrame;
+    }
+
+    StackFrame *GetTopFrame() const
+    {
+        return *mTopFrame;
     }
 
     int GetThreadNumber()
@@ -798,12 +1779,11 @@ public:
 
     int GetDepth() const
     {
-        return mStackFrames.size() - 1;
-    }
-
-    const char *GetFullNameAtDepth(int depth) const
-    {
-        return mStackFrames[depth]->fullName;
+        int depth = -1;
+        for (StackFrame *frame = *mTopFrame; frame; frame = frame->parent) {
+            depth++;
+        }
+        return depth;
     }
         
 
@@ -847,47 +1827,63 @@ public:
         mWaitMutex.Unlock();
     }
 
-    // Called when a throw occurs
-    void SetLastException()
+    // Called when a throw occurs.  Only the frames' name pointers and lines
+    // are kept, innermost first, and are made into strings if the exception
+    // stack is asked for.  Rethrowing the caught object from its catch keeps
+    // the stack of the original throw.
+    void SetLastException(hx::Object *inException, bool inCapture)
     {
+        StackFrame *top = *mTopFrame;
+        if (mCaught && (inException != NULL) &&
+            (inException == mExceptionObject) && (top == mCatchFrame.frame)) {
+            mCaught = false;
+            return;
+        }
+
+        mExceptionObject = inException;
+        mCaught = false;
+        mExceptionFrames.clear();
+        if (inCapture) {
+            for (StackFrame *frame = top; frame; frame = frame->parent) {
+                mExceptionFrames.push_back(ExceptionFrame(frame));
+            }
+        }
     }
 
-    // Called when a catch block begins to be executed.  hxcpp wants to track
-    // the stack back through the catches so that it can be dumped if
-    // uncaught.  If inAll is true, the entire stack is captured immediately.
-    // If inAll is false, only the last stack frame is captured.
+    // Called when a catch block begins to be executed.  The exception stack
+    // runs from the throw to the catching frame.  If inAll is true, the
+    // entire current stack is taken as the exception stack instead.
     void BeginCatch(bool inAll)
     {
-        int depth = mStackFrames.size();
-
-        if (depth == 0) {
+        if (inAll) {
+            SetLastException(NULL, true);
             return;
         }
+        // A second catch with no capture since was thrown natively
+        if (mCaught) {
+            mExceptionObject = NULL;
+            mExceptionFrames.clear();
+        }
+        mCatchFrame = ExceptionFrame(*mTopFrame);
+        mCaught = true;
+    }
 
-        int start = inAll ? 0 : (depth - 1);
-
-        for (int i = start; i < depth; i++) {
-            StackFrame *frame = mStackFrames[i];
-            // Not sure if the following is even possible but the old debugger
-            // did it so ...
-            char buf[1024];
-            if ((frame->fileName == NULL) || (frame->fileName[0] == '?')) {
-                snprintf(buf, sizeof(buf), "%s::%s",
-                         frame->className, frame->functionName);
-            }
-            else {
-#ifdef HXCPP_STACK_LINE
-                snprintf(buf, sizeof(buf), "%s::%s::%s::%d",
-                         frame->className, frame->functionName,
-                         frame->fileName, frame->lineNumber);
-#else
-                snprintf(buf, sizeof(buf), "%s::%s::%s::0",
-                         frame->className, frame->functionName,
-                         frame->fileName);
-#endif
+    // Returns the exception stack, innermost first
+    int GetExceptionFrames(ExceptionFrame *&outFrames)
+    {
+        int size = mExceptionFrames.size();
+        outFrames = size ? &mExceptionFrames[0] : NULL;
+        if (!mCaught || (mCatchFrame.frame == NULL)) {
+            return size;
+        }
+        for (int i = 0; i < size; i++) {
+            if (mExceptionFrames[i].IsFrame(mCatchFrame)) {
+                return i + 1;
             }
-            mExceptionStack.push_back(::String(buf));
         }
+        // Thrown without a capture, so only the catch is known
+        outFrames = &mCatchFrame;
+        return 1;
     }
 
     void DumpExceptionStack()
@@ -900,10 +1896,15 @@ public:
         printf(__VA_ARGS__)
 #endif
         
-        int size = mExceptionStack.size();
+        ExceptionFrame *frames;
+        int size = GetExceptionFrames(frames);
 
         for (int i = 0; i < size; i++) {
-            EXCEPTION_PRINT("Called from %s\n", mExceptionStack[i].c_str());
+            ExceptionFrame &frame = frames[i];
+            EXCEPTION_PRINT("Called from %s\n",
+                            FormatFrame(frame.className, frame.functionName,
+                                        frame.fileName,
+                                        frame.lineNumber).c_str());
         }
     }
 
@@ -911,8 +1912,16 @@ private:
 
     CallStack(int threadNumber)
         : mThreadNumber(threadNumber), mCanStop(true), mStatus(STATUS_RUNNING),
-          mBreakpoint(-1), mWaiting(false), mContinueCount(0), mProfiler(NULL)
+          mBreakpoint(-1), mExceptionObject(NULL), mCaught(false),
+          mWaiting(false), mContinueCount(0), mProfiler(NULL),
+          mTopFrame(HX_TOP_FRAME_SLOT)
+    {
+        GCAddRoot(&mExceptionObject);
+    }
+
+    ~CallStack()
     {
+        GCRemoveRoot(&mExceptionObject);
     }
 
     void DoBreak(ThreadStatus status, int breakpoint,
@@ -929,7 +1938,7 @@ private:
         mCanStop = false;
 
         // Call the handler to announce the status.
-        StackFrame *frame = mStackFrames.back();
+        StackFrame *frame = *mTopFrame;
         g_eventNotificationHandler
             (mThreadNumber, THREAD_STOPPED, ::String(frame->className),
              ::String(frame->functionName), ::String(frame->fileName),
@@ -968,10 +1977,12 @@ private:
             (stack->mThreadNumber, stack->mStatus, stack->mBreakpoint,
              stack->mCriticalErrorDescription);
 
-        int size = stack->mStackFrames.size();
+        std::vector<StackFrame *> frames;
+        stack->GetFrames(frames);
+        int size = frames.size();
         for (int i = 0; i < size; i++) {
             g_addStackFrameToThreadInfoFunction
-                (ret, StackFrameToStackFrameLocked(stack->mStackFrames[i]));
+                (ret, StackFrameToStackFrameLocked(frames[i]));
         }
         
         return ret;
@@ -994,9 +2005,13 @@ private:
     ThreadStatus mStatus;
     int mBreakpoint;
     ::String mCriticalErrorDescription;
-    std::vector<StackFrame *> mStackFrames;
-    // Updated only when a thrown exception unwinds the stack
-    std::vector< ::String> mExceptionStack;
+    // Captured by each throw, and kept for reuse
+    std::vector<ExceptionFrame> mExceptionFrames;
+    // The object last thrown, only compared to spot a rethrow.  Rooted, so
+    // a new object can not take its address while it is remembered.
+    hx::Object *mExceptionObject;
+    ExceptionFrame mCatchFrame;
+    bool mCaught;
     int mStepLevel;
     MyMutex mWaitMutex;
     bool mWaiting;
@@ -1004,7 +2019,10 @@ private:
     int mContinueCount;
 
     // Profiling support
-    Profiler *mProfiler;
+    Profiler * volatile mProfiler;
+
+    // The owning thread's top frame slot
+    StackFrame **mTopFrame;
 
     // gMutex protects gMap and gList
     static MyMutex gMutex;
@@ -1016,6 +2034,16 @@ private:
 /* static */ std::list<CallStack *> CallStack::gList;
 
 
+void CallStackThreadExit()
+{
+    CallStack::RemoveCallerCallStack();
+#ifdef HX_TOP_FRAME_SLOT_ALLOCATED
+    free(tlsTopFrameSlot);
+    tlsTopFrameSlot = NULL;
+#endif
+}
+
+
 class Breakpoints
 {
 public:
@@ -1045,16 +2073,7 @@ public:
 
         int ret = gNextBreakpointNumber++;
         
-        Breakpoints *newBreakpoints = new Breakpoints
-            (gBreakpoints, ret, fileName, lineNumber);
-        
-        gBreakpoints->RemoveRef();
-
-        // Write memory barrier ensures that newBreakpoints values are updated
-        // before gBreakpoints is assigned to it
-        write_memory_barrier();
-
-        gBreakpoints = newBreakpoints;
+        Publish(new Breakpoints(gBreakpoints, ret, fileName, lineNumber));
 
         // Don't need a write memory barrier here, it's harmless to see
         // gShouldCallHandleBreakpoints update before gBreakpoints has updated
@@ -1078,16 +2097,7 @@ public:
 
         int ret = gNextBreakpointNumber++;
         
-        Breakpoints *newBreakpoints = new Breakpoints
-            (gBreakpoints, ret, className, functionName);
-        
-        gBreakpoints->RemoveRef();
-
-        // Write memory barrier ensures that newBreakpoints values are updated
-        // before gBreakpoints is assigned to it
-        write_memory_barrier();
-
-        gBreakpoints = newBreakpoints;
+        Publish(new Breakpoints(gBreakpoints, ret, className, functionName));
 
         // Don't need a write memory barrier here, it's harmless to see
         // gShouldCallHandleBreakpoints update before gBreakpoints has updated
@@ -1102,15 +2112,7 @@ public:
     {
         gMutex.Lock();
         
-        Breakpoints *newBreakpoints = new Breakpoints();
-
-        gBreakpoints->RemoveRef();
-
-        // Write memory barrier ensures that newBreakpoints values are updated
-        // before gBreakpoints is assigned to it
-        write_memory_barrier();
-
-        gBreakpoints = newBreakpoints;
+        Publish(new Breakpoints());
 
         // Don't need a write memory barrier here, it's harmless to see
         // gShouldCallHandleBreakpoints update before gStepType has updated
@@ -1126,15 +2128,7 @@ public:
         if (gBreakpoints->HasBreakpoint(number)) {
             // Replace mBreakpoints with a copy and remove the breakpoint
             // from it
-            Breakpoints *newBreakpoints = new Breakpoints(gBreakpoints, number);
-        
-            gBreakpoints->RemoveRef();
-
-            // Write memory barrier ensures that newBreakpoints values are
-            // updated before gBreakpoints is assigned to it
-            write_memory_barrier();
-
-            gBreakpoints = newBreakpoints;
+            Publish(new Breakpoints(gBreakpoints, number));
 
             if (gBreakpoints->IsEmpty()) {
                 // Don't need a write memory barrier here, it's harmless to
@@ -1152,6 +2146,7 @@ public:
         gStepType = STEP_INTO;
         gStepCount = 0;
         gStepThread = -1;
+        gDebuggerStepping = true;
         // Won't bother with a write memory barrier here, it's harmless to set
         // gShouldCallHandleBreakpoints before the step type and step thread
         // are updated xxx should consider making gStepType and gStepThread
@@ -1167,6 +2162,7 @@ public:
     static void ContinueThreads(int specialThreadNumber, int continueCount)
     {
         gStepType = STEP_NONE;
+        gDebuggerStepping = false;
 
         gShouldCallHandleBreakpoints = !gBreakpoints->IsEmpty();
 
@@ -1179,10 +2175,21 @@ public:
         gStepThread = threadNumber;
         gStepType = stepType;
         gStepCount = stepCount;
+        gDebuggerStepping = (stepType != STEP_NONE);
         
         CallStack::StepOneThread(threadNumber, gStepLevel);
     }
 
+#ifdef HXCPP_DEBUGGER
+    // Sets up the breakpoint state of a new stack frame
+    static void EnterFrame(StackFrame *frame)
+    {
+        frame->breakLines = FindBreakLines(frame->fileName);
+        frame->breakOnEntry = IsBreakFunction(frame->className,
+                                              frame->functionName);
+    }
+#endif
+
     // Note that HandleBreakpoints is called immediately after a read memory
     // barrier by the HX_STACK_LINE macro
     static void HandleBreakpoints()
@@ -1219,51 +2226,20 @@ public:
             }
         }
 
-        // If didn't hit any immediate breakpoints, check for set breakpoints
+#ifdef HXCPP_DEBUGGER
+        // If didn't hit any immediate breakpoints, check for set breakpoints.
+        // Only a line whose bit is set, or the first line of a function
+        // with a class:function breakpoint, gets here.
         if (breakStatus == STATUS_INVALID) {
-            Breakpoints *breakpoints = tlsBreakpoints;
-            // If the current thread has never gotten a reference to
-            // breakpoints, get a reference to the current breakpoints
-            if (breakpoints == NULL) {
-                gMutex.Lock();
-                // Get break points and ref it
-                breakpoints = gBreakpoints;
-                // This read memory barrier ensures that old values within
-                // gBreakpoints are not seen after gBreakpoints has been set
-                // here
-                read_memory_barrier();
-                tlsBreakpoints = breakpoints;
-                breakpoints->AddRef();
-                gMutex.Unlock();
-            }
-            // Else if the current thread's breakpoints number is out of date,
-            // release the reference on that and get the new breakpoints.
-            // Note that no locking is done on the reference to gBreakpoints.
-            // A thread calling GetBreakpoints will retain its old breakpoints
-            // until it "sees" a newer gBreakpoints.  Without memory barriers,
-            // this could theoretically be indefinitely.
-            else if (breakpoints != gBreakpoints) {
-                gMutex.Lock();
-                // Release ref on current break points
-                breakpoints->RemoveRef();
-                // Get new break points and ref it
-                breakpoints = gBreakpoints;
-                // This read memory barrier ensures that old values within
-                // gBreakpoints are not seen after gBreakpoints has been set
-                // here
-                read_memory_barrier();
-                tlsBreakpoints = breakpoints;
-                breakpoints->AddRef();
-                gMutex.Unlock();
-            }
+            Breakpoints *breakpoints = GetThreadBreakpoints();
 
             // If there are breakpoints, then may need to break in one
             if (!breakpoints->IsEmpty()) {
                 StackFrame *frame = stack->GetCurrentStackFrame();
 
-                // Check for class:function breakpoint if this is the
-                // first line of the stack frame
-                if (frame->lineNumber == frame->firstLineNumber) {
+                // Check for class:function breakpoint once per call
+                if (frame->breakOnEntry) {
+                    frame->breakOnEntry = false;
                     breakpointNumber = 
                         breakpoints->FindClassFunctionBreakpoint
                         (frame->className, frame->functionName);
@@ -1271,7 +2247,8 @@ public:
                 
                 // If still haven't hit a break point, check for file:line
                 // breakpoint
-                if (breakpointNumber == -1) {
+                if ((breakpointNumber == -1) &&
+                    frame->breakLines->IsBreakLine(frame->lineNumber)) {
                     breakpointNumber =
                         breakpoints->FindFileLineBreakpoint
                         (frame->fileName, frame->lineNumber);
@@ -1282,6 +2259,7 @@ public:
                 }
             }
         }
+#endif
 
         // If no breakpoint of any kind was found, then don't break
         if (breakStatus == STATUS_INVALID) {
@@ -1314,6 +2292,227 @@ public:
 
 private:
 
+    // Returns the calling thread's reference to the current breakpoints
+    static Breakpoints *GetThreadBreakpoints()
+    {
+        Breakpoints *breakpoints = tlsBreakpoints;
+        // If the current thread has never gotten a reference to
+        // breakpoints, get a reference to the current breakpoints
+        if (breakpoints == NULL) {
+            gMutex.Lock();
+            // Get break points and ref it
+            breakpoints = gBreakpoints;
+            tlsBreakpoints = breakpoints;
+            breakpoints->AddRef();
+            gMutex.Unlock();
+        }
+        // Else if the current thread's breakpoints number is out of date,
+        // release the reference on that and get the new breakpoints.
+        // Note that no locking is done on the reference to gBreakpoints.
+        // A thread calling GetBreakpoints will retain its old breakpoints
+        // until it "sees" a newer gBreakpoints.  Without memory barriers,
+        // this could theoretically be indefinitely.
+        else if (breakpoints != gBreakpoints) {
+            gMutex.Lock();
+            // Release ref on current break points
+            breakpoints->RemoveRef();
+            // Get new break points and ref it
+            breakpoints = gBreakpoints;
+            tlsBreakpoints = breakpoints;
+            breakpoints->AddRef();
+            gMutex.Unlock();
+        }
+        return breakpoints;
+    }
+
+    // Replaces gBreakpoints and brings the line bitmaps into line with it.
+    // Must be called with gMutex held.
+    static void Publish(Breakpoints *newBreakpoints)
+    {
+        FreeRetired();
+
+        Breakpoints *oldBreakpoints = gBreakpoints;
+
+        // The release store orders newBreakpoints' contents before the pointer
+        HxAtomicStoreReleasePtr((void * volatile *) &gBreakpoints,
+                                newBreakpoints);
+
+        // Set bits only once the breakpoints they lead to are visible, and
+        // clear the bits of removed breakpoints afterwards
+        int functionCount = 0;
+        for (int i = 0; i < newBreakpoints->mBreakpointCount; i++) {
+            Breakpoint &breakpoint = newBreakpoints->mBreakpoints[i];
+            if (breakpoint.isFileLine) {
+                SetBreakLine(FindBreakLines(breakpoint.fileOrClassName),
+                             breakpoint.lineNumber, true);
+            }
+            else {
+                functionCount++;
+            }
+        }
+        PublishBreakFunctions(newBreakpoints, functionCount);
+        for (int i = 0; i < oldBreakpoints->mBreakpointCount; i++) {
+            Breakpoint &breakpoint = oldBreakpoints->mBreakpoints[i];
+            if (breakpoint.isFileLine &&
+                (newBreakpoints->FindFileLineBreakpoint
+                 (breakpoint.fileOrClassName, breakpoint.lineNumber) == -1)) {
+                SetBreakLine(FindBreakLines(breakpoint.fileOrClassName),
+                             breakpoint.lineNumber, false);
+            }
+        }
+
+        oldBreakpoints->RemoveRef();
+    }
+
+    // Rebuilds the class:function table probed on every frame entry.  It
+    // is keyed by the interned class name, with a copy of the function
+    // name, and is replaced whole.  Must be called with gMutex held.
+    static void PublishBreakFunctions(const Breakpoints *breakpoints,
+                                      int functionCount)
+    {
+        BreakFunctions *oldTable = gBreakFunctions;
+        if (functionCount == 0) {
+            HxAtomicStoreReleasePtr((void * volatile *) &gBreakFunctions, NULL);
+            RetireBreakFunctions(oldTable);
+            return;
+        }
+        int size = 8;
+        while (size < functionCount * 2) {
+            size *= 2;
+        }
+        BreakFunctions *table = (BreakFunctions *)
+            calloc(1, sizeof(BreakFunctions) +
+                   (size - 1) * sizeof(BreakFunction));
+        table->mask = size - 1;
+        for (int i = 0; i < breakpoints->mBreakpointCount; i++) {
+            Breakpoint &breakpoint = breakpoints->mBreakpoints[i];
+            if (breakpoint.isFileLine) {
+                continue;
+            }
+            size_t slot =
+                ((size_t) breakpoint.fileOrClassName >> 3) & table->mask;
+            while (table->slots[slot].className != NULL) {
+                slot = (slot + 1) & table->mask;
+            }
+            table->slots[slot].className = breakpoint.fileOrClassName;
+            table->slots[slot].functionName =
+                strdup(breakpoint.functionName.c_str());
+        }
+        HxAtomicStoreReleasePtr((void * volatile *) &gBreakFunctions, table);
+        RetireBreakFunctions(oldTable);
+    }
+
+    // Only functions of classes that have a class:function breakpoint get
+    // as far as a string compare
+    static bool IsBreakFunction(const char *className,
+                                const char *functionName)
+    {
+        BreakFunctions *table = (BreakFunctions *)
+            HxAtomicLoadAcquirePtr((void * volatile *) &gBreakFunctions);
+        if (table == NULL) {
+            return false;
+        }
+        size_t slot = ((size_t) className >> 3) & table->mask;
+        while (table->slots[slot].className != NULL) {
+            if ((table->slots[slot].className == className) &&
+                !strcmp(table->slots[slot].functionName, functionName)) {
+                return true;
+            }
+            slot = (slot + 1) & table->mask;
+        }
+        return false;
+    }
+
+    // Returns the line bitmap of an interned file name.  The table holds
+    // every file in __hxcpp_all_files and is never changed once built, so
+    // lookups need no lock.  Other names share an empty bitmap.  The names
+    // are published last, so once they are seen the rest is too.
+    static BreakLines *FindBreakLines(const char *fileName)
+    {
+        const char **names = (const char **)
+            HxAtomicLoadAcquirePtr((void * volatile *) &gBreakFileNames);
+        if (names == NULL) {
+            names = BuildBreakFiles();
+        }
+        size_t slot = ((size_t) fileName >> 3) & gBreakFileMask;
+        while (names[slot] != NULL) {
+            if (names[slot] == fileName) {
+                return &gBreakFileLines[slot];
+            }
+            slot = (slot + 1) & gBreakFileMask;
+        }
+        return &gNoBreakLines;
+    }
+
+    static const char **BuildBreakFiles()
+    {
+        gBreakFilesMutex.Lock();
+        if (gBreakFileNames == NULL) {
+            int count = 0;
+            for (const char **ptr = hx::__hxcpp_all_files; *ptr; ptr++) {
+                if (!strcmp(*ptr, CLASSES_MARKER_WITHIN_FILES_ARRAY)) {
+                    break;
+                }
+                count++;
+            }
+            int size = 16;
+            while (size < count * 2) {
+                size *= 2;
+            }
+            const char **names = (const char **) calloc(size, sizeof(char *));
+            gBreakFileLines = (BreakLines *) malloc(size * sizeof(BreakLines));
+            for (int i = 0; i < size; i++) {
+                gBreakFileLines[i].bits = gNoBreakLineBits;
+            }
+            gBreakFileMask = size - 1;
+            for (int i = 0; i < count; i++) {
+                const char *fileName = hx::__hxcpp_all_files[i];
+                size_t slot = ((size_t) fileName >> 3) & gBreakFileMask;
+                while ((names[slot] != NULL) && (names[slot] != fileName)) {
+                    slot = (slot + 1) & gBreakFileMask;
+                }
+                names[slot] = fileName;
+            }
+            HxAtomicStoreReleasePtr((void * volatile *) &gBreakFileNames,
+                                    names);
+        }
+        gBreakFilesMutex.Unlock();
+        return gBreakFileNames;
+    }
+
+    // Must be called with gMutex held
+    static void SetBreakLine(BreakLines *lines, int lineNumber, bool set)
+    {
+        if ((lines == &gNoBreakLines) || (lineNumber < 0)) {
+            return;
+        }
+        unsigned int word = ((unsigned int) lineNumber) >> 5;
+        const unsigned int *bits = lines->bits;
+        if (word >= bits[0]) {
+            if (!set) {
+                return;
+            }
+            // Other threads may still be reading the old words
+            unsigned int size = (bits[0] * 2 > word) ? bits[0] * 2 : word + 1;
+            unsigned int *grown =
+                (unsigned int *) calloc(size + 1, sizeof(unsigned int));
+            memcpy(grown + 1, bits + 1, bits[0] * sizeof(unsigned int));
+            grown[0] = size;
+            HxAtomicStoreReleasePtr((void * volatile *) &lines->bits, grown);
+            if (bits != gNoBreakLineBits) {
+                Retire(bits);
+            }
+            bits = grown;
+        }
+        unsigned int *words = (unsigned int *) bits;
+        if (set) {
+            words[word + 1] |= (1U << (lineNumber & 31));
+        }
+        else {
+            words[word + 1] &= ~(1U << (lineNumber & 31));
+        }
+    }
+
     struct Breakpoint
     {
         // Do not use the Garbage Collector for managing Breakpoint objects
@@ -1337,6 +2536,59 @@ private:
         ::String functionName;
     };
 
+    struct BreakFunction
+    {
+        const char *className;
+        const char *functionName;
+    };
+
+    struct BreakFunctions
+    {
+        size_t mask;
+        BreakFunction slots[1];
+    };
+
+private:
+
+    // Frames read the function table and line bitmaps without a lock, so
+    // replaced ones are only freed once every thread has been at a GC safe
+    // point, which no thread reaches in the middle of a lookup.  Must be
+    // called with gMutex held.
+    static void Retire(const void *ptr)
+    {
+        gRetired.push_back(Retired(ptr, hx::GCCollectEpoch()));
+    }
+
+    static void FreeRetired()
+    {
+        int epoch = hx::GCCollectEpoch();
+        size_t kept = 0;
+        for (size_t i = 0; i < gRetired.size(); i++) {
+            if (gRetired[i].second == epoch) {
+                gRetired[kept++] = gRetired[i];
+            }
+            else {
+                free((void *) gRetired[i].first);
+            }
+        }
+        gRetired.resize(kept);
+    }
+
+    static void RetireBreakFunctions(BreakFunctions *table)
+    {
+        if (table == NULL) {
+            return;
+        }
+        for (size_t slot = 0; slot <= table->mask; slot++) {
+            if (table->slots[slot].functionName != NULL) {
+                Retire(table->slots[slot].functionName);
+            }
+        }
+        Retire(table);
+    }
+
+public:
+
     // Creates Breakpoints object with no breakpoints and a zero version
     Breakpoints()
         : mRefCount(1), mBreakpointCount(0), mBreakpoints(NULL)
@@ -1390,7 +2642,7 @@ private:
                 if (other.number == number) {
                     continue;
                 }
-                mBreakpoints[d++] = mBreakpoints[s];
+                mBreakpoints[d++] = other;
             }
         }
     }
@@ -1500,6 +2752,17 @@ private:
     static int gStepLevel;
     static int gStepThread; // If -1, all threads are targeted
     static int gStepCount;
+    static BreakFunctions * volatile gBreakFunctions;
+    // Replaced allocations, and the GC epoch they were replaced in
+    typedef std::pair<const void *, int> Retired;
+    static std::vector<Retired> gRetired;
+
+    static MyMutex gBreakFilesMutex;
+    static const char ** volatile gBreakFileNames;
+    static BreakLines *gBreakFileLines;
+    static size_t gBreakFileMask;
+    static const unsigned int gNoBreakLineBits[1];
+    static BreakLines gNoBreakLines;
 };
 /* static */ MyMutex Breakpoints::gMutex;
 /* static */ int Breakpoints::gNextBreakpointNumber;
@@ -1509,6 +2772,15 @@ private:
 /* static */ int Breakpoints::gStepLevel;
 /* static */ int Breakpoints::gStepThread = -1;
 /* static */ int Breakpoints::gStepCount = -1;
+/* static */ Breakpoints::BreakFunctions * volatile
+    Breakpoints::gBreakFunctions;
+/* static */ std::vector<Breakpoints::Retired> Breakpoints::gRetired;
+/* static */ MyMutex Breakpoints::gBreakFilesMutex;
+/* static */ const char ** volatile Breakpoints::gBreakFileNames;
+/* static */ BreakLines *Breakpoints::gBreakFileLines;
+/* static */ size_t Breakpoints::gBreakFileMask;
+/* static */ const unsigned int Breakpoints::gNoBreakLineBits[1] = { 0 };
+/* static */ BreakLines Breakpoints::gNoBreakLines = { gNoBreakLineBits };
 
 
 } // namespace
@@ -1716,11 +2988,6 @@ void __hxcpp_dbg_threadCreatedOrTerminated(int threadNumber, bool created)
         return;
     }
 
-    // If the thread was not created, remove its call stack
-    if (!created) {
-        hx::CallStack::RemoveCallStack(threadNumber);
-    }
-
     handler(threadNumber, created ? hx::THREAD_CREATED : hx::THREAD_TERMINATED);
 }
 
@@ -1762,53 +3029,98 @@ hx::StackFrame::StackFrame(const char *inClassName, const char *inFunctionName,
 #endif
       catchables(NULL)
 {
-    hx::CallStack::PushStackFrame(this);
+    StackFrame **top = HX_TOP_FRAME_SLOT;
+    parent = *top;
+    HX_PROFILE_BARRIER();
+    *top = this;
+
+    // Register the thread's call stack when it first enters haxe code
+    if (parent == NULL) {
+        hx::CallStack::GetCallerCallStack();
+    }
+#ifdef HXCPP_DEBUGGER
+    hx::Breakpoints::EnterFrame(this);
+#endif
+#ifdef HXCPP_PROFILE_INSTRUMENT
+    instrumentEntry = NULL;
+    if (hx::Instrument::gActive) {
+        hx::Instrument::Enter(this);
+    }
+#endif
+#ifndef HX_PROFILE_SIGNAL
+    if (hx::Profiler::IsRunning()) {
+        hx::Profiler::TickCurrentThread();
+    }
+#endif
 }
 
     
 hx::StackFrame::~StackFrame()
 {
-    hx::CallStack::PopStackFrame();
+#ifdef HXCPP_PROFILE_INSTRUMENT
+    if (instrumentEntry != NULL) {
+        hx::Instrument::Leave(this);
+    }
+#endif
+#ifndef HX_PROFILE_SIGNAL
+    if (hx::Profiler::IsRunning()) {
+        hx::Profiler::TickCurrentThread();
+    }
+#endif
+    *HX_TOP_FRAME_SLOT = parent;
 }
 
 
-void hx::Profiler::Sample(hx::CallStack *stack)
+void hx::Profiler::Capture(hx::CallStack *stack, int weight)
 {
-    if (mT0 == gProfileClock) {
+    int head = mHead;
+    if ((head - mTail) >= RING_SIZE) {
+        mDropped = mDropped + 1;
         return;
     }
 
-    // Latch the profile clock and calculate the time since the last profile
-    // clock tick
-    int clock = gProfileClock;
-    int delta = clock - mT0;
-    if (delta < 0) {
-        delta = 1;
+    Sample &sample = mRing[head & (RING_SIZE - 1)];
+
+    // Walk out from the innermost frame, so deep stacks keep those, then
+    // put the outermost first
+    StackFrame *frame = stack->GetTopFrame();
+    int depth = 0;
+    for (; frame != NULL && depth < MAX_FRAMES; frame = frame->parent) {
+        sample.frames[depth++] = frame->fullName;
     }
-    mT0 = clock;
+    for (int i = 0; i < depth / 2; i++) {
+        const char *name = sample.frames[i];
+        sample.frames[i] = sample.frames[depth - 1 - i];
+        sample.frames[depth - 1 - i] = name;
+    }
+    sample.weight = weight;
+    sample.depth = depth;
+    sample.truncated = (frame != NULL);
 
-    int depth = stack->GetDepth();
+    // Publish the sample after its contents
+    HxMemoryBarrier();
+    mHead = head + 1;
+}
 
-    std::map<const char *, bool> alreadySeen;
 
-    // Add children time in to each stack element
-    for (int i = 0; i < (depth - 1); i++) {
-        const char *fullName = stack->GetFullNameAtDepth(i);
-        ProfileEntry &pe = mProfileStats[fullName];
-        if (!alreadySeen.count(fullName)) {
-            pe.total += delta;
-            alreadySeen[fullName] = true;
-        }
-        // For everything except the very bottom of the stack, add the time to
-        // that child's total with this entry
-        pe.children[stack->GetFullNameAtDepth(i + 1)] += delta;
+void hx::Profiler::OnSignal(hx::CallStack *stack)
+{
+    Profiler *profiler = stack->GetProfiler();
+    if (profiler != NULL) {
+        profiler->Capture(stack, 1);
     }
+}
+
 
-    // Add the time into the actual function being executed
-    if (depth > 0) {
-        mProfileStats[stack->GetFullNameAtDepth(depth - 1)].self += delta;
+#ifndef HX_PROFILE_SIGNAL
+void hx::Profiler::TickCurrentThread()
+{
+    CallStack *stack = tlsCallStack;
+    if ((stack != NULL) && (stack->GetProfiler() != NULL)) {
+        stack->GetProfiler()->Tick(stack);
     }
 }
+#endif
 
 
 // The old Debug.cpp had this here.  Why is this here????
@@ -1860,20 +3172,85 @@ void NullReference(const char *type, bool allowFixup)
 
 void __hxcpp_start_profiler(::String inDumpFile)
 {
-#ifdef HXCPP_STACK_TRACE
+#if defined(HXCPP_PROFILE_INSTRUMENT)
+    hx::Instrument::Start(inDumpFile);
+#elif defined(HXCPP_STACK_TRACE)
     hx::CallStack::StartCurrentThreadProfiler(inDumpFile);
+#else
+    (void)inDumpFile;
 #endif
 }
 
 
 void __hxcpp_stop_profiler()
 {
-#ifdef HXCPP_STACK_TRACE
+#if defined(HXCPP_PROFILE_INSTRUMENT)
+    hx::Instrument::Stop();
+#elif defined(HXCPP_STACK_TRACE)
     hx::CallStack::StopCurrentThreadProfiler();
 #endif
 }
 
 
+void __hxcpp_trace_enable(bool inEnable)
+{
+    if (inEnable && !hx::gTraceEnabled && !hx::gTraceStart) {
+        hx::gTraceStart = hx::MonotonicNanos();
+    }
+    hx::gTraceEnabled = inEnable;
+}
+
+
+void __hxcpp_trace_begin(::String inName)
+{
+    if (hx::gTraceEnabled) {
+        hx::TraceEvent(hx::traceBegin, hx::InternTraceName(inName));
+    }
+}
+
+
+void __hxcpp_trace_end()
+{
+    if (hx::gTraceEnabled) {
+        hx::TraceEvent(hx::traceEnd, NULL);
+    }
+}
+
+
+void __hxcpp_trace_instant(::String inName)
+{
+    if (hx::gTraceEnabled) {
+        hx::TraceEvent(hx::traceInstant, hx::InternTraceName(inName));
+    }
+}
+
+
+void __hxcpp_trace_counter(::String inName, double inValue)
+{
+    if (hx::gTraceEnabled) {
+        hx::TraceEvent(hx::traceCounter, hx::InternTraceName(inName), inValue);
+    }
+}
+
+
+void __hxcpp_trace_flush(::String inFile)
+{
+    hx::FlushTrace(inFile.c_str());
+}
+
+
+void __hxcpp_dump_profiler(::String inDumpFile)
+{
+#if defined(HXCPP_PROFILE_INSTRUMENT)
+    hx::Instrument::Dump(inDumpFile.__CStr());
+#elif defined(HXCPP_STACK_TRACE)
+    hx::CallStack::DumpCurrentThreadProfiler(inDumpFile);
+#else
+    (void)inDumpFile;
+#endif
+}
+
+
 void __hx_dump_stack()
 {
 #ifdef HXCPP_STACK_TRACE
@@ -1883,10 +3260,55 @@ void __hx_dump_stack()
 }
 
 
-void __hx_stack_set_last_exception()
+void __hx_stack_set_last_exception(hx::Object *inException)
+{
+#ifdef HXCPP_STACK_TRACE
+    bool capture = (hx::gControlFlowClassCount == 0) ||
+        !hx::IsControlFlowException(inException);
+    hx::CallStack::GetCallerCallStack()->SetLastException(inException, capture);
+#else
+    (void)inException;
+#endif
+}
+
+
+void __hxcpp_set_control_flow_exception(Class inClass, bool inControlFlow)
 {
 #ifdef HXCPP_STACK_TRACE
-    hx::CallStack::GetCallerCallStack()->SetLastException();
+    if (inClass.mPtr == NULL) {
+        throw HX_INVALID_OBJECT;
+    }
+    hx::gControlFlowMutex.Lock();
+    int count = hx::gControlFlowClassCount;
+    int found = -1;
+    for (int i = 0; i < count; i++) {
+        if (hx::gControlFlowClasses[i] == inClass.mPtr) {
+            found = i;
+        }
+    }
+    if (inControlFlow && (found < 0)) {
+        if (count == hx::MAX_CONTROL_FLOW_CLASSES) {
+            hx::gControlFlowMutex.Unlock();
+            hx::Throw(HX_CSTRING("Too many control flow exception classes"));
+        }
+        // Rooted so a moving collection updates them
+        if (count == 0) {
+            for (int i = 0; i < hx::MAX_CONTROL_FLOW_CLASSES; i++) {
+                hx::GCAddRoot(&hx::gControlFlowClasses[i]);
+            }
+        }
+        hx::gControlFlowClasses[count] = inClass.mPtr;
+        hx::gControlFlowClassCount = count + 1;
+    }
+    else if (!inControlFlow && (found >= 0)) {
+        hx::gControlFlowClasses[found] = hx::gControlFlowClasses[count - 1];
+        hx::gControlFlowClassCount = count - 1;
+        hx::gControlFlowClasses[count - 1] = NULL;
+    }
+    hx::gControlFlowMutex.Unlock();
+#else
+    (void)inClass;
+    (void)inControlFlow;
 #endif
 }
 
@@ -1899,12 +3321,66 @@ void __hxcpp_stack_begin_catch()
 }
 
 
+void *__hxcpp_stack_top()
+{
+#ifdef HXCPP_STACK_TRACE
+    return *HX_TOP_FRAME_SLOT;
+#else
+    return 0;
+#endif
+}
+
+
+void *__hxcpp_stack_detach(void *inBase)
+{
+#ifdef HXCPP_STACK_TRACE
+    hx::StackFrame **slot = HX_TOP_FRAME_SLOT;
+    hx::StackFrame *top = *slot;
+    if (top == inBase) {
+        return 0;
+    }
+    // Cut the chain where it joins the frames below
+    hx::StackFrame *bottom = top;
+    while (bottom->parent != inBase) {
+        bottom = bottom->parent;
+    }
+    bottom->parent = NULL;
+    *slot = (hx::StackFrame *)inBase;
+    return top;
+#else
+    (void)inBase;
+    return 0;
+#endif
+}
+
+
+void __hxcpp_stack_attach(void *inFrames)
+{
+#ifdef HXCPP_STACK_TRACE
+    if (inFrames) {
+        hx::StackFrame **slot = HX_TOP_FRAME_SLOT;
+        hx::StackFrame *bottom = (hx::StackFrame *)inFrames;
+        while (bottom->parent != NULL) {
+            bottom = bottom->parent;
+        }
+        bottom->parent = *slot;
+        HX_PROFILE_BARRIER();
+        *slot = (hx::StackFrame *)inFrames;
+    }
+#else
+    (void)inFrames;
+#endif
+}
+
+
 Array<String> __hxcpp_get_call_stack(bool inSkipLast)
 {
     Array< ::String> result = Array_obj< ::String>::__new();
 
 #ifdef HXCPP_STACK_TRACE
     hx::CallStack::GetCurrentCallStackAsStrings(result, inSkipLast);
+#else
+    (void)inSkipLast;
 #endif
 
     return result;
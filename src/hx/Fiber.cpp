@@ -0,0 +1,310 @@
+#include <hxcpp.h>
+
+#include <hx/Thread.h>
+
+#ifdef HX_WINDOWS
+#include <setjmp.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+// --- Fiber ------------------------------------------------------------------
+//
+// Stackful coroutines.  Resume switches to the fiber's own stack until it yields or
+//  returns, and yield switches back to whoever resumed it.  While a fiber runs, the
+//  resumer's stack is registered with the GC as a suspended stack.  While a fiber is
+//  suspended its stack is scanned from the fiber's __Mark, so an abandoned fiber is
+//  collected, and its stack released, like any other object.
+// Posix stacks are mmap'd with a guard page below them.  Windows uses OS fibers.
+
+#ifndef HXCPP_FIBER_STACK_SIZE
+#define HXCPP_FIBER_STACK_SIZE (64*1024)
+#endif
+
+enum FiberState { fiberNew, fiberRunning, fiberSuspended, fiberDone };
+
+// Saved state of a context that has switched away
+struct FiberContext
+{
+   #ifdef HX_WINDOWS
+   void    *mFiber;
+   jmp_buf mRegisters;
+   #else
+   ucontext_t mRegisters;
+   #endif
+   hx::SuspendedStack mStack;
+};
+
+class hxFiber;
+
+DECLARE_TLS_DATA(hxFiber, tlsCurrentFiber);
+
+// The frame of a function called from here is below everything live in the callers' frames
+#ifdef _MSC_VER
+__declspec(noinline) static int *GetStackBottom() { return (int *)_AddressOfReturnAddress(); }
+#else
+__attribute__((noinline)) static int *GetStackBottom() { return (int *)__builtin_frame_address(0); }
+#endif
+
+// Everything in the callers' frames is above the bottom, and the registers are saved
+//  in the context, so the collector sees all of the suspended stack.
+static void SwitchContext(FiberContext *inFrom,FiberContext *inTo)
+{
+   inFrom->mStack.mBottom = GetStackBottom();
+   inFrom->mStack.mRegisters = &inFrom->mRegisters;
+   inFrom->mStack.mRegisterSize = sizeof(inFrom->mRegisters);
+   #ifdef HX_WINDOWS
+   if (!setjmp(inFrom->mRegisters))
+      SwitchToFiber(inTo->mFiber);
+   #else
+   swapcontext(&inFrom->mRegisters,&inTo->mRegisters);
+   #endif
+}
+
+#ifdef HX_WINDOWS
+DECLARE_TLS_DATA(void, tlsThreadFiber);
+
+static void *GetThreadFiber()
+{
+   if (!tlsThreadFiber)
+      tlsThreadFiber = ConvertThreadToFiber(0);
+   return GetCurrentFiber();
+}
+
+static void CALLBACK FiberEntry(void *);
+#else
+static void FiberEntry();
+#endif
+
+
+class hxFiber : public hx::Object
+{
+public:
+   hxFiber(Dynamic inFunc,int inStackSize) :
+      mFunc(inFunc), mState(fiberNew), mFailed(false), mStackSize(inStackSize),
+      mStackBase(0), mStackTop(0), mCaller(0), mPrevious(0), mFrames(0)
+   {
+      mContext = (FiberContext *)calloc(1,sizeof(FiberContext));
+   }
+
+   static void clean(hx::Object *inObj)
+   {
+      hxFiber *fiber = hx::DynamicCast<hxFiber>(inObj);
+      if (fiber)
+         fiber->FreeStack();
+   }
+
+   void AllocStack()
+   {
+      #ifdef HX_WINDOWS
+      mContext->mFiber = CreateFiber(mStackSize,FiberEntry,0);
+      if (!mContext->mFiber)
+         hx::Throw( HX_CSTRING("Could not create fiber") );
+      #else
+      size_t page = sysconf(_SC_PAGESIZE);
+      size_t size = (mStackSize + page - 1) & ~(page-1);
+      char *base = (char *)mmap(0, size+page, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, -1, 0);
+      if (base==(char *)MAP_FAILED)
+         hx::Throw( HX_CSTRING("Could not allocate fiber stack") );
+      // Overflow faults rather than running into other memory
+      mprotect(base,page,PROT_NONE);
+      mStackBase = base;
+      mStackBytes = size+page;
+      mStackTop = (int *)(base + size + page);
+
+      getcontext(&mContext->mRegisters);
+      mContext->mRegisters.uc_stack.ss_sp = base + page;
+      mContext->mRegisters.uc_stack.ss_size = size;
+      mContext->mRegisters.uc_link = 0;
+      makecontext(&mContext->mRegisters,FiberEntry,0);
+      #endif
+   }
+
+   void FreeStack()
+   {
+      if (!mContext)
+         return;
+      #ifdef HX_WINDOWS
+      if (mContext->mFiber)
+         DeleteFiber(mContext->mFiber);
+      #else
+      if (mStackBase)
+         munmap(mStackBase,mStackBytes);
+      #endif
+      mStackBase = 0;
+      free(mContext);
+      mContext = 0;
+   }
+
+   Dynamic Resume(Dynamic inValue)
+   {
+      if (mState!=fiberNew && mState!=fiberSuspended)
+         hx::Throw( HX_CSTRING("Fiber is not suspended") );
+      if (mState==fiberNew)
+         AllocStack();
+
+      FiberContext caller;
+      #ifdef HX_WINDOWS
+      caller.mFiber = GetThreadFiber();
+      #endif
+      mCaller = &caller;
+      mTransfer = inValue;
+      mPrevious = tlsCurrentFiber;
+      tlsCurrentFiber = this;
+      void *frameBase = __hxcpp_stack_top();
+      __hxcpp_stack_attach(mFrames);
+      mFrames = 0;
+      mState = fiberRunning;
+
+      // A new Windows fiber only finds its stack top once running, so FiberEntry pushes
+      if (mStackTop)
+         hx::GCPushSuspendedStack(&caller.mStack,mStackTop);
+      SwitchContext(&caller,mContext);
+      hx::GCPopSuspendedStack();
+
+      tlsCurrentFiber = mPrevious;
+      mPrevious = 0;
+      mCaller = 0;
+      Dynamic result = mTransfer;
+      mTransfer = null();
+      if (mState==fiberDone)
+      {
+         FreeStack();
+         if (mFailed)
+            hx::Throw(result);
+      }
+      else
+         mFrames = __hxcpp_stack_detach(frameBase);
+      return result;
+   }
+
+   Dynamic Yield(Dynamic inValue)
+   {
+      mTransfer = inValue;
+      mState = fiberSuspended;
+      mContext->mStack.mTop = mStackTop;
+      SwitchContext(mContext,mCaller);
+
+      Dynamic result = mTransfer;
+      mTransfer = null();
+      return result;
+   }
+
+   void Run()
+   {
+      try
+      {
+         mTransfer = mFunc->__run();
+      }
+      catch(Dynamic e)
+      {
+         mTransfer = e;
+         mFailed = true;
+      }
+      catch(...)
+      {
+         // Nothing to unwind into past the entry, so fail the resume instead
+         mTransfer = HX_CSTRING("Native exception in fiber");
+         mFailed = true;
+      }
+      mFunc = null();
+      mState = fiberDone;
+      SwitchContext(mContext,mCaller);
+   }
+
+   void __Mark(hx::MarkContext *__inCtx)
+   {
+      HX_MARK_MEMBER(mFunc);
+      HX_MARK_MEMBER(mTransfer);
+      if (mState==fiberSuspended)
+         hx::MarkSuspendedStack(&mContext->mStack,__inCtx);
+   }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx)
+   {
+      // Objects found on the stack are pinned, so only the members can move
+      HX_VISIT_MEMBER(mFunc);
+      HX_VISIT_MEMBER(mTransfer);
+   }
+   #endif
+
+   Dynamic      mFunc;
+   Dynamic      mTransfer;
+   int          mState;
+   bool         mFailed;
+   int          mStackSize;
+   char         *mStackBase;
+   size_t       mStackBytes;
+   int          *mStackTop;
+   FiberContext *mContext;
+   FiberContext *mCaller;
+   hxFiber      *mPrevious;
+   void         *mFrames;
+};
+
+
+#ifdef HX_WINDOWS
+static void CALLBACK FiberEntry(void *)
+{
+   hxFiber *fiber = tlsCurrentFiber;
+   // The OS chose the stack, so its top is found from here.  SwitchContext has already
+   //  filled in the resumer's bottom and registers.
+   int top = 0;
+   fiber->mStackTop = &top;
+   hx::GCPushSuspendedStack(&fiber->mCaller->mStack,&top);
+   fiber->Run();
+}
+#else
+static void FiberEntry()
+{
+   hxFiber *fiber = tlsCurrentFiber;
+   fiber->Run();
+}
+#endif
+
+
+Dynamic __hxcpp_fiber_create(Dynamic inFunc,int inStackSize)
+{
+   hxFiber *fiber = new hxFiber(inFunc, inStackSize>0 ? inStackSize : HXCPP_FIBER_STACK_SIZE);
+   // The finalizer lock is held by a collecting thread, so wait for it in a free zone
+   hx::EnterGCFreeZone();
+   hx::GCSetFinalizer(fiber,hxFiber::clean);
+   hx::ExitGCFreeZone();
+   return fiber;
+}
+
+Dynamic __hxcpp_fiber_resume(Dynamic inFiber,Dynamic inValue)
+{
+   hxFiber *fiber = hx::DynamicCast<hxFiber>(inFiber.mPtr);
+   if (!fiber)
+      throw HX_INVALID_OBJECT;
+   return fiber->Resume(inValue);
+}
+
+Dynamic __hxcpp_fiber_yield(Dynamic inValue)
+{
+   hxFiber *fiber = tlsCurrentFiber;
+   if (!fiber)
+      hx::Throw( HX_CSTRING("Yield called outside a fiber") );
+   return fiber->Yield(inValue);
+}
+
+Dynamic __hxcpp_fiber_current()
+{
+   return (hxFiber *)tlsCurrentFiber;
+}
+
+int __hxcpp_fiber_state(Dynamic inFiber)
+{
+   hxFiber *fiber = hx::DynamicCast<hxFiber>(inFiber.mPtr);
+   if (!fiber)
+      throw HX_INVALID_OBJECT;
+   return fiber->mState;
+}
+
@@ -60,6 +60,8 @@ static int gCollectTraceCount = 0;
 
 
 static int sgTimeToNextTableUpdate = 0;
+// Incremented on each collection - invalidates the per-thread caches
+static int sgCollectEpoch = 0;
 
 
 MyMutex  *gThreadStateChangeLock=0;
@@ -71,6 +73,7 @@ static bool sMultiThreadMode = false;
 DECLARE_TLS_DATA(LocalAllocator, tlsLocalAlloc);
 
 static void MarkLocalAlloc(LocalAllocator *inAlloc,hx::MarkContext *__inCtx);
+static void SetupLocalStack();
 static void WaitForSafe(LocalAllocator *inAlloc);
 static void ReleaseFromSafe(LocalAllocator *inAlloc);
 
@@ -892,15 +895,24 @@ void MarkObjectAlloc(hx::Object *inPtr,hx::MarkContext *__inCtx)
 
 typedef std::set<hx::Object **> RootSet;
 static RootSet sgRootSet;
+// Roots are added from any thread - CFFI roots from native threads, call stacks and
+//  debugger handlers from their own threads - including ones in a GC-free zone while
+//  a collection walks the set.  Created with the allocator - before that there is
+//  only the one thread.
+static MyMutex *sgRootLock = 0;
 
 void GCAddRoot(hx::Object **inRoot)
 {
+   if (sgRootLock) sgRootLock->Lock();
    sgRootSet.insert(inRoot);
+   if (sgRootLock) sgRootLock->Unlock();
 }
 
 void GCRemoveRoot(hx::Object **inRoot)
 {
+   if (sgRootLock) sgRootLock->Lock();
    sgRootSet.erase(inRoot);
+   if (sgRootLock) sgRootLock->Unlock();
 }
 
 
@@ -969,7 +981,9 @@ InternalFinalizer::InternalFinalizer(hx::Object *inObj)
    mObject = inObj;
    mFinalizer = 0;
 
-   AutoLock lock(*gThreadStateChangeLock);
+   // Not gThreadStateChangeLock - a collecting thread holds that while it waits for
+   //  this one to reach a safe point
+   AutoLock lock(*sFinalizerLock);
    sgFinalizers->push(this);
 }
 
@@ -1141,7 +1155,7 @@ hx::Object *__hxcpp_weak_ref_create(Dynamic inObject)
 
 hx::Object *__hxcpp_weak_ref_get(Dynamic inRef)
 {
-   hx::WeakRef *ref = dynamic_cast<hx::WeakRef *>(inRef.mPtr);
+   hx::WeakRef *ref = hx::DynamicCast<hx::WeakRef>(inRef.mPtr);
    return ref->mRef.mPtr;
 }
 
@@ -1183,6 +1197,7 @@ public:
       mNextEmpty = 0;
       mRowsInUse = 0;
       mLargeAllocated = 0;
+      mExternalAllocated = 0;
       mLargeAllocSpace = 40 << 20;
       mLargeAllocForceRefresh = mLargeAllocSpace;
       // Start at 1 Meg...
@@ -1209,9 +1224,10 @@ public:
    {
       //Should we force a collect ? - the 'large' data are not considered when allocating objects
       // from the blocks, and can 'pile up' between smalll object allocations
-      if (inSize+mLargeAllocated > mLargeAllocForceRefresh)
+      if (inSize+mLargeAllocated+mExternalAllocated > mLargeAllocForceRefresh)
       {
          //GCLOG("Large alloc causing collection");
+         SetupLocalStack();
          Collect(true,false);
       }
 
@@ -1224,6 +1240,7 @@ public:
       if (!result)
       {
          //GCLOG("Large alloc panic!");
+         SetupLocalStack();
          Collect(true,false);
          result = (unsigned int *)malloc(inSize + sizeof(int)*2);
       }
@@ -1242,6 +1259,15 @@ public:
 
       return result+2;
    }
+
+   // Malloc'd memory held by collectable objects is not freed by a collection directly,
+   //  but counts towards forcing one, the same as a large allocation.
+   bool ChangeExternalMemory(int inDelta)
+   {
+      int total = HxAtomicAdd(&mExternalAllocated,inDelta) + inDelta;
+      return inDelta>0 && mLargeAllocated+total > mLargeAllocForceRefresh;
+   }
+
    // Making this function "virtual" is actually a (big) performance enhancement!
    // On the iphone, sjlj (set-jump-long-jump) exceptions are used, which incur a
    //  performance overhead.  It seems that the overhead in only in routines that call
@@ -1754,6 +1780,7 @@ public:
 
       hx::VisitClassStatics(inCtx);
 
+      hx::sgRootLock->Lock();
       for(hx::RootSet::iterator i = hx::sgRootSet.begin(); i!=hx::sgRootSet.end(); ++i)
       {
          hx::Object **obj = &**i;
@@ -1763,6 +1790,7 @@ public:
             (*obj)->__Visit(inCtx);
          }
       }
+      hx::sgRootLock->Unlock();
       for(int i=0;i<hx::sZombieList.size();i++)
       {
          inCtx->visitObject( &hx::sZombieList[i] );
@@ -1775,6 +1803,7 @@ public:
 
    void MarkAll(bool inDoClear)
    {
+      HX_TRACE_BEGIN("MarkAll");
       gByteMarkID = (gByteMarkID+1) & 0xff;
       gMarkID = gByteMarkID << 24;
 
@@ -1785,6 +1814,7 @@ public:
 
       mMarker.Process();
 
+      hx::sgRootLock->Lock();
       for(hx::RootSet::iterator i = hx::sgRootSet.begin(); i!=hx::sgRootSet.end(); ++i)
       {
          hx::Object *&obj = **i;
@@ -1793,6 +1823,7 @@ public:
             hx::MarkObjectAlloc(obj , &mMarker );
          }
       }
+      hx::sgRootLock->Unlock();
 
       // Mark zombies too....
       for(int i=0;i<hx::sZombieList.size();i++)
@@ -1805,8 +1836,11 @@ public:
 
       hx::FindZombies(mMarker);
 
+      HX_TRACE_END();
 
+      HX_TRACE_BEGIN("RunFinalizers");
       hx::RunFinalizers();
+      HX_TRACE_END();
    }
 
    int Collect(bool inMajor, bool inForceCompact)
@@ -1839,10 +1873,14 @@ public:
       }
 
       // Now all threads have mTopOfStack & mBottomOfStack set.
+      HX_TRACE_BEGIN("Collect");
+
+      sgCollectEpoch++;
 
       MarkAll(true);
 
       // Reclaim ...
+      HX_TRACE_BEGIN("Reclaim");
 
       sgTimeToNextTableUpdate--;
       if (sgTimeToNextTableUpdate<0)
@@ -1881,7 +1919,7 @@ public:
       int blockSize =  mAllBlocks.size()<<IMMIX_BLOCK_BITS;
       if (blockSize > mLargeAllocSpace)
          mLargeAllocSpace = blockSize;
-      mLargeAllocForceRefresh = mLargeAllocated + mLargeAllocSpace;
+      mLargeAllocForceRefresh = mLargeAllocated + mExternalAllocated + mLargeAllocSpace;
 
       //GCLOG("Using %d, blocks %d (%d)\n", mTotalAfterLastCollect, mAllBlocks.size(), mAllBlocks.size()*IMMIX_BLOCK_SIZE);
 
@@ -1970,6 +2008,10 @@ public:
       }
 
 
+      // Reclaim, Collect
+      HX_TRACE_END();
+      HX_TRACE_END();
+
       if (sMultiThreadMode)
       {
          for(int i=0;i<mLocalAllocs.size();i++)
@@ -1979,6 +2021,7 @@ public:
          hx::gPauseForCollect = false;
          gThreadStateChangeLock->Unlock();
       }
+      HX_TRACE_COUNTER("GC memory", (double)MemUsage());
 
       #ifdef ANDROID
       //__android_log_print(ANDROID_LOG_INFO, "hxcpp", "Collect Done");
@@ -2015,6 +2058,7 @@ public:
    size_t mLargeAllocSpace;
    size_t mLargeAllocForceRefresh;
    size_t mLargeAllocated;
+   volatile int mExternalAllocated;
    size_t mTotalAfterLastCollect;
 
    hx::MarkContext mMarker;
@@ -2038,14 +2082,25 @@ GlobalAllocator *sGlobalAlloc = 0;
 //
 // One per thread ...
 
+struct InterfaceEntry
+{
+   hx::Object *mReal;
+   const void *mInterface;
+   hx::Object *mWrapper;
+};
+
 class LocalAllocator
 {
 public:
    LocalAllocator(int *inTopOfStack=0)
    {
       mTopOfStack = inTopOfStack;
+      mSuspended = 0;
       mRegisterBufSize = 0;
       mGCFreeZone = false;
+      mInterfaceEpoch = sgCollectEpoch;
+      memset(mInterfaces,0,sizeof(mInterfaces));
+      memset(mCasts,0,sizeof(mCasts));
       Reset();
       mState = lasNew;
       sGlobalAlloc->AddLocal(this);
@@ -2082,6 +2137,22 @@ public:
          EnterGCFreeZone();
    }
 
+   // The current stack is suspended (the caller has filled in its bottom and saved
+   //  registers) while this thread runs on another stack, such as a fiber's
+   void PushSuspendedStack(hx::SuspendedStack *inStack,int *inNewTop)
+   {
+      inStack->mTop = mTopOfStack;
+      inStack->mNext = mSuspended;
+      mSuspended = inStack;
+      mTopOfStack = inNewTop;
+   }
+
+   void PopSuspendedStack()
+   {
+      mTopOfStack = mSuspended->mTop;
+      mSuspended = mSuspended->mNext;
+   }
+
    void SetBottomOfStack(int *inBottom)
    {
       mBottomOfStack = inBottom;
@@ -2102,18 +2173,23 @@ public:
       mBottomOfStack = (int *)&dummy;
       hx::RegisterCapture::Instance()->Capture(mTopOfStack,mRegisterBuf,mRegisterBufSize,20,mBottomOfStack);
  
+      HX_TRACE_BEGIN("GC wait");
       mReadyForCollect.Set();
       mCollectDone.Wait();
+      HX_TRACE_END();
    }
 
    void EnterGCFreeZone()
    {
       volatile int dummy = 1;
       mBottomOfStack = (int *)&dummy;
-      mGCFreeZone = true;
       if (mTopOfStack)
          hx::RegisterCapture::Instance()->Capture(mTopOfStack,
                 mRegisterBuf,mRegisterBufSize,20,mBottomOfStack);
+      // A collecting thread scans us as soon as it sees the flag, so the stack
+      //  and registers must be complete first
+      HxMemoryBarrier();
+      mGCFreeZone = true;
       mReadyForCollect.Set();
    }
 
@@ -2282,8 +2358,23 @@ public:
    }
 
 
+   // Interface wrappers are not marked from here, so they are forgotten after a collection
+   InterfaceEntry &FindInterface(hx::Object *inReal,const void *inInterface)
+   {
+      if (mInterfaceEpoch!=sgCollectEpoch)
+      {
+         memset(mInterfaces,0,sizeof(mInterfaces));
+         mInterfaceEpoch = sgCollectEpoch;
+      }
+      size_t key = ((size_t)inReal>>4) ^ ((size_t)inInterface>>3);
+      return mInterfaces[ (key ^ (key>>INTERFACE_BITS)) & (INTERFACE_SLOTS-1) ];
+   }
+
    void Mark(hx::MarkContext *__inCtx)
    {
+      for(hx::SuspendedStack *s = mSuspended; s; s = s->mNext)
+         hx::MarkSuspendedStack(s,__inCtx);
+
       if (!mTopOfStack)
          return;
 
@@ -2307,9 +2398,12 @@ public:
       Reset();
    }
 
-   void MarkConservative(int *inBottom, int *inTop,hx::MarkContext *__inCtx)
+   static void MarkConservative(int *inBottom, int *inTop,hx::MarkContext *__inCtx)
    {
       void *prev = 0;
+      // Steps by int but reads whole pointers, so stop before the last one runs past
+      //  the end - the range may finish at the last mapped byte, like a fiber stack top.
+      inTop = (int *)((char *)inTop - sizeof(void *) + sizeof(int));
       for(int *ptr = inBottom ; ptr<inTop; ptr++)
       {
          void *vptr = *(void **)ptr;
@@ -2362,10 +2456,18 @@ public:
 
    int *mTopOfStack;
    int *mBottomOfStack;
+   hx::SuspendedStack *mSuspended;
 
    int  *mRegisterBuf[20];
    int  mRegisterBufSize;
 
+   enum { INTERFACE_BITS = 6, INTERFACE_SLOTS = 1<<INTERFACE_BITS };
+   InterfaceEntry mInterfaces[INTERFACE_SLOTS];
+   int            mInterfaceEpoch;
+
+   // Vtables do not move, so unlike the caches above this one outlives collections
+   hx::CastCacheEntry mCasts[hx::HX_CAST_CACHE_SLOTS];
+
    bool            mGCFreeZone;
    int             mID;
    LocalAllocState mState;
@@ -2423,6 +2525,14 @@ void MarkLocalAlloc(LocalAllocator *inAlloc,hx::MarkContext *__inCtx)
    inAlloc->Mark(__inCtx);
 }
 
+// The bottom of this thread's stack is only recorded when it takes a new block, so
+//  refresh it before collecting from anywhere else - the thread may be on another
+//  stack, such as a fiber's, by now.
+void SetupLocalStack()
+{
+   GetLocalAlloc()->SetupStack();
+}
+
 
 namespace hx
 {
@@ -2467,6 +2577,7 @@ void InitAlloc()
    sGlobalAlloc = new GlobalAllocator();
    sgFinalizers = new FinalizerList();
    sFinalizerLock = new MyMutex();
+   sgRootLock = new MyMutex();
    hx::Object tmp;
    void **stack = *(void ***)(&tmp);
    sgObject_root = stack[0];
@@ -2483,6 +2594,33 @@ void GCPrepareMultiThreaded()
 }
 
 
+int GCCollectEpoch()
+{
+   return sgCollectEpoch;
+}
+
+void GCPushSuspendedStack(SuspendedStack *inStack,void *inNewTop)
+{
+   GetLocalAlloc()->PushSuspendedStack(inStack,(int *)inNewTop);
+}
+
+void GCPopSuspendedStack()
+{
+   GetLocalAlloc()->PopSuspendedStack();
+}
+
+void MarkConservative(void *inBottom,void *inTop,hx::MarkContext *__inCtx)
+{
+   LocalAllocator::MarkConservative((int *)inBottom,(int *)inTop,__inCtx);
+}
+
+void MarkSuspendedStack(SuspendedStack *inStack,hx::MarkContext *__inCtx)
+{
+   MarkConservative(inStack->mBottom,inStack->mTop,__inCtx);
+   MarkConservative(inStack->mRegisters,
+        (char *)inStack->mRegisters + inStack->mRegisterSize,__inCtx);
+}
+
 void SetTopOfStack(int *inTop,bool inForce)
 {
    if (!sgAllocInit)
@@ -2522,6 +2660,33 @@ void *InternalNew(int inSize,bool inIsObject)
    }
 }
 
+hx::Object *GetCachedInterface(hx::Object *inReal,const void *inInterface)
+{
+   InterfaceEntry &entry = GetLocalAlloc()->FindInterface(inReal,inInterface);
+   return entry.mReal==inReal && entry.mInterface==inInterface ? entry.mWrapper : 0;
+}
+
+void SetCachedInterface(hx::Object *inReal,const void *inInterface,hx::Object *inWrapper)
+{
+   InterfaceEntry &entry = GetLocalAlloc()->FindInterface(inReal,inInterface);
+   entry.mReal = inReal;
+   entry.mInterface = inInterface;
+   entry.mWrapper = inWrapper;
+}
+
+CastCacheEntry *GetCastCache()
+{
+   // May be called before boot, or from a thread that is not registered
+   LocalAllocator *alloc = sMultiThreadMode ? (LocalAllocator *)tlsLocalAlloc : sMainThreadAlloc;
+   return alloc ? alloc->mCasts : 0;
+}
+
+void GCChangeExternalMemory(int inDelta)
+{
+   if (sGlobalAlloc && sGlobalAlloc->ChangeExternalMemory(inDelta))
+      InternalCollect(true,false);
+}
+
 // Force global collection - should only be called from 1 thread.
 int InternalCollect(bool inMajor,bool inCompact)
 {
@@ -2585,6 +2750,9 @@ void UnregisterCurrentThread()
    LocalAllocator *local = tlsLocalAlloc;
    delete local;
    tlsLocalAlloc = 0;
+   __hxcpp_thread_release_waiter();
+   CallStackThreadExit();
+   TraceThreadExit();
 }
 
 
@@ -226,7 +226,7 @@ public:
 
 void IntHash::Destroy(Object *inHash)
 {
-	IntHash *hash = dynamic_cast<IntHash *>(inHash);
+	IntHash *hash = hx::DynamicCast<IntHash>(inHash);
 	if (hash)
 		delete hash->mMap;
 }
@@ -238,37 +238,37 @@ Object * __int_hash_create() { return new IntHash; }
 
 void __int_hash_set(Dynamic inHash,int inKey,const Dynamic &value)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    h->set(inKey,value);
 }
 
 Dynamic  __int_hash_get(Dynamic inHash,int inKey)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    return h->get(inKey);
 }
 
 bool  __int_hash_exists(Dynamic inHash,int inKey)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    return h->exists(inKey);
 }
 
 bool  __int_hash_remove(Dynamic inHash,int inKey)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    return h->remove(inKey);
 }
 
 Dynamic __int_hash_keys(Dynamic inHash)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    return h->keys();
 }
 
 Dynamic __int_hash_values(Dynamic inHash)
 {
-   IntHash *h = dynamic_cast<IntHash *>(inHash.GetPtr());
+   IntHash *h = hx::DynamicCast<IntHash>(inHash.GetPtr());
    return h->values();
 }
 
@@ -68,6 +68,7 @@ Dynamic Interface::__IField(int i)
 	return __GetRealObject()->__IField( i);
 }
 
+
 Dynamic Interface::__SetField(const ::String &s,const Dynamic &d, bool inCallProp)
 {
 	return __GetRealObject()->__SetField(s,d,inCallProp);
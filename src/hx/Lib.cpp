@@ -136,6 +136,19 @@ public:
       return ((prim_mult)mProc)( (hx::Object **)inArgs->GetBase(), inArgs->length );
    }
 
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      if (mArgCount==-1 || mArgCount>5)
+      {
+         if (mArgCount!=-1 && mArgCount!=inArgCount)
+            throw HX_INVALID_ARG_COUNT;
+         HX_STACK_FRAME("extern", "cffi", "extern::cffi", __FILE__, __LINE__);
+         // Dynamic has the same layout as the hx::Object * it wraps
+         return ((prim_mult)mProc)( (hx::Object **)inArgs, inArgCount );
+      }
+      return hx::Object::__runArgs(inArgs,inArgCount);
+   }
+
    void __Mark(hx::MarkContext *__inCtx) {  HX_MARK_MEMBER(mName); }
 
    #ifdef HXCPP_VISIT_ALLOCS
@@ -144,7 +157,7 @@ public:
 
    int __Compare(const hx::Object *inRHS) const
    {
-      const ExternalPrimitive *other = dynamic_cast<const ExternalPrimitive *>(inRHS);
+      const ExternalPrimitive *other = hx::DynamicCast<ExternalPrimitive>(inRHS);
       if (!other)
          return -1;
       return mProc==other->mProc;
@@ -42,6 +42,13 @@ Dynamic Object::__IField(int inFieldID)
    return __Field( __hxcpp_field_from_id(inFieldID), true );
 }
 
+Dynamic RunArgs(hx::Object *inFunc,const Dynamic *inArgs,int inArgCount)
+{
+   if (!inFunc)
+      hx::Throw(HX_INVALID_OBJECT);
+   return inFunc->__runArgs(inArgs,inArgCount);
+}
+
 double Object::__INumField(int inFieldID)
 {
 	return __IField(inFieldID);
@@ -62,6 +69,23 @@ bool Object::__HasField(const String &inString)
    return false;
 }
 Dynamic Object::__Run(const Array<Dynamic> &inArgs) { return 0; }
+
+Dynamic Object::__runArgs(const Dynamic *inArgs,int inArgCount)
+{
+   switch(inArgCount)
+   {
+      case 0: return __run();
+      case 1: return __run(inArgs[0]);
+      case 2: return __run(inArgs[0],inArgs[1]);
+      case 3: return __run(inArgs[0],inArgs[1],inArgs[2]);
+      case 4: return __run(inArgs[0],inArgs[1],inArgs[2],inArgs[3]);
+      case 5: return __run(inArgs[0],inArgs[1],inArgs[2],inArgs[3],inArgs[4]);
+   }
+   Array<Dynamic> args = Array_obj<Dynamic>::__new(0,inArgCount);
+   for(int i=0;i<inArgCount;i++)
+      args->push(inArgs[i]);
+   return __Run(args);
+}
 Dynamic Object::__GetItem(int inIndex) const { return null(); }
 Dynamic Object::__SetItem(int inIndex,Dynamic) { return null();  }
 DynamicArray Object::__EnumParams() { return DynamicArray(); }
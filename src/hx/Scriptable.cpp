@@ -1,13 +1,32 @@
 #include <hxcpp.h>
+#include <hxMath.h>
 #include <hx/Scriptable.h>
 #include <hx/GC.h>
+#include <hx/Thread.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
 #include <vector>
 #include <string>
 #include <map>
 
-//#define DBGLOG(...) { }
-#define DBGLOG printf
+#ifdef _MSC_VER
+#include <malloc.h>
+#define ABC_ALLOCA _alloca
+#else
+#include <alloca.h>
+#define ABC_ALLOCA alloca
+#endif
+
+// GCC and clang can jump straight from one handler to the next through label addresses
+#if defined(__GNUC__) && !defined(HXCPP_ABC_SWITCH_DISPATCH)
+#define ABC_THREADED
+#endif
+
+#define DBGLOG(...) { }
+//#define DBGLOG printf
 
 namespace hx
 {
@@ -114,6 +133,10 @@ struct MultiName
 
 typedef std::vector<Namespace *> NsSet;
 
+struct ABC;
+struct AbcCode;
+class ABCGlobalObject;
+
 struct Optional
 {
    int val;
@@ -122,7 +145,7 @@ struct Optional
 
 struct Method
 {
-   Method() { body=0; }
+   Method() { body=0; abc=0; owner=0; }
 
    int paramCount;
    int returnType;
@@ -132,6 +155,9 @@ struct Method
    std::vector<Optional> optionals;
    std::vector<int> paramNames;
    struct MethodBody *body;
+   ABC *abc;
+   // Class whose constructor this is, for constructsuper
+   ScriptHandler *owner;
 };
 
 struct KeyValue
@@ -190,6 +216,8 @@ struct ExceptionInfo
 
 struct MethodBody
 {
+   MethodBody() : decoded(0) { }
+
    int method;
    int maxStack;
    int localCount;
@@ -198,6 +226,8 @@ struct MethodBody
    std::vector<unsigned char> code;
    std::vector<ExceptionInfo> exception;
    std::vector<Trait> traits;
+   // Instruction stream, built on first call
+   AbcCode *decoded;
 };
 
 
@@ -208,15 +238,47 @@ static String LANGLE = HX_CSTRING("<");
 static String RANGLE = HX_CSTRING(">");
 static String COMMA = HX_CSTRING(",");
 static String NAME_BOOLEAN = HX_CSTRING("Boolean");
-static String NAME_INT = HX_CSTRING("Int");
-static String NAME_UINT = HX_CSTRING("UInt");
+static String NAME_INT = HX_CSTRING("int");
+static String NAME_UINT = HX_CSTRING("uint");
 static String NAME_FLOAT = HX_CSTRING("Number");
 static String NAME_STRING = HX_CSTRING("String");
 
 static const char *sOpCodeNames[256];
 
+// Names and literals live as long as their ABC, so they are kept outside the GC heap
+//  with the header of a compiled-in constant, and are never marked.
+static String ConstString(const char *inChars,int inLength)
+{
+   int *header = (int *)malloc(sizeof(int) + inLength + 1);
+   header[0] = HX_GC_CONST_STRING;
+   char *chars = (char *)(header+1);
+   memcpy(chars,inChars,inLength);
+   chars[inLength] = '\0';
+   return String(chars,inLength);
+}
+
+static String ConstString(const String &inString)
+{
+   return ConstString(inString.__s,inString.length);
+}
+
+// Multiname resolved once after loading.  The local name is used for property access,
+//  the qualified names (one per namespace) to find classes.
+struct AbcName
+{
+   AbcName() : runtime(false), unsupported(false), globalSlot(-1) { }
+
+   String              name;
+   std::vector<String> qnames;
+   bool                runtime;     // MultinameL - the name is popped from the stack
+   bool                unsupported; // runtime namespaces and type names
+   int                 globalSlot;  // slot on the script global, once found
+};
+
 struct ABC
 {
+   ABC() : mGlobal(0) { }
+
    std::vector<int> mInts;
    std::vector<unsigned int> mUInts;
    std::vector<double> mDoubles;
@@ -233,6 +295,10 @@ struct ABC
 
    std::vector<MethodBody> mMethodBody;
 
+   std::vector<AbcName> mNames;
+   std::vector<Class_obj *> mClasses;
+   ABCGlobalObject *mGlobal;
+
    String getMultiNameSet(int inIdx)
    {
       NsSet &set = mNsSets[inIdx];
@@ -257,6 +323,14 @@ struct ABC
       return mStrings[mNamespaces[inIdx].index];
    }
 
+   // Members are found by their local name, whatever namespace they were declared in
+   String getLocalName(int inIdx)
+   {
+      if (inIdx>0 && inIdx<(int)mNames.size() && mNames[inIdx].name.__s)
+         return mNames[inIdx].name;
+      return getMultiName(inIdx);
+   }
+
    String getMultiName(int inIdx)
    {
       MultiName &mn = mMultiNames[inIdx];
@@ -281,10 +355,10 @@ struct ABC
             {
             String result = mStrings[mn.name];
             result+=LANGLE;
-            for(int i=0;i<mn.types.size();i++)
+            for(int i=0;i<(int)mn.types.size();i++)
             {
                result+=getMultiName(mn.types[i]);
-               if (i+1<mn.types.size())
+               if (i+1<(int)mn.types.size())
                   result+=COMMA;
             }
             result+=RANGLE;
@@ -406,7 +480,7 @@ struct FieldInfo
       mOffset = inOffset;
       mHandler = 0;
 
-      if (inName==NAME_BOOLEAN)
+      if (inType==NAME_BOOLEAN)
       {
          mType = typeBool;
          mGetter = sGetBool;
@@ -416,7 +490,7 @@ struct FieldInfo
          // Aligned ?
          mBytes = 4;
       }
-      else if (inName==NAME_INT || inName==NAME_UINT)
+      else if (inType==NAME_INT || inType==NAME_UINT)
       {
          mType = typeInt;
          mGetter = sGetInt;
@@ -425,7 +499,7 @@ struct FieldInfo
          mFSetter = sFSetInt;
          mBytes = 4;
       }
-      else if (inName==NAME_FLOAT)
+      else if (inType==NAME_FLOAT)
       {
          mType = typeDouble;
          mGetter = sGetDouble;
@@ -434,7 +508,7 @@ struct FieldInfo
          mFSetter = sFSetDouble;
          mBytes = sizeof(double);
       }
-      else if (inName==NAME_STRING)
+      else if (inType==NAME_STRING)
       {
          mType = typeString;
          mGetter = sGetString;
@@ -475,30 +549,432 @@ String RemapFlash(String inValue)
    return inValue;
 }
 
+
+static void ResolveNames(ABC &abc)
+{
+   abc.mNames.resize(abc.mMultiNames.size());
+   for(int i=1;i<(int)abc.mMultiNames.size();i++)
+   {
+      MultiName &mn = abc.mMultiNames[i];
+      AbcName &name = abc.mNames[i];
+      switch(mn.kind)
+      {
+         case QName:
+         case QNameA:
+            name.qnames.push_back( ConstString(RemapFlash(abc.join(abc.getNamespace(mn.ns),DOT,abc.mStrings[mn.name]))) );
+            break;
+         case Multiname:
+         case MultinameA:
+            {
+            NsSet &set = abc.mNsSets[mn.ns_set];
+            for(int n=0;n<(int)set.size();n++)
+               name.qnames.push_back( ConstString(RemapFlash(abc.join(abc.getNamespace(*set[n]),DOT,abc.mStrings[mn.name]))) );
+            }
+            break;
+         case MultinameL:
+         case MultinameLA:
+            name.runtime = true;
+            continue;
+         default:
+            name.unsupported = true;
+            continue;
+      }
+      // Index 0 is the any-name '*'
+      if (mn.name<=0)
+         name.unsupported = true;
+      else
+         name.name = abc.mStrings[mn.name];
+   }
+}
+
+// --- Values ----------------------------------------------------------------------
+
+enum AbcValueType { avNull, avBool, avInt, avDouble, avString, avObject };
+
+// Unboxed value held in locals and on the operand stack.  Strings keep their characters
+//  and length, objects their pointer - both are found by the conservative stack scan.
+struct AbcValue
+{
+   int type;
+   int length;
+   union
+   {
+      int           i;
+      double        d;
+      const HX_CHAR *s;
+      hx::Object    *o;
+   };
+};
+
+enum AbcCompare { abcLess=-1, abcEqual=0, abcGreater=1, abcUnordered=2 };
+
+static inline void abcSetNull(AbcValue &v) { v.type = avNull; v.o = 0; }
+static inline void abcSetBool(AbcValue &v,bool b) { v.type = avBool; v.i = b; }
+static inline void abcSetInt(AbcValue &v,int i) { v.type = avInt; v.i = i; }
+static inline void abcSetDouble(AbcValue &v,double d) { v.type = avDouble; v.d = d; }
+static inline void abcSetObject(AbcValue &v,hx::Object *o) { v.type = o ? avObject : avNull; v.o = o; }
+
+static inline void abcSetString(AbcValue &v,const String &s)
+{
+   if (!s.__s)
+      abcSetNull(v);
+   else
+   {
+      v.type = avString;
+      v.s = s.__s;
+      v.length = s.length;
+   }
+}
+
+// int results that overflow become Number, as in the AVM
+static inline void abcSetNumber(AbcValue &v,long long inValue)
+{
+   if (inValue>=INT_MIN && inValue<=INT_MAX)
+      abcSetInt(v,(int)inValue);
+   else
+      abcSetDouble(v,(double)inValue);
+}
+
+static inline void abcSetUInt(AbcValue &v,unsigned int inValue)
+{
+   if (inValue<=INT_MAX)
+      abcSetInt(v,(int)inValue);
+   else
+      abcSetDouble(v,(double)inValue);
+}
+
+static AbcValue abcFromDynamic(const Dynamic &inValue)
+{
+   AbcValue v;
+   hx::Object *obj = inValue.mPtr;
+   if (!obj)
+   {
+      abcSetNull(v);
+      return v;
+   }
+   switch(obj->__GetType())
+   {
+      case vtInt: abcSetInt(v,obj->__ToInt()); break;
+      case vtFloat: abcSetDouble(v,obj->__ToDouble()); break;
+      case vtBool: abcSetBool(v,obj->__ToInt()); break;
+      case vtString: abcSetString(v,obj->toString()); break;
+      default: abcSetObject(v,obj);
+   }
+   return v;
+}
+
+static Dynamic abcToDynamic(const AbcValue &v)
+{
+   switch(v.type)
+   {
+      case avBool: return (bool)v.i;
+      case avInt: return v.i;
+      case avDouble: return v.d;
+      case avString: return String(v.s,v.length);
+      case avObject: return v.o;
+   }
+   return null();
+}
+
+static inline hx::Object *abcToObject(const AbcValue &v)
+{
+   return v.type==avObject ? v.o : abcToDynamic(v).mPtr;
+}
+
+// ECMA ToInt32 - wraps modulo 2^32 rather than saturating
+static int abcDoubleToInt(double d)
+{
+   if (d>=INT_MIN && d<=INT_MAX)
+      return (int)d;
+   if (d!=d || d==HUGE_VAL || d==-HUGE_VAL)
+      return 0;
+   double m = fmod(d<0 ? ceil(d) : floor(d), 4294967296.0);
+   return (int)(unsigned int)(long long)m;
+}
+
+static double abcToNumber(const AbcValue &v)
+{
+   switch(v.type)
+   {
+      case avBool:
+      case avInt: return v.i;
+      case avDouble: return v.d;
+      case avString: return __hxcpp_parse_float(String(v.s,v.length));
+      case avObject: return v.o->__ToDouble();
+   }
+   return 0;
+}
+
+static inline int abcToInt(const AbcValue &v)
+{
+   if (v.type==avInt || v.type==avBool)
+      return v.i;
+   return abcDoubleToInt( v.type==avDouble ? v.d : abcToNumber(v) );
+}
+
+static inline bool abcToBool(const AbcValue &v)
+{
+   switch(v.type)
+   {
+      case avBool:
+      case avInt: return v.i!=0;
+      case avDouble: return v.d!=0 && v.d==v.d;
+      case avString: return v.length>0;
+      case avObject: return true;
+   }
+   return false;
+}
+
+static String abcToString(const AbcValue &v)
+{
+   switch(v.type)
+   {
+      case avBool: return v.i ? HX_CSTRING("true") : HX_CSTRING("false");
+      case avInt: return String(v.i);
+      case avDouble: return String(v.d);
+      case avString: return String(v.s,v.length);
+      case avObject:
+         {
+         String s = v.o->toString();
+         return s.__s ? s : HX_CSTRING("null");
+         }
+   }
+   return HX_CSTRING("null");
+}
+
+static inline bool abcStringEquals(const AbcValue &a,const AbcValue &b)
+{
+   return a.length==b.length && (a.s==b.s || !memcmp(a.s,b.s,a.length*sizeof(HX_CHAR)));
+}
+
+static bool abcEquals(const AbcValue &a,const AbcValue &b)
+{
+   if (a.type==avInt && b.type==avInt)
+      return a.i==b.i;
+   if (a.type==avNull || b.type==avNull)
+      return a.type==b.type;
+   if (a.type==avString && b.type==avString)
+      return abcStringEquals(a,b);
+   if (a.type==avObject || b.type==avObject)
+   {
+      if (a.type==b.type)
+         return a.o==b.o;
+      if (a.type==avString || b.type==avString)
+         return abcToString(a)==abcToString(b);
+   }
+   return abcToNumber(a)==abcToNumber(b);
+}
+
+static bool abcStrictEquals(const AbcValue &a,const AbcValue &b)
+{
+   bool aNumber = a.type==avInt || a.type==avDouble;
+   bool bNumber = b.type==avInt || b.type==avDouble;
+   if (aNumber && bNumber)
+      return a.type==avInt && b.type==avInt ? a.i==b.i : abcToNumber(a)==abcToNumber(b);
+   if (a.type!=b.type)
+      return false;
+   switch(a.type)
+   {
+      case avBool: return a.i==b.i;
+      case avString: return abcStringEquals(a,b);
+      case avObject: return a.o==b.o;
+   }
+   return true;
+}
+
+static int abcCompare(const AbcValue &a,const AbcValue &b)
+{
+   if (a.type==avInt && b.type==avInt)
+      return a.i<b.i ? abcLess : a.i>b.i ? abcGreater : abcEqual;
+   if (a.type==avString && b.type==avString)
+   {
+      int diff = memcmp(a.s,b.s,(a.length<b.length ? a.length : b.length)*sizeof(HX_CHAR));
+      if (diff==0)
+         diff = a.length - b.length;
+      return diff<0 ? abcLess : diff>0 ? abcGreater : abcEqual;
+   }
+   double x = abcToNumber(a);
+   double y = abcToNumber(b);
+   return x<y ? abcLess : x>y ? abcGreater : x==y ? abcEqual : abcUnordered;
+}
+
+static void abcAdd(AbcValue &ioA,const AbcValue &inB)
+{
+   if (ioA.type==avString || inB.type==avString || ioA.type==avObject || inB.type==avObject)
+      abcSetString(ioA, abcToString(ioA) + abcToString(inB));
+   else
+      abcSetDouble(ioA, abcToNumber(ioA) + abcToNumber(inB));
+}
+
+static String abcTypeOf(const AbcValue &v)
+{
+   switch(v.type)
+   {
+      case avBool: return HX_CSTRING("boolean");
+      case avInt:
+      case avDouble: return HX_CSTRING("number");
+      case avString: return HX_CSTRING("string");
+      case avObject:
+         if (v.o->__GetType()==vtFunction)
+            return HX_CSTRING("function");
+   }
+   return HX_CSTRING("object");
+}
+
+static inline void abcGetField(const FieldInfo &inField,const unsigned char *inData,AbcValue &outValue)
+{
+   const unsigned char *ptr = inData + inField.mOffset;
+   switch(inField.mType)
+   {
+      case FieldInfo::typeBool: abcSetBool(outValue,*(int *)ptr!=0); break;
+      case FieldInfo::typeInt: abcSetInt(outValue,*(int *)ptr); break;
+      case FieldInfo::typeDouble: abcSetDouble(outValue,*(double *)ptr); break;
+      case FieldInfo::typeString: abcSetString(outValue,*(String *)ptr); break;
+      case FieldInfo::typeObject: abcSetObject(outValue,*(hx::Object **)ptr); break;
+   }
+}
+
+static inline void abcSetField(const FieldInfo &inField,unsigned char *inData,const AbcValue &inValue)
+{
+   unsigned char *ptr = inData + inField.mOffset;
+   switch(inField.mType)
+   {
+      case FieldInfo::typeBool: *(int *)ptr = abcToBool(inValue); break;
+      case FieldInfo::typeInt: *(int *)ptr = abcToInt(inValue); break;
+      case FieldInfo::typeDouble: *(double *)ptr = abcToNumber(inValue); break;
+      case FieldInfo::typeString:
+         *(String *)ptr = inValue.type==avNull ? String() : abcToString(inValue);
+         break;
+      case FieldInfo::typeObject: *(hx::Object **)ptr = abcToObject(inValue); break;
+   }
+}
+
+// Statics are held boxed, converted to the declared type on the way in
+static Dynamic abcCoerce(FieldInfo::Type inType,const AbcValue &inValue)
+{
+   switch(inType)
+   {
+      case FieldInfo::typeBool: return abcToBool(inValue);
+      case FieldInfo::typeInt: return abcToInt(inValue);
+      case FieldInfo::typeDouble: return abcToNumber(inValue);
+      case FieldInfo::typeString:
+         if (inValue.type==avNull)
+            return null();
+         return abcToString(inValue);
+      case FieldInfo::typeObject:
+         break;
+   }
+   return abcToDynamic(inValue);
+}
+
+static Dynamic abcDefault(FieldInfo::Type inType)
+{
+   switch(inType)
+   {
+      case FieldInfo::typeBool: return false;
+      case FieldInfo::typeInt: return 0;
+      case FieldInfo::typeDouble: return Math_obj::NaN;
+      default: ;
+   }
+   return null();
+}
+
+
+static AbcValue Interpret(Method *inMethod,AbcValue *inArgs,int inArgCount);
+static Dynamic CallMethod(Method *inMethod,hx::Object *inThis,const Dynamic *inArgs,int inArgCount);
+
+// Script method bound to its object, as read from a property
+class ABCFunction : public hx::Object
+{
+public:
+   ABCFunction(Method *inMethod,hx::Object *inThis) : mMethod(inMethod), mThis(inThis) { }
+
+   int __GetType() const { return vtFunction; }
+   int __ArgCount() const { return mMethod->paramCount; }
+   String toString() { return HX_CSTRING("function"); }
+
+   Dynamic __run() { return CallMethod(mMethod,mThis,0,0); }
+   Dynamic __run(D a) { return CallMethod(mMethod,mThis,&a,1); }
+   Dynamic __run(D a,D b)
+      { Dynamic args[] = { a,b }; return CallMethod(mMethod,mThis,args,2); }
+   Dynamic __run(D a,D b,D c)
+      { Dynamic args[] = { a,b,c }; return CallMethod(mMethod,mThis,args,3); }
+   Dynamic __run(D a,D b,D c,D d)
+      { Dynamic args[] = { a,b,c,d }; return CallMethod(mMethod,mThis,args,4); }
+   Dynamic __run(D a,D b,D c,D d,D e)
+      { Dynamic args[] = { a,b,c,d,e }; return CallMethod(mMethod,mThis,args,5); }
+   Dynamic __runArgs(const Dynamic *inArgs,int inArgCount)
+      { return CallMethod(mMethod,mThis,inArgs,inArgCount); }
+   Dynamic __Run(const Array<Dynamic> &inArgs)
+   {
+      Array<Dynamic> args = inArgs;
+      return CallMethod(mMethod,mThis,args->length ? &args[0] : 0,args->length);
+   }
+
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_OBJECT(mThis); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_OBJECT(mThis); }
+   #endif
+
+   Method     *mMethod;
+   hx::Object *mThis;
+};
+
+class ScriptHandler;
+
+// What a name refers to on a script class or its instances
+struct ScriptMember
+{
+   ScriptMember() : field(-1), method(0), getter(0), setter(0), owner(0) { }
+
+   bool found() const { return field>=0 || method || getter || setter; }
+
+   int    field;
+   Method *method;
+   Method *getter;
+   Method *setter;
+   // Set on members remembered by name, which are never moved or changed
+   ScriptHandler *owner;
+};
+
+typedef std::map<const AbcName *, ScriptMember> ScriptMemberCache;
+
+
 typedef std::map< std::string, int> MethodIndexMap;
 typedef std::map< std::string, Method *> MethodMap;
 typedef std::map< std::string, int> FieldIndexMap;
 
 class ScriptHandler : public Class_obj
 {
+public:
    Class mSuper;
    ScriptRegistered *mScriptBase;
    ScriptRegistered *mScript;
    std::vector<FieldInfo> mFields;
    std::vector<FieldInfo> mStaticFields;
-   std::vector<unsigned char> mStaticData;
+   Array<Dynamic> mFieldDefaults;
+   Array<Dynamic> mStaticValues;
    bool mIsInterface;
    int  mDataSize;
    Method **mVTable;
    MethodIndexMap         mMethodMap;
    FieldIndexMap          mFieldMap;
+   MethodMap              mGetterMap;
+   MethodMap              mSetterMap;
+   std::vector<int>       mSlotFields;
    MethodMap              mStaticMethodMap;
+   MethodMap              mStaticGetterMap;
+   MethodMap              mStaticSetterMap;
    FieldIndexMap          mStaticFieldMap;
+   std::vector<int>       mStaticSlotFields;
    std::vector<Method *>  mMethods;
    Method                 *mConstructor;
    Method                 *mStaticInit;
+   bool                   mStaticInitDone;
+   ScriptMemberCache      mMemberCache;
+   ScriptMemberCache      mStaticMemberCache;
+   MyMutex                mMemberCacheLock;
 
-public:
    ScriptHandler(ABC &abc, InstanceInfo &inst, TraitSet &cinfo)
    {
       init();
@@ -508,6 +984,7 @@ public:
       mScriptBase = 0;
       mIsInterface = inst.flags & ClassInterface;
       mConstructor = &abc.mMethods[inst.iinit];
+      mConstructor->owner = this;
       mStaticInit = &abc.mMethods[cinfo.init];
 
       if (inst.superName>0)
@@ -534,21 +1011,25 @@ public:
       mScript = mScriptBase;
       (*sScriptRegistered)[mName.__s] = mScript;
 
-      ScriptHandler *superScript = dynamic_cast<ScriptHandler *>(mSuper.GetPtr());
+      ScriptHandler *superScript = hx::DynamicCast<ScriptHandler>(mSuper.GetPtr());
       if (superScript)
       {
          mFields = superScript->mFields;
          mFieldMap = superScript->mFieldMap;
+         mFieldDefaults = superScript->mFieldDefaults->copy();
          mMethods = superScript->mMethods;
          mMethodMap = superScript->mMethodMap;
+         mGetterMap = superScript->mGetterMap;
+         mSetterMap = superScript->mSetterMap;
+         mSlotFields = superScript->mSlotFields;
       }
       mDataSize = superScript ? superScript->mDataSize : 0;
 
       mVTable = new Method*[mScript->mVTableEntries.size()];
-      for(int t=0;t<inst.traits.size();t++)
+      for(int t=0;t<(int)inst.traits.size();t++)
          addInstanceTrait(abc,inst.traits[t]);
 
-      for(int t=0;t<cinfo.traits.size();t++)
+      for(int t=0;t<(int)cinfo.traits.size();t++)
          addClassTrait(abc,cinfo.traits[t]);
    }
 
@@ -562,6 +1043,9 @@ public:
    {
       mScriptBase = 0;
       mScript = 0;
+      mConstructor = 0;
+      mStaticInit = 0;
+      mStaticInitDone = false;
 
       mConstructEmpty = 0;
       mConstructArgs = 0;
@@ -571,40 +1055,39 @@ public:
       mCanCast = 0;
       mStatics = Array_obj<String>::__new(0,0);
       mMembers = Array_obj<String>::__new(0,0);
+      mFieldDefaults = Array_obj<Dynamic>::__new(0,0);
+      mStaticValues = Array_obj<Dynamic>::__new(0,0);
    }
 
    void markFields(unsigned char *inData, HX_MARK_PARAMS)
    {
-      for(int i=0;i<mFields.size();i++)
+      for(int i=0;i<(int)mFields.size();i++)
       {
          FieldInfo &field = mFields[i];
          if (field.mType==FieldInfo::typeObject)
          {
-            HX_MARK_OBJECT( (*(hx::Object **)inData) );
+            HX_MARK_OBJECT( (*(hx::Object **)(inData+field.mOffset)) );
          }
          else if (field.mType==FieldInfo::typeString)
          {
-            HX_MARK_STRING( (*(String *)inData).__s );
+            HX_MARK_STRING( (*(String *)(inData+field.mOffset)).__s );
          }
-         inData += field.mBytes;
       }
    }
 
    void visitFields(unsigned char *inData, HX_VISIT_PARAMS)
    {
-      for(int i=0;i<mFields.size();i++)
+      for(int i=0;i<(int)mFields.size();i++)
       {
          FieldInfo &field = mFields[i];
          if (field.mType==FieldInfo::typeObject)
          {
-            HX_VISIT_OBJECT( (*(hx::Object **)inData) );
+            HX_VISIT_OBJECT( (*(hx::Object **)(inData+field.mOffset)) );
          }
          else if (field.mType==FieldInfo::typeString)
          {
-            HX_VISIT_STRING( (*(String *)inData).__s );
+            HX_VISIT_STRING( (*(String *)(inData+field.mOffset)).__s );
          }
-
-         inData += field.mBytes;
       }
    }
 
@@ -612,33 +1095,48 @@ public:
    {
       if (!mScript)
          return -1;
-      for(int i=0;i<mScript->mVTableEntries.size();i++)
+      for(int i=0;i<(int)mScript->mVTableEntries.size();i++)
          if (mScript->mVTableEntries[i]==inName)
             return i;
       return -1;
    }
 
+   static void setSlot(std::vector<int> &ioSlots,int inSlot,int inField)
+   {
+      if (inSlot<=0)
+         return;
+      if ((int)ioSlots.size()<=inSlot)
+         ioSlots.resize(inSlot+1,-1);
+      ioSlots[inSlot] = inField;
+   }
 
    void addInstanceTrait(ABC &abc, Trait &trait)
    {
-      String name = abc.getMultiName(trait.name);
+      String name = abc.getLocalName(trait.name);
       switch(trait.kind)
       {
          case Trait_Slot:
+         case Trait_Const:
             {
             int slot = trait.slot;
             String typeName = abc.getMultiName(trait.type);
-            FieldInfo field(name,typeName,mDataSize);
-            mDataSize += field.mBytes;
+            FieldInfo field(name,typeName,0);
+            int align = field.mBytes<8 ? 4 : 8;
+            field.mOffset = (mDataSize + align-1) & ~(align-1);
+            mDataSize = field.mOffset + field.mBytes;
             int fid = mFields.size();
             mFields.push_back(field);
             mFieldMap[name.__s] = fid;
+            setSlot(mSlotFields,slot,fid);
+            Dynamic init = trait.vkind==ConstantUndefined ? Dynamic() : abc.getConst(trait);
+            // Memory starts zeroed, which is already the default for everything else
+            if (init==null() && field.mType==FieldInfo::typeDouble)
+               init = Math_obj::NaN;
+            mFieldDefaults->push(init);
             DBGLOG(" var %s:%s %d\n", name.__s, typeName.__s, slot);
             }
             break;
          case Trait_Method:
-         case Trait_Getter:
-         case Trait_Setter:
             {
                Method *method = &abc.mMethods[trait.index];
                std::string sname(name.__s);
@@ -662,47 +1160,51 @@ public:
                }
             }
             break;
+         case Trait_Getter:
+            mGetterMap[name.__s] = &abc.mMethods[trait.index];
+            break;
+         case Trait_Setter:
+            mSetterMap[name.__s] = &abc.mMethods[trait.index];
+            break;
          case Trait_Class:
             DBGLOG(" class ?\n");
             break;
          case Trait_Function:
             DBGLOG(" function ?\n");
             break;
-         case Trait_Const:
-            {
-            DBGLOG(" const %s %s\n",name.__s, abc.getConst(trait)->toString().__s);
-            }
-            break;
       }
    }
 
 
    void addClassTrait(ABC &abc, Trait &trait)
    {
-      String name = abc.getMultiName(trait.name);
+      String name = abc.getLocalName(trait.name);
       switch(trait.kind)
       {
          case Trait_Slot:
+         case Trait_Const:
             {
             int slot = trait.slot;
             String typeName = abc.getMultiName(trait.type);
-            FieldInfo field(name,typeName,mDataSize);
-            mStaticData.resize( mStaticData.size() + field.mBytes );
+            FieldInfo field(name,typeName,0);
             int fid = mStaticFields.size();
             mStaticFields.push_back(field);
             mStaticFieldMap[name.__s] = fid;
+            setSlot(mStaticSlotFields,slot,fid);
+            mStaticValues->push( trait.vkind==ConstantUndefined ?
+                                    abcDefault(field.mType) : abc.getConst(trait) );
             DBGLOG(" static var %s:%s %d\n", name.__s, typeName.__s, slot);
             }
             break;
          case Trait_Method:
+            mStaticMethodMap[name.__s] = &abc.mMethods[trait.index];
+            DBGLOG(" static function %s\n", name.__s);
+            break;
          case Trait_Getter:
+            mStaticGetterMap[name.__s] = &abc.mMethods[trait.index];
+            break;
          case Trait_Setter:
-            {
-               std::string sname(name.__s);
-               Method *method = &abc.mMethods[trait.index];
-               mStaticMethodMap[sname] = method;
-               DBGLOG(" static function %s (%d)\n", name.__s, trait.kind);
-            }
+            mStaticSetterMap[name.__s] = &abc.mMethods[trait.index];
             break;
          case Trait_Class:
             DBGLOG(" static class ?\n");
@@ -710,20 +1212,113 @@ public:
          case Trait_Function:
             DBGLOG(" static function ?\n");
             break;
-         case Trait_Const:
-            {
-            DBGLOG(" static const %s %s\n",name.__s, abc.getConst(trait)->toString().__s);
-            }
-            break;
       }
    }
 
+   static Method *findMethod(MethodMap &inMap,const std::string &inName)
+   {
+      MethodMap::iterator i = inMap.find(inName);
+      return i==inMap.end() ? 0 : i->second;
+   }
+
+   ScriptMember findMember(const std::string &inName)
+   {
+      ScriptMember member;
+      FieldIndexMap::iterator field = mFieldMap.find(inName);
+      if (field!=mFieldMap.end())
+         member.field = field->second;
+      MethodIndexMap::iterator method = mMethodMap.find(inName);
+      if (method!=mMethodMap.end())
+         member.method = mMethods[method->second];
+      member.getter = findMethod(mGetterMap,inName);
+      member.setter = findMethod(mSetterMap,inName);
+      return member;
+   }
+
+   ScriptMember findStaticMember(const std::string &inName)
+   {
+      ScriptMember member;
+      FieldIndexMap::iterator field = mStaticFieldMap.find(inName);
+      if (field!=mStaticFieldMap.end())
+         member.field = field->second;
+      member.method = findMethod(mStaticMethodMap,inName);
+      member.getter = findMethod(mStaticGetterMap,inName);
+      member.setter = findMethod(mStaticSetterMap,inName);
+      return member;
+   }
+
+   // Members are fixed once the class is built, so lookups from script code are
+   //  remembered against the resolved name
+   const ScriptMember &findMember(const AbcName *inName)
+   {
+      AutoLock lock(mMemberCacheLock);
+      ScriptMemberCache::iterator i = mMemberCache.find(inName);
+      if (i!=mMemberCache.end())
+         return i->second;
+      ScriptMember &member = mMemberCache[inName] = findMember(std::string(inName->name.__s));
+      member.owner = this;
+      return member;
+   }
+
+   const ScriptMember &findStaticMember(const AbcName *inName)
+   {
+      AutoLock lock(mMemberCacheLock);
+      ScriptMemberCache::iterator i = mStaticMemberCache.find(inName);
+      if (i!=mStaticMemberCache.end())
+         return i->second;
+      ScriptMember &member = mStaticMemberCache[inName] = findStaticMember(std::string(inName->name.__s));
+      member.owner = this;
+      return member;
+   }
+
+   void runStaticInit()
+   {
+      if (mStaticInitDone || !mStaticInit)
+         return;
+      mStaticInitDone = true;
+      AbcValue self;
+      abcSetObject(self,this);
+      Interpret(mStaticInit,&self,0);
+   }
+
+   Dynamic __Field(const String &inName, bool inCallProp)
+   {
+      ScriptMember member = findStaticMember(std::string(inName.__s));
+      if (member.field>=0)
+         return mStaticValues[member.field];
+      if (member.getter)
+         return CallMethod(member.getter,this,0,0);
+      if (member.method)
+         return new ABCFunction(member.method,this);
+      return Class_obj::__Field(inName,inCallProp);
+   }
+
+   Dynamic __SetField(const String &inName,const Dynamic &inValue, bool inCallProp)
+   {
+      ScriptMember member = findStaticMember(std::string(inName.__s));
+      if (member.field>=0)
+         return mStaticValues[member.field] = abcCoerce(mStaticFields[member.field].mType,
+                                                        abcFromDynamic(inValue));
+      if (member.setter)
+      {
+         CallMethod(member.setter,this,&inValue,1);
+         return inValue;
+      }
+      return Class_obj::__SetField(inName,inValue,inCallProp);
+   }
+
+   bool __HasField(const String &inName)
+   {
+      return findStaticMember(std::string(inName.__s)).found() || Class_obj::__HasField(inName);
+   }
 
 
    void __Mark(hx::MarkContext *__inCtx)
    {
       Class_obj::__Mark(__inCtx);
       hx::MarkMember(mSuper,__inCtx);
+      hx::MarkMember(mFieldDefaults,__inCtx);
+      hx::MarkMember(mStaticValues,__inCtx);
    }
    void MarkStatics(hx::MarkContext *__inCtx)
    {
@@ -733,6 +1328,8 @@ public:
    {
       Class_obj::__Visit(__inCtx);
       hx::VisitMember(mSuper,__inCtx);
+      hx::VisitMember(mFieldDefaults,__inCtx);
+      hx::VisitMember(mStaticValues,__inCtx);
    }
    void VisitStatics(hx::VisitContext *__inCtx)
    {
@@ -741,14 +1338,32 @@ public:
    Dynamic ConstructEmpty()
    {
       unsigned char *data = mDataSize == 0 ? 0 : (unsigned char *)InternalNew(mDataSize,false);
+      for(int i=0;i<(int)mFields.size();i++)
+         if (mFieldDefaults[i]!=null())
+            mFields[i].mSetter(data+mFields[i].mOffset, mFieldDefaults[i]);
       hx::Object *result = mScript->mFactory((void **)mVTable, this, data);
       return result;
    }
+
+   // inArgs[0] receives the new object, followed by the constructor arguments
+   hx::Object *Construct(AbcValue *inArgs,int inArgCount)
+   {
+      hx::Object *result = ConstructEmpty().mPtr;
+      abcSetObject(inArgs[0],result);
+      if (mConstructor)
+         Interpret(mConstructor,inArgs,inArgCount);
+      return result;
+   }
+
    Dynamic ConstructArgs(hx::DynamicArray inArgs)
    {
-      unsigned char *data = mDataSize == 0 ? 0 : (unsigned char *)InternalNew(mDataSize,false);
-      hx::Object *result = mScript->mFactory((void **)mVTable, this, data);
-      result->__Construct(inArgs);
+      return ConstructArgs(inArgs->length ? &inArgs[0] : 0,inArgs->length);
+   }
+   Dynamic ConstructArgs(const Dynamic *inArgs,int inArgCount)
+   {
+      Dynamic result = ConstructEmpty();
+      if (mConstructor)
+         CallMethod(mConstructor,result.mPtr,inArgs,inArgCount);
       return result;
    }
    Dynamic ConstructEnum(String inName,hx::DynamicArray inArgs)
@@ -756,7 +1371,14 @@ public:
       return null();
    }
 
-   bool VCanCast(hx::Object *inPtr) { return false; }
+   bool VCanCast(hx::Object *inPtr)
+   {
+      for(ScriptHandler *handler = inPtr->__GetScriptHandler(); handler;
+           handler = hx::DynamicCast<ScriptHandler>(handler->mSuper.GetPtr()) )
+         if (handler==this)
+            return true;
+      return false;
+   }
 };
 
 typedef ScriptHandler ABCClass_obj;
@@ -845,7 +1467,7 @@ struct ABCReader
          setError("String too long");
       else
       {
-         s = String((char *)ptr,len).dup();
+         s = ConstString((const char *)ptr,len);
          ptr+=len;
          DBGLOG(" -> %s\n", s.__s);
       }
@@ -920,6 +1542,7 @@ struct ABCReader
 
    void read(Method &method)
    {
+      method.abc = &abc;
       method.paramCount = readInt();
       method.returnType = readInt();
       readFull(method.paramTypes,method.paramCount);
@@ -964,7 +1587,7 @@ struct ABCReader
    void read(MethodBody &body)
    {
       body.method = readInt();
-      if (body.method<0 || body.method>=abc.mMethods.size())
+      if (body.method<0 || body.method>=(int)abc.mMethods.size())
          setError("Bad method link");
       if (abc.mMethods[body.method].body!=0)
          setError("Duplicate method link");
@@ -1126,161 +1749,1820 @@ struct ABCReader
 
 };
 
+// Script level names - the vars, functions and classes of the scripts, then registered
+//  classes found through the namespaces of a name
 class ABCGlobalObject : public hx::Object
 {
 public:
    ABC *abc;
+   Array<Dynamic>        mValues;
+   std::vector<Method *> mFunctions;  // script function still held in each slot
+   std::vector<int>      mSlotIds;
+   FieldIndexMap         mSlotMap;
 
    ABCGlobalObject(ABC *inAbc) : abc(inAbc)
    {
+      mValues = Array_obj<Dynamic>::__new(0,0);
    }
-   Dynamic __Field(const String &inName, bool inCallProp)
+
+   int find(const std::string &inName)
    {
-      return Class_obj::Resolve(RemapFlash(inName));
+      FieldIndexMap::iterator i = mSlotMap.find(inName);
+      return i==mSlotMap.end() ? -1 : i->second;
    }
-   bool __HasField(const String &inName)
+
+   int add(const std::string &inName)
    {
-      Class clazz = Class_obj::Resolve(RemapFlash(inName));
-      return clazz.mPtr;
+      int slot = find(inName);
+      if (slot<0)
+      {
+         slot = mValues->length;
+         mValues->push(null());
+         mFunctions.push_back(0);
+         mSlotMap[inName] = slot;
+      }
+      return slot;
    }
 
-
-};
-
-
-class ABCContext
-{
-public:
-   Array<Dynamic> stack;
-   Array<Dynamic> scope;
-   ABCGlobalObject *global;
-
-   ABCContext(ABCGlobalObject *inGlobal)
+   void setSlotId(int inSlotId,int inSlot)
    {
-      GCAddRoot((hx::Object**)&stack.mPtr);
-      GCAddRoot((hx::Object**)&scope.mPtr);
-      GCAddRoot((hx::Object**)&global);
-      stack = Array_obj<Dynamic>::__new(0,0);
-      scope = Array_obj<Dynamic>::__new(0,0);
-      global = inGlobal;
-      scope->push(global);
+      if (inSlotId<=0)
+         return;
+      if ((int)mSlotIds.size()<=inSlotId)
+         mSlotIds.resize(inSlotId+1,-1);
+      mSlotIds[inSlotId] = inSlot;
    }
-   ~ABCContext()
+
+   int slotFromId(int inSlotId)
    {
-      GCRemoveRoot((hx::Object**)&stack.mPtr);
-      GCRemoveRoot((hx::Object**)&scope.mPtr);
-      GCRemoveRoot((hx::Object**)&global);
+      int slot = inSlotId>0 && inSlotId<(int)mSlotIds.size() ? mSlotIds[inSlotId] : -1;
+      if (slot<0)
+         hx::Throw( HX_CSTRING("Bad global slot") );
+      return slot;
    }
 
-   inline void pushThis(hx::Object *inObj)
+   void set(int inSlot,const Dynamic &inValue)
    {
-      stack->push(inObj ? inObj : global);
+      mValues[inSlot] = inValue;
+      mFunctions[inSlot] = 0;
    }
 
-   inline void push(Dynamic inValue)
+   void setFunction(int inSlot,Method *inMethod)
    {
-      stack->push(inValue);
+      mValues[inSlot] = new ABCFunction(inMethod,this);
+      mFunctions[inSlot] = inMethod;
    }
 
-   inline void pushScope(Dynamic inValue)
+   // Classes are stored under their local name once found, and slots never move, so
+   //  the slot is remembered on the name
+   int lookup(AbcName *inName)
    {
-      DBGLOG("   push %p\n", inValue.mPtr);
-      scope->push(inValue);
+      if (inName->globalSlot>=0)
+         return inName->globalSlot;
+      if (!inName->name.__s)
+         return -1;
+      int slot = find(inName->name.__s);
+      for(int q=0; slot<0 && q<(int)inName->qnames.size(); q++)
+      {
+         Class cls = Class_obj::Resolve(inName->qnames[q]);
+         if (cls.mPtr)
+         {
+            slot = add(inName->name.__s);
+            mValues[slot] = cls;
+         }
+      }
+      if (slot>=0)
+         inName->globalSlot = slot;
+      return slot;
    }
 
-   int getU30(const unsigned char *&pc)
+   Dynamic __Field(const String &inName, bool inCallProp)
    {
-      int a = *pc++;
-      if( a < 128 )
-         return a;
-      a &= 0x7F;
-      int b = *pc++;
-      if( b < 128 )
-         return (b << 7) | a;
-      b &= 0x7F;
-      int c = *pc++;
-      if( c < 128 )
-         return (c << 14) | (b << 7) | a;
-      c &= 0x7F;
-      int d = *pc++;
-      if( d < 128 )
-         return (d << 21) | (c << 14) | (b << 7) | a;
-      d &= 0x7F;
-      int e = *pc++;
-      if( e > 15 )
-         return 0; // ???
-      return (e << 28) | (d << 21) | (c << 14) | (b << 7) | a;
+      int slot = find(inName.__s);
+      if (slot>=0)
+         return mValues[slot];
+      return Class_obj::Resolve(RemapFlash(inName));
+   }
+   Dynamic __SetField(const String &inName,const Dynamic &inValue,bool inCallProp)
+   {
+      set(add(inName.__s),inValue);
+      return inValue;
+   }
+   bool __HasField(const String &inName)
+   {
+      if (find(inName.__s)>=0)
+         return true;
+      Class clazz = Class_obj::Resolve(RemapFlash(inName));
+      return clazz.mPtr;
+   }
+   String toString() { return HX_CSTRING("global"); }
+
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_MEMBER(mValues); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER(mValues); }
+   #endif
+};
+
+
+// Scope holding the variable of a catch block, in slot 1
+class ABCCatchScope : public hx::Object
+{
+public:
+   ABCCatchScope(const String &inName) : mName(inName) { }
+
+   Dynamic __Field(const String &inName, bool inCallProp)
+   {
+      return inName==mName ? mValue : Dynamic();
+   }
+   Dynamic __SetField(const String &inName,const Dynamic &inValue,bool inCallProp)
+   {
+      if (inName==mName)
+         mValue = inValue;
+      return inValue;
+   }
+   bool __HasField(const String &inName) { return inName==mName; }
+
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_MEMBER(mValue); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER(mValue); }
+   #endif
+
+   String  mName;
+   Dynamic mValue;
+};
+
+
+// --- Instruction stream ----------------------------------------------------------
+//
+// Each method body is decoded once, on its first call, into fixed size instructions:
+//  operands are read and range checked, constants and multinames resolved, and branch
+//  targets turned into instruction indices.  Debug and no-op instructions are dropped,
+//  and the getlocal_n/setlocal_n and typed push/convert forms folded together.
+
+#define ABC_IOPS \
+   ABC_IOP(PushNull) ABC_IOP(PushTrue) ABC_IOP(PushFalse) ABC_IOP(PushInt) \
+   ABC_IOP(PushDouble) ABC_IOP(PushString) ABC_IOP(Pop) ABC_IOP(Dup) ABC_IOP(Swap) \
+   ABC_IOP(GetLocal) ABC_IOP(SetLocal) ABC_IOP(Kill) ABC_IOP(IncLocal) ABC_IOP(DecLocal) \
+   ABC_IOP(IncLocalI) ABC_IOP(DecLocalI) \
+   ABC_IOP(Add) ABC_IOP(Subtract) ABC_IOP(Multiply) ABC_IOP(Divide) ABC_IOP(Modulo) \
+   ABC_IOP(Negate) ABC_IOP(Increment) ABC_IOP(Decrement) \
+   ABC_IOP(AddI) ABC_IOP(SubtractI) ABC_IOP(MultiplyI) ABC_IOP(NegateI) \
+   ABC_IOP(IncrementI) ABC_IOP(DecrementI) \
+   ABC_IOP(BitAnd) ABC_IOP(BitOr) ABC_IOP(BitXor) ABC_IOP(BitNot) \
+   ABC_IOP(LShift) ABC_IOP(RShift) ABC_IOP(URShift) \
+   ABC_IOP(Not) ABC_IOP(Equals) ABC_IOP(StrictEquals) ABC_IOP(LessThan) \
+   ABC_IOP(LessEquals) ABC_IOP(GreaterThan) ABC_IOP(GreaterEquals) \
+   ABC_IOP(Jump) ABC_IOP(IfTrue) ABC_IOP(IfFalse) ABC_IOP(IfEq) ABC_IOP(IfNe) \
+   ABC_IOP(IfStrictEq) ABC_IOP(IfStrictNe) ABC_IOP(IfLt) ABC_IOP(IfLe) ABC_IOP(IfGt) \
+   ABC_IOP(IfGe) ABC_IOP(IfNlt) ABC_IOP(IfNle) ABC_IOP(IfNgt) ABC_IOP(IfNge) \
+   ABC_IOP(LookupSwitch) \
+   ABC_IOP(ConvertI) ABC_IOP(ConvertU) ABC_IOP(ConvertD) ABC_IOP(ConvertB) \
+   ABC_IOP(ConvertS) ABC_IOP(CoerceS) \
+   ABC_IOP(PushScope) ABC_IOP(PopScope) ABC_IOP(GetScopeObject) ABC_IOP(GetGlobalScope) \
+   ABC_IOP(FindProperty) ABC_IOP(FindPropStrict) ABC_IOP(GetLex) \
+   ABC_IOP(GetProperty) ABC_IOP(SetProperty) ABC_IOP(GetPropertyL) ABC_IOP(SetPropertyL) \
+   ABC_IOP(GetSlot) ABC_IOP(SetSlot) \
+   ABC_IOP(CallProperty) ABC_IOP(CallPropVoid) ABC_IOP(Call) \
+   ABC_IOP(Construct) ABC_IOP(ConstructProp) ABC_IOP(ConstructSuper) \
+   ABC_IOP(NewArray) ABC_IOP(NewObject) ABC_IOP(NewClass) ABC_IOP(NewCatch) \
+   ABC_IOP(TypeOf) ABC_IOP(Throw) ABC_IOP(ReturnValue) ABC_IOP(ReturnVoid)
+
+enum AbcInternalOp
+{
+   #define ABC_IOP(name) iop##name,
+   ABC_IOPS
+   #undef ABC_IOP
+};
+
+struct AbcInstr
+{
+   const void *label;   // handler address, once threaded
+   int        op;
+   int        a;        // local, constant, argument count, target, slot or class
+   int        b;        // string length or switch size
+   AbcName    *name;
+   void       *cache;   // ScriptMember last resolved here, swapped in whole
+   union
+   {
+      double        d;
+      const HX_CHAR *s;
+   };
+};
+
+struct AbcHandler
+{
+   int     from;
+   int     to;
+   int     target;
+   AbcName *type;
+   AbcName *var;
+};
+
+struct AbcCode
+{
+   std::vector<AbcInstr>   instrs;
+   std::vector<AbcHandler> handlers;
+   std::vector<int>        switchTargets;  // default then cases, for each lookupswitch
+   int  localCount;
+   int  maxStack;
+   int  maxScope;
+};
+
+static AbcValue abcConst(ABC &abc,int inKind,int inIndex)
+{
+   AbcValue v;
+   switch(inKind)
+   {
+      case ConstantInt: abcSetInt(v,abc.mInts[inIndex]); break;
+      case ConstantUInt: abcSetUInt(v,abc.mUInts[inIndex]); break;
+      case ConstantDouble: abcSetDouble(v,abc.mDoubles[inIndex]); break;
+      case ConstantUtf8: abcSetString(v,abc.mStrings[inIndex]); break;
+      case ConstantTrue: abcSetBool(v,true); break;
+      case ConstantFalse: abcSetBool(v,false); break;
+      default: abcSetNull(v);
+   }
+   return v;
+}
+
+
+// Frames hold the locals, operand stack and scopes.  The sizes in the ABC are only
+//  trusted up to ABC_MAX_FRAME_SLOTS each, and a frame can be no bigger than
+//  ABC_MAX_FRAME_BYTES.  Frames up to ABC_STACK_FRAME_BYTES go on the C stack.
+enum { ABC_MAX_FRAME_SLOTS = 0xffff, ABC_MAX_FRAME_BYTES = 1<<20, ABC_STACK_FRAME_BYTES = 16384 };
+
+static int abcFrameValues(const AbcCode &inCode) { return inCode.localCount + inCode.maxStack; }
+
+static int abcFrameBytes(const AbcCode &inCode)
+{
+   return abcFrameValues(inCode)*sizeof(AbcValue) + inCode.maxScope*sizeof(hx::Object *);
+}
+
+
+struct ABCDecoder
+{
+   ABC        &abc;
+   Method     &method;
+   MethodBody &body;
+   const unsigned char *start;
+   const unsigned char *pc;
+   const unsigned char *end;
+   AbcCode    code;
+   std::vector<int> instrAt;    // byte offset -> instruction
+   std::vector<int> branches;   // instructions whose target is still a byte offset
+   int        usedLocals;
+
+   ABCDecoder(Method &inMethod) : abc(*inMethod.abc), method(inMethod), body(*inMethod.body)
+   {
+      start = pc = body.code.size() ? &body.code[0] : 0;
+      end = start + body.code.size();
+   }
+
+   void error(const char *inMessage)
+   {
+      hx::Throw( String(inMessage,strlen(inMessage)).dup() );
+   }
+
+   void unsupported(int inOp)
+   {
+      String name(sOpCodeNames[inOp],strlen(sOpCodeNames[inOp]));
+      hx::Throw( HX_CSTRING("Unsupported ABC op ") + name );
+   }
+
+   int readByte()
+   {
+      if (pc>=end)
+         error("Truncated ABC code");
+      return *pc++;
+   }
+
+   int readU30()
+   {
+      int result = 0;
+      for(int shift=0; shift<35; shift+=7)
+      {
+         int b = readByte();
+         result |= (b & 0x7f) << shift;
+         if (b<128)
+            return result;
+      }
+      error("Bad integer encoding");
+      return 0;
+   }
+
+   int readS24()
+   {
+      int b0 = readByte();
+      int b1 = readByte();
+      int b2 = readByte();
+      int result = b0 | (b1<<8) | (b2<<16);
+      return (result & 0x800000) ? result - 0x1000000 : result;
+   }
+
+   int readIndex(int inSize)
+   {
+      int index = readU30();
+      if (index<=0 || index>=inSize)
+         error("Bad constant index");
+      return index;
+   }
+
+   int readLocal()
+   {
+      return local(readU30());
+   }
+
+   int local(int inIndex)
+   {
+      if (inIndex<0 || inIndex>=code.localCount)
+         error("Bad local register");
+      if (inIndex>=usedLocals)
+         usedLocals = inIndex+1;
+      return inIndex;
+   }
+
+   AbcName *readName(bool inAllowRuntime)
+   {
+      AbcName *name = &abc.mNames[ readIndex(abc.mNames.size()) ];
+      if (name->unsupported || (name->runtime && !inAllowRuntime))
+         error("Unsupported multiname kind");
+      return name;
+   }
+
+   AbcInstr &emit(int inOp)
+   {
+      code.instrs.push_back(AbcInstr());
+      AbcInstr &instr = code.instrs.back();
+      memset(&instr,0,sizeof(instr));
+      instr.op = inOp;
+      return instr;
+   }
+
+   void emitBranch(int inOp)
+   {
+      int offset = readS24();
+      emit(inOp).a = (int)(pc-start) + offset;
+      branches.push_back(code.instrs.size()-1);
+   }
+
+   void emitNamed(int inOp,int inRuntimeOp)
+   {
+      AbcName *name = readName(inRuntimeOp>=0);
+      emit(name->runtime ? inRuntimeOp : inOp).name = name;
+   }
+
+   void emitCall(int inOp,bool inNamed)
+   {
+      AbcName *name = inNamed ? readName(false) : 0;
+      AbcInstr &instr = emit(inOp);
+      instr.name = name;
+      instr.a = readU30();
+   }
+
+   int target(int inOffset)
+   {
+      if (inOffset<0 || inOffset>(int)body.code.size() || instrAt[inOffset]<0)
+         error("Bad branch target");
+      return instrAt[inOffset];
+   }
+
+   AbcCode *decode()
+   {
+      if (method.flags & (NEED_ARGUMENTS|NEED_ACTIVATION|NEED_REST))
+         error("Unsupported method - needs arguments, activation or rest");
+
+      if (body.localCount<0 || body.localCount>ABC_MAX_FRAME_SLOTS ||
+          body.maxStack<0 || body.maxStack>ABC_MAX_FRAME_SLOTS ||
+          body.maxScopeDepth<0 || body.maxScopeDepth>ABC_MAX_FRAME_SLOTS ||
+          method.paramCount<0 || method.paramCount>=ABC_MAX_FRAME_SLOTS)
+         error("Bad frame size");
+      code.localCount = body.localCount > method.paramCount ? body.localCount : method.paramCount+1;
+      usedLocals = method.paramCount+1;
+      // A catch handler starts with the exception as its only stack entry
+      code.maxStack = body.maxStack>0 ? body.maxStack : 1;
+      code.maxScope = body.maxScopeDepth>0 ? body.maxScopeDepth : 1;
+      instrAt.resize(body.code.size()+1,-1);
+
+      while(pc<end)
+      {
+         // Dropped instructions map to whatever follows them
+         instrAt[pc-start] = code.instrs.size();
+         int op = *pc++;
+         switch(op)
+         {
+            case op_nop: case op_label: case op_bkpt:
+            case op_coerce_a: case op_convert_o: case op_coerce_o:
+               break;
+            case op_debugline: case op_debugfile: case op_bkptline:
+               readU30();
+               break;
+            case op_debug:
+               readByte(); readU30(); readByte(); readU30();
+               break;
+            case op_coerce:
+               readU30();
+               break;
+
+            case op_pushnull: case op_pushundefined: emit(iopPushNull); break;
+            case op_pushtrue: emit(iopPushTrue); break;
+            case op_pushfalse: emit(iopPushFalse); break;
+            case op_pushbyte: emit(iopPushInt).a = (signed char)readByte(); break;
+            case op_pushshort: emit(iopPushInt).a = (short)readU30(); break;
+            case op_pushint: emit(iopPushInt).a = abc.mInts[ readIndex(abc.mInts.size()) ]; break;
+            case op_pushuint:
+               {
+               unsigned int value = abc.mUInts[ readIndex(abc.mUInts.size()) ];
+               if (value<=INT_MAX)
+                  emit(iopPushInt).a = (int)value;
+               else
+                  emit(iopPushDouble).d = value;
+               }
+               break;
+            case op_pushdouble: emit(iopPushDouble).d = abc.mDoubles[ readIndex(abc.mDoubles.size()) ]; break;
+            case op_pushnan: emit(iopPushDouble).d = Math_obj::NaN; break;
+            case op_pushstring:
+               {
+               String &s = abc.mStrings[ readIndex(abc.mStrings.size()) ];
+               AbcInstr &instr = emit(iopPushString);
+               instr.s = s.__s;
+               instr.b = s.length;
+               }
+               break;
+            case op_pop: emit(iopPop); break;
+            case op_dup: emit(iopDup); break;
+            case op_swap: emit(iopSwap); break;
+
+            case op_getlocal: emit(iopGetLocal).a = readLocal(); break;
+            case op_getlocal_0: case op_getlocal_1: case op_getlocal_2: case op_getlocal_3:
+               emit(iopGetLocal).a = local(op-op_getlocal_0);
+               break;
+            case op_setlocal: emit(iopSetLocal).a = readLocal(); break;
+            case op_setlocal_0: case op_setlocal_1: case op_setlocal_2: case op_setlocal_3:
+               emit(iopSetLocal).a = local(op-op_setlocal_0);
+               break;
+            case op_kill: emit(iopKill).a = readLocal(); break;
+            case op_inclocal: emit(iopIncLocal).a = readLocal(); break;
+            case op_declocal: emit(iopDecLocal).a = readLocal(); break;
+            case op_inclocal_i: emit(iopIncLocalI).a = readLocal(); break;
+            case op_declocal_i: emit(iopDecLocalI).a = readLocal(); break;
+
+            case op_add: emit(iopAdd); break;
+            case op_subtract: emit(iopSubtract); break;
+            case op_multiply: emit(iopMultiply); break;
+            case op_divide: emit(iopDivide); break;
+            case op_modulo: emit(iopModulo); break;
+            case op_negate: emit(iopNegate); break;
+            case op_increment: emit(iopIncrement); break;
+            case op_decrement: emit(iopDecrement); break;
+            case op_add_i: emit(iopAddI); break;
+            case op_subtract_i: emit(iopSubtractI); break;
+            case op_multiply_i: emit(iopMultiplyI); break;
+            case op_negate_i: emit(iopNegateI); break;
+            case op_increment_i: emit(iopIncrementI); break;
+            case op_decrement_i: emit(iopDecrementI); break;
+            case op_bitand: emit(iopBitAnd); break;
+            case op_bitor: emit(iopBitOr); break;
+            case op_bitxor: emit(iopBitXor); break;
+            case op_bitnot: emit(iopBitNot); break;
+            case op_lshift: emit(iopLShift); break;
+            case op_rshift: emit(iopRShift); break;
+            case op_urshift: emit(iopURShift); break;
+            case op_not: emit(iopNot); break;
+            case op_equals: emit(iopEquals); break;
+            case op_strictequals: emit(iopStrictEquals); break;
+            case op_lessthan: emit(iopLessThan); break;
+            case op_lessequals: emit(iopLessEquals); break;
+            case op_greaterthan: emit(iopGreaterThan); break;
+            case op_greaterequals: emit(iopGreaterEquals); break;
+
+            case op_jump: emitBranch(iopJump); break;
+            case op_iftrue: emitBranch(iopIfTrue); break;
+            case op_iffalse: emitBranch(iopIfFalse); break;
+            case op_ifeq: emitBranch(iopIfEq); break;
+            case op_ifne: emitBranch(iopIfNe); break;
+            case op_ifstricteq: emitBranch(iopIfStrictEq); break;
+            case op_ifstrictne: emitBranch(iopIfStrictNe); break;
+            case op_iflt: emitBranch(iopIfLt); break;
+            case op_ifle: emitBranch(iopIfLe); break;
+            case op_ifgt: emitBranch(iopIfGt); break;
+            case op_ifge: emitBranch(iopIfGe); break;
+            case op_ifnlt: emitBranch(iopIfNlt); break;
+            case op_ifnle: emitBranch(iopIfNle); break;
+            case op_ifngt: emitBranch(iopIfNgt); break;
+            case op_ifnge: emitBranch(iopIfNge); break;
+            case op_lookupswitch:
+               {
+               // Offsets are relative to the lookupswitch itself
+               int base = (int)(pc-start) - 1;
+               int first = code.switchTargets.size();
+               code.switchTargets.push_back(base + readS24());
+               int cases = readU30() + 1;
+               for(int c=0;c<cases;c++)
+                  code.switchTargets.push_back(base + readS24());
+               AbcInstr &instr = emit(iopLookupSwitch);
+               instr.a = first;
+               instr.b = cases;
+               }
+               break;
+
+            case op_convert_i: case op_coerce_i: emit(iopConvertI); break;
+            case op_convert_u: case op_coerce_u: emit(iopConvertU); break;
+            case op_convert_d: case op_coerce_d: emit(iopConvertD); break;
+            case op_convert_b: case op_coerce_b: emit(iopConvertB); break;
+            case op_convert_s: emit(iopConvertS); break;
+            case op_coerce_s: emit(iopCoerceS); break;
+
+            case op_pushscope: case op_pushwith: emit(iopPushScope); break;
+            case op_popscope: emit(iopPopScope); break;
+            case op_getscopeobject:
+               {
+               int index = readByte();
+               if (index>=code.maxScope)
+                  error("Bad scope index");
+               emit(iopGetScopeObject).a = index;
+               }
+               break;
+            case op_getglobalscope: emit(iopGetGlobalScope); break;
+
+            case op_findproperty: emitNamed(iopFindProperty,-1); break;
+            case op_findpropstrict: emitNamed(iopFindPropStrict,-1); break;
+            case op_getlex: emitNamed(iopGetLex,-1); break;
+            case op_getproperty: emitNamed(iopGetProperty,iopGetPropertyL); break;
+            case op_setproperty: case op_initproperty:
+               emitNamed(iopSetProperty,iopSetPropertyL);
+               break;
+            case op_getslot: emit(iopGetSlot).a = readU30(); break;
+            case op_setslot: emit(iopSetSlot).a = readU30(); break;
+
+            case op_callproperty: case op_callproplex: emitCall(iopCallProperty,true); break;
+            case op_callpropvoid: emitCall(iopCallPropVoid,true); break;
+            case op_call: emitCall(iopCall,false); break;
+            case op_construct: emitCall(iopConstruct,false); break;
+            case op_constructprop: emitCall(iopConstructProp,true); break;
+            case op_constructsuper: emitCall(iopConstructSuper,false); break;
+            case op_newarray: emit(iopNewArray).a = readU30(); break;
+            case op_newobject: emit(iopNewObject).a = readU30(); break;
+            case op_newclass:
+               {
+               int index = readU30();
+               // Checked against the class infos, since methods are decoded before the
+               //  classes are registered
+               if (index<0 || index>=(int)abc.mInstanceInfo.size())
+                  error("Bad class index");
+               emit(iopNewClass).a = index;
+               }
+               break;
+            case op_newcatch:
+               {
+               int index = readU30();
+               if (index<0 || index>=(int)body.exception.size())
+                  error("Bad exception index");
+               emit(iopNewCatch).a = index;
+               }
+               break;
+
+            case op_typeof_op: emit(iopTypeOf); break;
+            case op_throw_op: emit(iopThrow); break;
+            case op_returnvalue: emit(iopReturnValue); break;
+            case op_returnvoid: emit(iopReturnVoid); break;
+
+            default:
+               unsupported(op);
+         }
+      }
+      // Running off the end returns
+      instrAt[body.code.size()] = code.instrs.size();
+      emit(iopReturnVoid);
+
+      for(int b=0;b<(int)branches.size();b++)
+      {
+         AbcInstr &instr = code.instrs[ branches[b] ];
+         instr.a = target(instr.a);
+      }
+      for(int s=0;s<(int)code.switchTargets.size();s++)
+         code.switchTargets[s] = target(code.switchTargets[s]);
+
+      for(int e=0;e<(int)body.exception.size();e++)
+      {
+         ExceptionInfo &info = body.exception[e];
+         AbcHandler handler;
+         handler.from = target(info.from);
+         handler.to = target(info.to);
+         handler.target = target(info.target);
+         handler.type = info.excType>0 && info.excType<(int)abc.mNames.size() ? &abc.mNames[info.excType] : 0;
+         handler.var = info.varName>0 && info.varName<(int)abc.mNames.size() ? &abc.mNames[info.varName] : 0;
+         code.handlers.push_back(handler);
+      }
+
+      verify();
+      // The frame only needs what the code can reach, whatever the header declares
+      code.localCount = usedLocals;
+      code.maxStack = maxStackAt>0 ? maxStackAt : 1;
+      code.maxScope = maxScopeAt>0 ? maxScopeAt : 1;
+      if (abcFrameBytes(code)>ABC_MAX_FRAME_BYTES)
+         error("Method frame too large");
+      return new AbcCode(code);
+   }
+
+   // As the AVM verifier does, track the operand and scope stack depths along every
+   //  path: they must agree where paths meet and stay within maxStack and maxScope,
+   //  since the interpreter does not check them.
+   std::vector<int> stackAt;
+   std::vector<int> scopeAt;
+   std::vector<int> work;
+   int maxStackAt;
+   int maxScopeAt;
+
+   void flow(int inInstr,int inStack,int inScope)
+   {
+      if (stackAt[inInstr]<0)
+      {
+         stackAt[inInstr] = inStack;
+         scopeAt[inInstr] = inScope;
+         if (inStack>maxStackAt)
+            maxStackAt = inStack;
+         if (inScope>maxScopeAt)
+            maxScopeAt = inScope;
+         work.push_back(inInstr);
+      }
+      else if (stackAt[inInstr]!=inStack || scopeAt[inInstr]!=inScope)
+         error("Inconsistent stack depth");
+   }
+
+   void verify()
+   {
+      stackAt.resize(code.instrs.size(),-1);
+      scopeAt.resize(code.instrs.size(),-1);
+      maxStackAt = maxScopeAt = 0;
+      flow(0,0,0);
+      // A handler is entered with the exception on an otherwise empty stack
+      for(int h=0;h<(int)code.handlers.size();h++)
+         flow(code.handlers[h].target,1,0);
+
+      while(work.size())
+      {
+         int i = work.back();
+         work.pop_back();
+         AbcInstr &instr = code.instrs[i];
+         int pop = 0;
+         int push = 0;
+         int scope = scopeAt[i];
+         bool next = true;
+         switch(instr.op)
+         {
+            case iopPushNull: case iopPushTrue: case iopPushFalse: case iopPushInt:
+            case iopPushDouble: case iopPushString: case iopGetLocal:
+            case iopGetGlobalScope: case iopFindProperty: case iopFindPropStrict:
+            case iopGetLex: case iopNewCatch:
+               push = 1;
+               break;
+            case iopGetScopeObject:
+               if (instr.a>=scope)
+                  error("Bad scope index");
+               push = 1;
+               break;
+            case iopPop: case iopSetLocal:
+               pop = 1;
+               break;
+            case iopDup: pop = 1; push = 2; break;
+            case iopSwap: pop = 2; push = 2; break;
+            case iopKill: case iopIncLocal: case iopDecLocal: case iopIncLocalI: case iopDecLocalI:
+               break;
+
+            case iopAdd: case iopSubtract: case iopMultiply: case iopDivide: case iopModulo:
+            case iopAddI: case iopSubtractI: case iopMultiplyI:
+            case iopBitAnd: case iopBitOr: case iopBitXor:
+            case iopLShift: case iopRShift: case iopURShift:
+            case iopEquals: case iopStrictEquals: case iopLessThan: case iopLessEquals:
+            case iopGreaterThan: case iopGreaterEquals: case iopGetPropertyL:
+               pop = 2; push = 1;
+               break;
+            case iopNegate: case iopIncrement: case iopDecrement: case iopNegateI:
+            case iopIncrementI: case iopDecrementI: case iopBitNot: case iopNot:
+            case iopConvertI: case iopConvertU: case iopConvertD: case iopConvertB:
+            case iopConvertS: case iopCoerceS: case iopGetProperty: case iopGetSlot:
+            case iopNewClass: case iopTypeOf:
+               pop = 1; push = 1;
+               break;
+
+            case iopJump: next = false; break;
+            case iopIfTrue: case iopIfFalse: pop = 1; break;
+            case iopIfEq: case iopIfNe: case iopIfStrictEq: case iopIfStrictNe:
+            case iopIfLt: case iopIfLe: case iopIfGt: case iopIfGe:
+            case iopIfNlt: case iopIfNle: case iopIfNgt: case iopIfNge:
+               pop = 2;
+               break;
+            case iopLookupSwitch: pop = 1; next = false; break;
+
+            case iopPushScope: pop = 1; scope++; break;
+            case iopPopScope: scope--; break;
+
+            case iopSetProperty: case iopSetSlot: pop = 2; break;
+            case iopSetPropertyL: pop = 3; break;
+
+            case iopCallProperty: case iopConstruct: case iopConstructProp:
+               pop = instr.a + 1; push = 1;
+               break;
+            case iopCallPropVoid: case iopConstructSuper: pop = instr.a + 1; break;
+            case iopCall: pop = instr.a + 2; push = 1; break;
+            case iopNewArray: pop = instr.a; push = 1; break;
+            case iopNewObject: pop = instr.a*2; push = 1; break;
+
+            case iopThrow: case iopReturnValue: pop = 1; next = false; break;
+            case iopReturnVoid: next = false; break;
+         }
+
+         if (pop<0 || stackAt[i]<pop)
+            error("Stack underflow");
+         int stack = stackAt[i] - pop + push;
+         if (stack>code.maxStack)
+            error("Stack overflow");
+         if (scope<0)
+            error("Scope stack underflow");
+         if (scope>code.maxScope)
+            error("Scope stack overflow");
+
+         if (next)
+            flow(i+1,stack,scope);
+         if (instr.op>=iopJump && instr.op<=iopIfNge)
+            flow(instr.a,stack,scope);
+         else if (instr.op==iopLookupSwitch)
+            for(int t=0;t<=instr.b;t++)
+               flow(code.switchTargets[instr.a+t],stack,scope);
+      }
+   }
+};
+
+
+// --- Interpreter -----------------------------------------------------------------
+//
+// Locals, operand stack and scope stack live in one block on the C stack, which the
+//  collector scans conservatively, so values are held unboxed.  Calls between script
+//  methods pass their arguments straight from the caller's operand stack.
+
+struct AbcFrame
+{
+   Method          *method;
+   ABCGlobalObject *global;
+   AbcCode         *code;
+   AbcValue        *locals;
+   AbcValue        *stack;
+   hx::Object      **scope;
+   // Where to (re)start, and the instruction that threw
+   int             ip;
+   int             sp;
+   int             scopeDepth;
+};
+
+static void abcNullReference(AbcName *inName)
+{
+   String name = inName && inName->name.__s ? inName->name : HX_CSTRING("?");
+   hx::Throw( HX_CSTRING("Cannot access property ") + name + HX_CSTRING(" of a null object") );
+}
+
+static bool abcHasProperty(AbcFrame &f,hx::Object *inObj,AbcName *inName)
+{
+   if (inObj==f.global)
+      return f.global->lookup(inName)>=0;
+   ScriptHandler *handler = inObj->__GetScriptHandler();
+   if (handler && handler->findMember(inName).found())
+      return true;
+   ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(inObj);
+   if (cls)
+      return cls->findStaticMember(inName).found();
+   return inObj->__HasField(inName->name);
+}
+
+static hx::Object *abcFindProperty(AbcFrame &f,hx::Object **inScopeTop,AbcName *inName,bool inStrict)
+{
+   for(hx::Object **s = inScopeTop-1; s>=f.scope; s--)
+      if (abcHasProperty(f,*s,inName))
+         return *s;
+   if (inStrict && f.global->lookup(inName)<0)
+      hx::Throw( HX_CSTRING("Variable ") + inName->name + HX_CSTRING(" is not defined") );
+   return f.global;
+}
+
+// ioCache, when given, remembers script instance fields for the next time
+static void abcGetProperty(AbcFrame &f,AbcName *inName,const AbcValue &inObj,AbcValue &outValue,
+                           AbcInstr *ioCache)
+{
+   AbcValue object = inObj;
+   if (object.type==avObject)
+   {
+      hx::Object *obj = object.o;
+      ScriptHandler *handler = obj->__GetScriptHandler();
+      if (handler)
+      {
+         const ScriptMember &member = handler->findMember(inName);
+         if (member.field>=0)
+         {
+            if (ioCache)
+               HxAtomicStoreReleasePtr(&ioCache->cache,(void *)&member);
+            abcGetField(handler->mFields[member.field],obj->__GetScriptData(),outValue);
+            return;
+         }
+         if (member.getter)
+         {
+            outValue = Interpret(member.getter,&object,0);
+            return;
+         }
+         if (member.method)
+         {
+            abcSetObject(outValue,new ABCFunction(member.method,obj));
+            return;
+         }
+      }
+      else if (obj==f.global)
+      {
+         int slot = f.global->lookup(inName);
+         if (slot>=0)
+         {
+            outValue = abcFromDynamic(f.global->mValues[slot]);
+            return;
+         }
+      }
+      else
+      {
+         ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(obj);
+         if (cls)
+         {
+            const ScriptMember &member = cls->findStaticMember(inName);
+            if (member.field>=0)
+            {
+               outValue = abcFromDynamic(cls->mStaticValues[member.field]);
+               return;
+            }
+            if (member.getter)
+            {
+               outValue = Interpret(member.getter,&object,0);
+               return;
+            }
+            if (member.method)
+            {
+               abcSetObject(outValue,new ABCFunction(member.method,obj));
+               return;
+            }
+         }
+      }
+      outValue = abcFromDynamic(obj->__Field(inName->name,true));
+      return;
+   }
+   if (object.type==avNull)
+      abcNullReference(inName);
+   if (object.type==avString && inName->name==HX_CSTRING("length"))
+   {
+      abcSetInt(outValue,object.length);
+      return;
+   }
+   outValue = abcFromDynamic(abcToDynamic(object)->__Field(inName->name,true));
+}
+
+static void abcSetProperty(AbcFrame &f,AbcName *inName,const AbcValue &inObj,const AbcValue &inValue,
+                           AbcInstr *ioCache)
+{
+   if (inObj.type!=avObject)
+   {
+      if (inObj.type==avNull)
+         abcNullReference(inName);
+      return;
+   }
+   hx::Object *obj = inObj.o;
+   ScriptHandler *handler = obj->__GetScriptHandler();
+   if (handler)
+   {
+      const ScriptMember &member = handler->findMember(inName);
+      if (member.field>=0)
+      {
+         if (ioCache)
+            HxAtomicStoreReleasePtr(&ioCache->cache,(void *)&member);
+         abcSetField(handler->mFields[member.field],obj->__GetScriptData(),inValue);
+         return;
+      }
+      if (member.setter)
+      {
+         AbcValue args[2] = { inObj, inValue };
+         Interpret(member.setter,args,1);
+         return;
+      }
+   }
+   else if (obj==f.global)
+   {
+      int slot = f.global->lookup(inName);
+      if (slot<0)
+         slot = inName->globalSlot = f.global->add(inName->name.__s);
+      f.global->set(slot,abcToDynamic(inValue));
+      return;
+   }
+   else
+   {
+      ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(obj);
+      if (cls)
+      {
+         const ScriptMember &member = cls->findStaticMember(inName);
+         if (member.field>=0)
+         {
+            cls->mStaticValues[member.field] = abcCoerce(cls->mStaticFields[member.field].mType,inValue);
+            return;
+         }
+         if (member.setter)
+         {
+            AbcValue args[2] = { inObj, inValue };
+            Interpret(member.setter,args,1);
+            return;
+         }
+      }
+   }
+   obj->__SetField(inName->name,abcToDynamic(inValue),true);
+}
+
+// obj[index] with a name or index from the stack
+static void abcGetIndex(const AbcValue &inObj,const AbcValue &inIndex,AbcValue &outValue)
+{
+   if (inObj.type==avNull)
+      abcNullReference(0);
+   Dynamic obj = abcToDynamic(inObj);
+   if (inIndex.type==avInt)
+      outValue = abcFromDynamic(obj->__GetItem(inIndex.i));
+   else
+      outValue = abcFromDynamic(obj->__Field(abcToString(inIndex),true));
+}
+
+static void abcSetIndex(const AbcValue &inObj,const AbcValue &inIndex,const AbcValue &inValue)
+{
+   if (inObj.type!=avObject)
+   {
+      if (inObj.type==avNull)
+         abcNullReference(0);
+      return;
+   }
+   if (inIndex.type==avInt)
+      inObj.o->__SetItem(inIndex.i,abcToDynamic(inValue));
+   else
+      inObj.o->__SetField(abcToString(inIndex),abcToDynamic(inValue),true);
+}
+
+static void abcGetSlot(AbcFrame &f,int inSlot,AbcValue &ioValue)
+{
+   if (ioValue.type!=avObject)
+      abcNullReference(0);
+   hx::Object *obj = ioValue.o;
+   if (obj==f.global)
+   {
+      ioValue = abcFromDynamic(f.global->mValues[ f.global->slotFromId(inSlot) ]);
+      return;
+   }
+   ScriptHandler *handler = obj->__GetScriptHandler();
+   if (handler && inSlot<(int)handler->mSlotFields.size() && handler->mSlotFields[inSlot]>=0)
+   {
+      abcGetField(handler->mFields[ handler->mSlotFields[inSlot] ],obj->__GetScriptData(),ioValue);
+      return;
+   }
+   ABCCatchScope *catchScope = hx::DynamicCast<ABCCatchScope>(obj);
+   if (catchScope && inSlot==1)
+   {
+      ioValue = abcFromDynamic(catchScope->mValue);
+      return;
+   }
+   ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(obj);
+   if (cls && inSlot<(int)cls->mStaticSlotFields.size() && cls->mStaticSlotFields[inSlot]>=0)
+   {
+      ioValue = abcFromDynamic(cls->mStaticValues[ cls->mStaticSlotFields[inSlot] ]);
+      return;
+   }
+   hx::Throw( HX_CSTRING("Bad slot") );
+}
+
+static void abcSetSlot(AbcFrame &f,int inSlot,const AbcValue &inObj,const AbcValue &inValue)
+{
+   if (inObj.type!=avObject)
+      abcNullReference(0);
+   hx::Object *obj = inObj.o;
+   if (obj==f.global)
+   {
+      f.global->set(f.global->slotFromId(inSlot),abcToDynamic(inValue));
+      return;
+   }
+   ScriptHandler *handler = obj->__GetScriptHandler();
+   if (handler && inSlot<(int)handler->mSlotFields.size() && handler->mSlotFields[inSlot]>=0)
+   {
+      abcSetField(handler->mFields[ handler->mSlotFields[inSlot] ],obj->__GetScriptData(),inValue);
+      return;
+   }
+   ABCCatchScope *catchScope = hx::DynamicCast<ABCCatchScope>(obj);
+   if (catchScope && inSlot==1)
+   {
+      catchScope->mValue = abcToDynamic(inValue);
+      return;
    }
+   ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(obj);
+   if (cls && inSlot<(int)cls->mStaticSlotFields.size() && cls->mStaticSlotFields[inSlot]>=0)
+   {
+      int field = cls->mStaticSlotFields[inSlot];
+      cls->mStaticValues[field] = abcCoerce(cls->mStaticFields[field].mType,inValue);
+      return;
+   }
+   hx::Throw( HX_CSTRING("Bad slot") );
+}
+
+static Dynamic abcCallNative(hx::Object *inFunc,const AbcValue *inArgs,int inArgCount)
+{
+   if (inArgCount<=5)
+   {
+      Dynamic args[5];
+      for(int i=0;i<inArgCount;i++)
+         args[i] = abcToDynamic(inArgs[i]);
+      return inFunc->__runArgs(args,inArgCount);
+   }
+   Array<Dynamic> args = Array_obj<Dynamic>::__new(inArgCount,inArgCount);
+   for(int i=0;i<inArgCount;i++)
+      args[i] = abcToDynamic(inArgs[i]);
+   return inFunc->__Run(args);
+}
+
+// inArgs[0] is the receiver, followed by the arguments
+static AbcValue abcCall(const AbcValue &inFunc,AbcValue *inArgs,int inArgCount)
+{
+   if (inFunc.type!=avObject)
+      hx::Throw( HX_CSTRING("Value is not a function") );
+   ABCFunction *func = hx::DynamicCast<ABCFunction>(inFunc.o);
+   if (func)
+   {
+      if (func->mThis)
+         abcSetObject(inArgs[0],func->mThis);
+      return Interpret(func->mMethod,inArgs,inArgCount);
+   }
+   return abcFromDynamic( abcCallNative(inFunc.o,inArgs+1,inArgCount) );
+}
 
-   void getLex(int inMultinameId)
+static AbcValue abcCallProperty(AbcFrame &f,AbcName *inName,AbcValue *inArgs,int inArgCount)
+{
+   const AbcValue &receiver = inArgs[0];
+   if (receiver.type==avObject)
    {
-      String name = global->abc->getMultiName(inMultinameId);
-      for(int s = scope->length-1; s>=0; s--)
+      hx::Object *obj = receiver.o;
+      if (obj==f.global)
+      {
+         int slot = f.global->lookup(inName);
+         if (slot>=0 && f.global->mFunctions[slot])
+            return Interpret(f.global->mFunctions[slot],inArgs,inArgCount);
+      }
+      else
       {
-         if (scope[s]->__HasField(name))
+         ScriptHandler *handler = obj->__GetScriptHandler();
+         if (handler)
          {
-            stack->push(scope[s]->__Field(name,true));
-            return;
+            Method *method = handler->findMember(inName).method;
+            if (method)
+               return Interpret(method,inArgs,inArgCount);
+         }
+         else
+         {
+            ScriptHandler *cls = hx::DynamicCast<ScriptHandler>(obj);
+            if (cls)
+            {
+               Method *method = cls->findStaticMember(inName).method;
+               if (method)
+                  return Interpret(method,inArgs,inArgCount);
+            }
          }
       }
-      DBGLOG("getLex %s - not found\n", name.__s);
-      hx::Throw( HX_CSTRING("Invalid field") );
    }
+   AbcValue func;
+   abcGetProperty(f,inName,receiver,func,0);
+   return abcCall(func,inArgs,inArgCount);
+}
+
+// inArgs[0] receives the new object, followed by the constructor arguments
+static hx::Object *abcConstruct(const AbcValue &inClass,AbcValue *inArgs,int inArgCount)
+{
+   hx::Object *obj = inClass.type==avObject ? inClass.o : 0;
+   ScriptHandler *handler = hx::DynamicCast<ScriptHandler>(obj);
+   if (handler)
+      return handler->Construct(inArgs,inArgCount);
+   Class_obj *cls = hx::DynamicCast<Class_obj>(obj);
+   if (!cls)
+      hx::Throw( HX_CSTRING("Value is not a class") );
+   Array<Dynamic> args = Array_obj<Dynamic>::__new(inArgCount,inArgCount);
+   for(int i=0;i<inArgCount;i++)
+      args[i] = abcToDynamic(inArgs[i+1]);
+   return cls->ConstructArgs(args).mPtr;
+}
+
+static void abcConstructSuper(AbcFrame &f,AbcValue *inArgs,int inArgCount)
+{
+   ScriptHandler *owner = f.method->owner;
+   if (!owner)
+      hx::Throw( HX_CSTRING("constructsuper outside a constructor") );
+   ScriptHandler *superScript = hx::DynamicCast<ScriptHandler>(owner->mSuper.GetPtr());
+   if (superScript && superScript->mConstructor)
+      Interpret(superScript->mConstructor,inArgs,inArgCount);
+   else if (inArgs[0].type==avObject)
+   {
+      Array<Dynamic> args = Array_obj<Dynamic>::__new(inArgCount,inArgCount);
+      for(int i=0;i<inArgCount;i++)
+         args[i] = abcToDynamic(inArgs[i+1]);
+      inArgs[0].o->__Construct(args);
+   }
+}
+
+static AbcHandler *abcFindHandler(AbcFrame &f,const Dynamic &inException)
+{
+   for(int h=0;h<(int)f.code->handlers.size();h++)
+   {
+      AbcHandler &handler = f.code->handlers[h];
+      if (f.ip<handler.from || f.ip>=handler.to)
+         continue;
+      if (!handler.type)
+         return &handler;
+      int slot = f.global->lookup(handler.type);
+      if (slot>=0 && __instanceof(inException,f.global->mValues[slot]))
+         return &handler;
+   }
+   return 0;
+}
+
+
+#ifdef ABC_THREADED
+#define ABC_CASE(name) L_##name:
+#define ABC_DISPATCH goto *ip->label
+#else
+#define ABC_CASE(name) case iop##name:
+#define ABC_DISPATCH goto dispatch
+#endif
+#define ABC_NEXT { ip++; ABC_DISPATCH; }
+#define ABC_JUMP(inTarget) { ip = base + (inTarget); ABC_DISPATCH; }
+// Anything that can throw records where, for the exception table
+#define ABC_SAVE (f.ip = (int)(ip - base))
+
+#define ABC_COMPARE_TOP \
+   int c = sp[-2].type==avInt && sp[-1].type==avInt ? \
+      (sp[-2].i<sp[-1].i ? abcLess : sp[-2].i>sp[-1].i ? abcGreater : abcEqual) : \
+      (ABC_SAVE, abcCompare(sp[-2],sp[-1]))
+
+#define ABC_COMPARE(inTest) \
+   { ABC_COMPARE_TOP; sp--; abcSetBool(sp[-1], inTest); } ABC_NEXT
+
+#define ABC_IF_COMPARE(inTest) \
+   { ABC_COMPARE_TOP; sp-=2; if (inTest) ABC_JUMP(ip->a); } ABC_NEXT
 
+#define ABC_IF_BOOL(inTest) \
+   { sp--; bool value = sp->type==avBool ? sp->i : abcToBool(*sp); if (inTest) ABC_JUMP(ip->a); } ABC_NEXT
+
+#ifdef ABC_THREADED
+static const void **sAbcLabels = 0;
+#endif
+
+static AbcValue abcRun(AbcFrame &f)
+{
+   AbcCode *code = f.code;
 
-   Dynamic call(Method *inMethod,int inArgs)
+   #ifdef ABC_THREADED
+   static const void *sLabels[] =
    {
-      DBGLOG("Call, passed %d/%d args\n", inMethod->paramCount, inArgs);
-      int local0 = stack->length - inArgs -1;
-      for(int i=inArgs; i<inMethod->paramCount;i++)
-         push(null());
+      #define ABC_IOP(name) &&L_##name,
+      ABC_IOPS
+      #undef ABC_IOP
+   };
+   // A frame without code just asks for the handler addresses
+   if (!code)
+   {
+      HxAtomicStoreReleasePtr((void * volatile *)&sAbcLabels,(void *)sLabels);
+      return AbcValue();
+   }
+   #endif
+
+   AbcInstr *base = &code->instrs[0];
+   AbcInstr *ip = base + f.ip;
+   AbcValue *locals = f.locals;
+   AbcValue *sp = f.stack + f.sp;
+   hx::Object **scope = f.scope + f.scopeDepth;
+   AbcValue result;
+
+   ABC_DISPATCH;
+   #ifndef ABC_THREADED
+   dispatch:
+   switch(ip->op)
+   #endif
+   {
+      ABC_CASE(PushNull) abcSetNull(*sp++); ABC_NEXT
+      ABC_CASE(PushTrue) abcSetBool(*sp++,true); ABC_NEXT
+      ABC_CASE(PushFalse) abcSetBool(*sp++,false); ABC_NEXT
+      ABC_CASE(PushInt) abcSetInt(*sp++,ip->a); ABC_NEXT
+      ABC_CASE(PushDouble) abcSetDouble(*sp++,ip->d); ABC_NEXT
+      ABC_CASE(PushString)
+         sp->type = avString;
+         sp->s = ip->s;
+         sp->length = ip->b;
+         sp++;
+         ABC_NEXT
+      ABC_CASE(Pop) sp--; ABC_NEXT
+      ABC_CASE(Dup) *sp = sp[-1]; sp++; ABC_NEXT
+      ABC_CASE(Swap)
+         {
+         AbcValue top = sp[-1];
+         sp[-1] = sp[-2];
+         sp[-2] = top;
+         }
+         ABC_NEXT
 
-      MethodBody *body = inMethod->body;
-      // Make room for locals...
+      ABC_CASE(GetLocal) *sp++ = locals[ip->a]; ABC_NEXT
+      ABC_CASE(SetLocal) locals[ip->a] = *--sp; ABC_NEXT
+      ABC_CASE(Kill) abcSetNull(locals[ip->a]); ABC_NEXT
+      ABC_CASE(IncLocal)
+         {
+         AbcValue &v = locals[ip->a];
+         if (v.type==avInt && v.i<INT_MAX)
+            v.i++;
+         else
+            abcSetDouble(v,abcToNumber(v)+1);
+         }
+         ABC_NEXT
+      ABC_CASE(DecLocal)
+         {
+         AbcValue &v = locals[ip->a];
+         if (v.type==avInt && v.i>INT_MIN)
+            v.i--;
+         else
+            abcSetDouble(v,abcToNumber(v)-1);
+         }
+         ABC_NEXT
+      ABC_CASE(IncLocalI)
+         abcSetInt(locals[ip->a],(int)((unsigned int)abcToInt(locals[ip->a]) + 1));
+         ABC_NEXT
+      ABC_CASE(DecLocalI)
+         abcSetInt(locals[ip->a],(int)((unsigned int)abcToInt(locals[ip->a]) - 1));
+         ABC_NEXT
+
+      ABC_CASE(Add)
+         {
+         AbcValue &a = sp[-2];
+         AbcValue &b = sp[-1];
+         if (a.type==avInt && b.type==avInt)
+            abcSetNumber(a,(long long)a.i + b.i);
+         else if (a.type==avDouble && b.type==avDouble)
+            a.d += b.d;
+         else
+         {
+            ABC_SAVE;
+            abcAdd(a,b);
+         }
+         sp--;
+         }
+         ABC_NEXT
+      ABC_CASE(Subtract)
+         {
+         AbcValue &a = sp[-2];
+         AbcValue &b = sp[-1];
+         if (a.type==avInt && b.type==avInt)
+            abcSetNumber(a,(long long)a.i - b.i);
+         else
+            abcSetDouble(a,abcToNumber(a) - abcToNumber(b));
+         sp--;
+         }
+         ABC_NEXT
+      ABC_CASE(Multiply)
+         {
+         AbcValue &a = sp[-2];
+         AbcValue &b = sp[-1];
+         if (a.type==avInt && b.type==avInt)
+            abcSetNumber(a,(long long)a.i * b.i);
+         else
+            abcSetDouble(a,abcToNumber(a) * abcToNumber(b));
+         sp--;
+         }
+         ABC_NEXT
+      ABC_CASE(Divide)
+         abcSetDouble(sp[-2],abcToNumber(sp[-2]) / abcToNumber(sp[-1]));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(Modulo)
+         {
+         AbcValue &a = sp[-2];
+         AbcValue &b = sp[-1];
+         // x%-1 and x%0 go through fmod, for -0 and NaN
+         if (a.type==avInt && b.type==avInt && b.i>0)
+            a.i %= b.i;
+         else
+            abcSetDouble(a,fmod(abcToNumber(a),abcToNumber(b)));
+         sp--;
+         }
+         ABC_NEXT
+      ABC_CASE(Negate)
+         {
+         AbcValue &v = sp[-1];
+         if (v.type==avInt && v.i!=0 && v.i!=INT_MIN)
+            v.i = -v.i;
+         else
+            abcSetDouble(v,-abcToNumber(v));
+         }
+         ABC_NEXT
+      ABC_CASE(Increment)
+         {
+         AbcValue &v = sp[-1];
+         if (v.type==avInt && v.i<INT_MAX)
+            v.i++;
+         else
+            abcSetDouble(v,abcToNumber(v)+1);
+         }
+         ABC_NEXT
+      ABC_CASE(Decrement)
+         {
+         AbcValue &v = sp[-1];
+         if (v.type==avInt && v.i>INT_MIN)
+            v.i--;
+         else
+            abcSetDouble(v,abcToNumber(v)-1);
+         }
+         ABC_NEXT
+
+      ABC_CASE(AddI)
+         abcSetInt(sp[-2],(int)((unsigned int)abcToInt(sp[-2]) + (unsigned int)abcToInt(sp[-1])));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(SubtractI)
+         abcSetInt(sp[-2],(int)((unsigned int)abcToInt(sp[-2]) - (unsigned int)abcToInt(sp[-1])));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(MultiplyI)
+         abcSetInt(sp[-2],(int)((unsigned int)abcToInt(sp[-2]) * (unsigned int)abcToInt(sp[-1])));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(NegateI) abcSetInt(sp[-1],(int)(0u - (unsigned int)abcToInt(sp[-1]))); ABC_NEXT
+      ABC_CASE(IncrementI) abcSetInt(sp[-1],(int)((unsigned int)abcToInt(sp[-1]) + 1)); ABC_NEXT
+      ABC_CASE(DecrementI) abcSetInt(sp[-1],(int)((unsigned int)abcToInt(sp[-1]) - 1)); ABC_NEXT
+
+      ABC_CASE(BitAnd) abcSetInt(sp[-2],abcToInt(sp[-2]) & abcToInt(sp[-1])); sp--; ABC_NEXT
+      ABC_CASE(BitOr) abcSetInt(sp[-2],abcToInt(sp[-2]) | abcToInt(sp[-1])); sp--; ABC_NEXT
+      ABC_CASE(BitXor) abcSetInt(sp[-2],abcToInt(sp[-2]) ^ abcToInt(sp[-1])); sp--; ABC_NEXT
+      ABC_CASE(BitNot) abcSetInt(sp[-1],~abcToInt(sp[-1])); ABC_NEXT
+      ABC_CASE(LShift)
+         abcSetInt(sp[-2],(int)((unsigned int)abcToInt(sp[-2]) << (abcToInt(sp[-1]) & 31)));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(RShift)
+         abcSetInt(sp[-2],abcToInt(sp[-2]) >> (abcToInt(sp[-1]) & 31));
+         sp--;
+         ABC_NEXT
+      ABC_CASE(URShift)
+         abcSetUInt(sp[-2],(unsigned int)abcToInt(sp[-2]) >> (abcToInt(sp[-1]) & 31));
+         sp--;
+         ABC_NEXT
+
+      ABC_CASE(Not) abcSetBool(sp[-1],!abcToBool(sp[-1])); ABC_NEXT
+      ABC_CASE(Equals)
+         {
+         ABC_SAVE;
+         bool equal = abcEquals(sp[-2],sp[-1]);
+         sp--;
+         abcSetBool(sp[-1],equal);
+         }
+         ABC_NEXT
+      ABC_CASE(StrictEquals)
+         {
+         bool equal = abcStrictEquals(sp[-2],sp[-1]);
+         sp--;
+         abcSetBool(sp[-1],equal);
+         }
+         ABC_NEXT
+      ABC_CASE(LessThan) ABC_COMPARE(c==abcLess)
+      ABC_CASE(LessEquals) ABC_COMPARE(c==abcLess || c==abcEqual)
+      ABC_CASE(GreaterThan) ABC_COMPARE(c==abcGreater)
+      ABC_CASE(GreaterEquals) ABC_COMPARE(c==abcGreater || c==abcEqual)
+
+      ABC_CASE(Jump) ABC_JUMP(ip->a)
+      ABC_CASE(IfTrue) ABC_IF_BOOL(value)
+      ABC_CASE(IfFalse) ABC_IF_BOOL(!value)
+      ABC_CASE(IfEq)
+         {
+         ABC_SAVE;
+         sp-=2;
+         if (abcEquals(sp[0],sp[1]))
+            ABC_JUMP(ip->a);
+         }
+         ABC_NEXT
+      ABC_CASE(IfNe)
+         {
+         ABC_SAVE;
+         sp-=2;
+         if (!abcEquals(sp[0],sp[1]))
+            ABC_JUMP(ip->a);
+         }
+         ABC_NEXT
+      ABC_CASE(IfStrictEq)
+         sp-=2;
+         if (abcStrictEquals(sp[0],sp[1]))
+            ABC_JUMP(ip->a);
+         ABC_NEXT
+      ABC_CASE(IfStrictNe)
+         sp-=2;
+         if (!abcStrictEquals(sp[0],sp[1]))
+            ABC_JUMP(ip->a);
+         ABC_NEXT
+      ABC_CASE(IfLt) ABC_IF_COMPARE(c==abcLess)
+      ABC_CASE(IfLe) ABC_IF_COMPARE(c==abcLess || c==abcEqual)
+      ABC_CASE(IfGt) ABC_IF_COMPARE(c==abcGreater)
+      ABC_CASE(IfGe) ABC_IF_COMPARE(c==abcGreater || c==abcEqual)
+      // The negated forms also branch when the comparison is unordered
+      ABC_CASE(IfNlt) ABC_IF_COMPARE(c!=abcLess)
+      ABC_CASE(IfNle) ABC_IF_COMPARE(c!=abcLess && c!=abcEqual)
+      ABC_CASE(IfNgt) ABC_IF_COMPARE(c!=abcGreater)
+      ABC_CASE(IfNge) ABC_IF_COMPARE(c!=abcGreater && c!=abcEqual)
+      ABC_CASE(LookupSwitch)
+         {
+         int index = abcToInt(*--sp);
+         const int *targets = &code->switchTargets[ip->a];
+         ABC_JUMP( index>=0 && index<ip->b ? targets[index+1] : targets[0] );
+         }
 
-      const unsigned char *code = &body->code[0];
-      const unsigned char *pc = code;
-      const unsigned char *end = pc + body->code.size();
-      while(pc<end)
+      ABC_CASE(ConvertI)
+         if (sp[-1].type!=avInt)
+            abcSetInt(sp[-1],abcToInt(sp[-1]));
+         ABC_NEXT
+      ABC_CASE(ConvertU)
+         if (sp[-1].type!=avInt || sp[-1].i<0)
+            abcSetUInt(sp[-1],(unsigned int)abcToInt(sp[-1]));
+         ABC_NEXT
+      // int already is a Number, and stays on the int paths
+      ABC_CASE(ConvertD)
+         if (sp[-1].type!=avInt && sp[-1].type!=avDouble)
+            abcSetDouble(sp[-1],abcToNumber(sp[-1]));
+         ABC_NEXT
+      ABC_CASE(ConvertB) abcSetBool(sp[-1],abcToBool(sp[-1])); ABC_NEXT
+      ABC_CASE(ConvertS)
+         if (sp[-1].type!=avString)
+         {
+            ABC_SAVE;
+            abcSetString(sp[-1],abcToString(sp[-1]));
+         }
+         ABC_NEXT
+      ABC_CASE(CoerceS)
+         if (sp[-1].type!=avString && sp[-1].type!=avNull)
+         {
+            ABC_SAVE;
+            abcSetString(sp[-1],abcToString(sp[-1]));
+         }
+         ABC_NEXT
+
+      ABC_CASE(PushScope)
+         sp--;
+         if (sp->type==avNull)
+         {
+            ABC_SAVE;
+            abcNullReference(0);
+         }
+         *scope++ = abcToObject(*sp);
+         ABC_NEXT
+      ABC_CASE(PopScope) scope--; ABC_NEXT
+      ABC_CASE(GetScopeObject) abcSetObject(*sp++,f.scope[ip->a]); ABC_NEXT
+      ABC_CASE(GetGlobalScope) abcSetObject(*sp++,f.global); ABC_NEXT
+
+      ABC_CASE(FindProperty)
+         ABC_SAVE;
+         abcSetObject(*sp,abcFindProperty(f,scope,ip->name,false));
+         sp++;
+         ABC_NEXT
+      ABC_CASE(FindPropStrict)
+         ABC_SAVE;
+         abcSetObject(*sp,abcFindProperty(f,scope,ip->name,true));
+         sp++;
+         ABC_NEXT
+      ABC_CASE(GetLex)
+         ABC_SAVE;
+         abcSetObject(*sp,abcFindProperty(f,scope,ip->name,true));
+         abcGetProperty(f,ip->name,*sp,*sp,0);
+         sp++;
+         ABC_NEXT
+      ABC_CASE(GetProperty)
+         {
+         AbcValue &obj = sp[-1];
+         const ScriptMember *member = (const ScriptMember *)HxAtomicLoadAcquirePtr(&ip->cache);
+         if (obj.type==avObject && member && obj.o->__GetScriptHandler()==member->owner)
+            abcGetField(member->owner->mFields[member->field],obj.o->__GetScriptData(),obj);
+         else
+         {
+            ABC_SAVE;
+            abcGetProperty(f,ip->name,obj,obj,ip);
+         }
+         }
+         ABC_NEXT
+      ABC_CASE(SetProperty)
+         {
+         AbcValue &obj = sp[-2];
+         const ScriptMember *member = (const ScriptMember *)HxAtomicLoadAcquirePtr(&ip->cache);
+         if (obj.type==avObject && member && obj.o->__GetScriptHandler()==member->owner)
+            abcSetField(member->owner->mFields[member->field],obj.o->__GetScriptData(),sp[-1]);
+         else
+         {
+            ABC_SAVE;
+            abcSetProperty(f,ip->name,obj,sp[-1],ip);
+         }
+         sp-=2;
+         }
+         ABC_NEXT
+      ABC_CASE(GetPropertyL)
+         ABC_SAVE;
+         sp--;
+         abcGetIndex(sp[-1],sp[0],sp[-1]);
+         ABC_NEXT
+      ABC_CASE(SetPropertyL)
+         ABC_SAVE;
+         abcSetIndex(sp[-3],sp[-2],sp[-1]);
+         sp-=3;
+         ABC_NEXT
+      ABC_CASE(GetSlot)
+         ABC_SAVE;
+         abcGetSlot(f,ip->a,sp[-1]);
+         ABC_NEXT
+      ABC_CASE(SetSlot)
+         ABC_SAVE;
+         abcSetSlot(f,ip->a,sp[-2],sp[-1]);
+         sp-=2;
+         ABC_NEXT
+
+      ABC_CASE(CallProperty)
+         {
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         *args = abcCallProperty(f,ip->name,args,ip->a);
+         sp = args + 1;
+         }
+         ABC_NEXT
+      ABC_CASE(CallPropVoid)
+         {
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         abcCallProperty(f,ip->name,args,ip->a);
+         sp = args;
+         }
+         ABC_NEXT
+      ABC_CASE(Call)
+         {
+         // function, receiver, arguments
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         AbcValue func = args[-1];
+         args[-1] = abcCall(func,args,ip->a);
+         sp = args;
+         }
+         ABC_NEXT
+      ABC_CASE(Construct)
+         {
+         // The class slot takes the new object
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         AbcValue cls = args[0];
+         abcSetObject(args[0],abcConstruct(cls,args,ip->a));
+         sp = args + 1;
+         }
+         ABC_NEXT
+      ABC_CASE(ConstructProp)
+         {
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         AbcValue cls;
+         abcGetProperty(f,ip->name,args[0],cls,0);
+         abcSetObject(args[0],abcConstruct(cls,args,ip->a));
+         sp = args + 1;
+         }
+         ABC_NEXT
+      ABC_CASE(ConstructSuper)
+         {
+         AbcValue *args = sp - ip->a - 1;
+         ABC_SAVE;
+         abcConstructSuper(f,args,ip->a);
+         sp = args;
+         }
+         ABC_NEXT
+      ABC_CASE(NewArray)
+         {
+         AbcValue *items = sp - ip->a;
+         Array<Dynamic> array = Array_obj<Dynamic>::__new(ip->a,ip->a);
+         for(int i=0;i<ip->a;i++)
+            array[i] = abcToDynamic(items[i]);
+         abcSetObject(items[0],array.mPtr);
+         sp = items + 1;
+         }
+         ABC_NEXT
+      ABC_CASE(NewObject)
+         {
+         AbcValue *items = sp - ip->a*2;
+         ABC_SAVE;
+         hx::Anon obj = hx::Anon_obj::Create();
+         for(int i=0;i<ip->a;i++)
+            obj->Add(abcToString(items[i*2]),abcToDynamic(items[i*2+1]));
+         abcSetObject(items[0],obj.mPtr);
+         sp = items + 1;
+         }
+         ABC_NEXT
+      ABC_CASE(NewClass)
+         {
+         ABC_SAVE;
+         Class_obj *cls = f.method->abc->mClasses[ip->a];
+         if (!cls)
+            hx::Throw( HX_CSTRING("Class was not loaded") );
+         ScriptHandler *handler = hx::DynamicCast<ScriptHandler>(cls);
+         if (handler)
+            handler->runStaticInit();
+         abcSetObject(sp[-1],cls);
+         }
+         ABC_NEXT
+      ABC_CASE(NewCatch)
+         {
+         AbcName *var = code->handlers[ip->a].var;
+         abcSetObject(*sp++,new ABCCatchScope(var ? var->name : String()));
+         }
+         ABC_NEXT
+
+      ABC_CASE(TypeOf) abcSetString(sp[-1],abcTypeOf(sp[-1])); ABC_NEXT
+      ABC_CASE(Throw)
+         ABC_SAVE;
+         sp--;
+         hx::Throw(abcToDynamic(*sp));
+         ABC_NEXT
+      ABC_CASE(ReturnValue) return sp[-1];
+      ABC_CASE(ReturnVoid) abcSetNull(result); return result;
+   }
+   abcSetNull(result);
+   return result;
+}
+
+// Code is threaded before it is published, so another thread never sees it half done.
+//  If two threads decode the same method at once, the first to publish wins.
+static AbcCode *abcDecode(Method *inMethod)
+{
+   MethodBody *body = inMethod->body;
+   AbcCode *code = ABCDecoder(*inMethod).decode();
+
+   #ifdef ABC_THREADED
+   const void **labels = (const void **)HxAtomicLoadAcquirePtr((void * volatile *)&sAbcLabels);
+   if (!labels)
+   {
+      AbcFrame f;
+      f.code = 0;
+      abcRun(f);
+      labels = sAbcLabels;
+   }
+   for(int i=0;i<(int)code->instrs.size();i++)
+      code->instrs[i].label = labels[ code->instrs[i].op ];
+   #endif
+
+   if (!HxAtomicCasPtr((void * volatile *)&body->decoded,0,code))
+   {
+      delete code;
+      code = (AbcCode *)HxAtomicLoadAcquirePtr((void * volatile *)&body->decoded);
+   }
+   return code;
+}
+
+// A frame too big for the C stack.  Only the stack is scanned conservatively, so the
+//  store marks the values itself, and is kept alive by the pointer on the stack.  The
+//  buffer is malloced so it does not move under the running frame.
+class ABCFrameStore : public hx::Object
+{
+public:
+   ABCFrameStore(const AbcCode &inCode) : mValueCount(abcFrameValues(inCode)), mScopeCount(inCode.maxScope)
+   {
+      mValues = (AbcValue *)calloc(1,abcFrameBytes(inCode));
+   }
+   hx::Object **scopes() { return (hx::Object **)(mValues + mValueCount); }
+
+   void release()
+   {
+      free(mValues);
+      mValues = 0;
+   }
+
+   void __Mark(hx::MarkContext *__inCtx)
+   {
+      if (!mValues)
+         return;
+      for(int i=0;i<mValueCount;i++)
       {
-         int code = *pc++;
-         DBGLOG("op code %d = %s\n", code, sOpCodeNames[code]);
-         switch(code)
+         AbcValue &v = mValues[i];
+         if (v.type==avString)
          {
-            case op_getlex: getLex(getU30(pc)); break;
-            case op_newclass:
-               getU30(pc);
-               break;
-            case op_initproperty:
-               getU30(pc);
-               break;
-            case op_pushbyte:
-               pc++;
-               break;
-            case op_pushint:
-               getU30(pc);
-               break;
-            case op_returnvoid:
-               return null();
+            HX_MARK_STRING(v.s);
+         }
+         else if (v.type==avObject)
+         {
+            HX_MARK_OBJECT(v.o);
          }
       }
-
-      printf("Missing return statement?\n");
-      return null();
+      hx::Object **scope = scopes();
+      for(int i=0;i<mScopeCount;i++)
+         HX_MARK_OBJECT(scope[i]);
+   }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx)
+   {
+      if (!mValues)
+         return;
+      for(int i=0;i<mValueCount;i++)
+      {
+         AbcValue &v = mValues[i];
+         if (v.type==avString)
+         {
+            HX_VISIT_STRING(v.s);
+         }
+         else if (v.type==avObject)
+         {
+            HX_VISIT_OBJECT(v.o);
+         }
+      }
+      hx::Object **scope = scopes();
+      for(int i=0;i<mScopeCount;i++)
+         HX_VISIT_OBJECT(scope[i]);
    }
+   #endif
+
+   AbcValue *mValues;
+   int      mValueCount;
+   int      mScopeCount;
 };
 
+// Frees a heap frame however the interpreter leaves
+struct ABCFrameRelease
+{
+   ABCFrameStore *mStore;
+   ABCFrameRelease() : mStore(0) { }
+   ~ABCFrameRelease() { if (mStore) mStore->release(); }
+};
 
-// TODO: Thread local storage
-ABCContext *gABCContext = 0;
-inline ABCContext *GetABCContext()
+static AbcValue Interpret(Method *inMethod,AbcValue *inArgs,int inArgCount)
 {
-   return gABCContext;
+   MethodBody *body = inMethod->body;
+   if (!body)
+      hx::Throw( HX_CSTRING("Method has no body") );
+   AbcCode *code = (AbcCode *)HxAtomicLoadAcquirePtr((void * volatile *)&body->decoded);
+   if (!code)
+      code = abcDecode(inMethod);
+
+   AbcFrame f;
+   f.method = inMethod;
+   f.global = inMethod->abc->mGlobal;
+   f.code = code;
+   ABCFrameRelease heapFrame;
+   int bytes = abcFrameBytes(*code);
+   if (bytes<=ABC_STACK_FRAME_BYTES)
+   {
+      f.locals = (AbcValue *)ABC_ALLOCA(bytes);
+      memset(f.locals,0,bytes);
+   }
+   else
+   {
+      heapFrame.mStore = new ABCFrameStore(*code);
+      f.locals = heapFrame.mStore->mValues;
+      if (!f.locals)
+         hx::Throw( HX_CSTRING("Out of memory for method frame") );
+   }
+   f.stack = f.locals + code->localCount;
+   f.scope = (hx::Object **)(f.stack + code->maxStack);
+   f.ip = 0;
+   f.sp = 0;
+   f.scopeDepth = 0;
+
+   f.locals[0] = inArgs[0];
+   int params = inMethod->paramCount;
+   int firstOptional = params - (int)inMethod->optionals.size();
+   for(int p=0;p<params;p++)
+   {
+      if (p<inArgCount)
+         f.locals[p+1] = inArgs[p+1];
+      else if (p>=firstOptional)
+      {
+         Optional &optional = inMethod->optionals[p-firstOptional];
+         f.locals[p+1] = abcConst(*inMethod->abc,optional.kind,optional.val);
+      }
+   }
+
+   while(true)
+   {
+      try
+      {
+         return abcRun(f);
+      }
+      catch(Dynamic e)
+      {
+         AbcHandler *handler = abcFindHandler(f,e);
+         if (!handler)
+            throw;
+         // The handler starts with just the exception on the stack, and no scopes
+         f.stack[0] = abcFromDynamic(e);
+         f.sp = 1;
+         f.scopeDepth = 0;
+         f.ip = handler->target;
+      }
+   }
+   return f.stack[0];
 }
 
-void CreateABCContext(ABCGlobalObject *inGlobal)
+static Dynamic CallMethod(Method *inMethod,hx::Object *inThis,const Dynamic *inArgs,int inArgCount)
 {
-   gABCContext = new ABCContext(inGlobal);
+   AbcValue *args = (AbcValue *)ABC_ALLOCA((inArgCount+1)*sizeof(AbcValue));
+   abcSetObject(args[0], inThis ? inThis : inMethod->abc->mGlobal);
+   for(int i=0;i<inArgCount;i++)
+      args[i+1] = abcFromDynamic(inArgs[i]);
+   return abcToDynamic( Interpret(inMethod,args,inArgCount) );
 }
 
 
@@ -1338,77 +3620,42 @@ void InitABC()
 
 Dynamic ScriptableCall0(void *user, Object *thiz)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   return context->call(method,0);
+   return CallMethod((Method *)user,thiz,0,0);
 }
 
 Dynamic ScriptableCall1(void *user, Object *thiz,Dynamic arg0)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   context->push(arg0);
-   return context->call(method,1);
+   return CallMethod((Method *)user,thiz,&arg0,1);
 }
 
 Dynamic ScriptableCall2(void *user, Object *thiz,Dynamic arg0,Dynamic arg1)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   context->push(arg0);
-   context->push(arg1);
-   return context->call(method,2);
+   Dynamic args[] = { arg0, arg1 };
+   return CallMethod((Method *)user,thiz,args,2);
 }
 
 Dynamic ScriptableCall3(void *user, Object *thiz,Dynamic arg0,Dynamic arg1,Dynamic arg2)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   context->push(arg0);
-   context->push(arg1);
-   context->push(arg2);
-   return context->call(method,3);
+   Dynamic args[] = { arg0, arg1, arg2 };
+   return CallMethod((Method *)user,thiz,args,3);
 }
 
 Dynamic ScriptableCall4(void *user, Object *thiz,Dynamic arg0,Dynamic arg1,Dynamic arg2,Dynamic arg3)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   context->push(arg0);
-   context->push(arg1);
-   context->push(arg2);
-   context->push(arg3);
-   return context->call(method,4);
+   Dynamic args[] = { arg0, arg1, arg2, arg3 };
+   return CallMethod((Method *)user,thiz,args,4);
 }
 
 Dynamic ScriptableCall5(void *user, Object *thiz,Dynamic arg0,Dynamic arg1,Dynamic arg2,Dynamic arg3,Dynamic arg4)
 {
-   Method *method = (Method *)user;
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   context->push(arg0);
-   context->push(arg1);
-   context->push(arg2);
-   context->push(arg3);
-   context->push(arg4);
-   return context->call(method,5);
+   Dynamic args[] = { arg0, arg1, arg2, arg3, arg4 };
+   return CallMethod((Method *)user,thiz,args,5);
 }
 
 Dynamic ScriptableCallMult(void *user, Object *thiz,Dynamic *inArgs)
 {
    Method *method = (Method *)user;
-
-   ABCContext *context = GetABCContext();
-   context->pushThis(thiz);
-   int argc = method->paramNames.size();
-   for(int i=0;i<argc;i++)
-      context->push(inArgs[i]);
-   return context->call(method,argc);
+   return CallMethod(method,thiz,inArgs,method->paramCount);
 }
 
 void ScriptableMark(ScriptHandler *inHandler, unsigned char *inInstanceData, HX_MARK_PARAMS)
@@ -1423,8 +3670,28 @@ void ScriptableVisit(ScriptHandler *inHandler, unsigned char **inInstanceDataPtr
    inHandler->visitFields(*inInstanceDataPtr,HX_VISIT_ARG);
 }
 
-bool ScriptableField(hx::Object *, const ::String &,bool inCallProp,Dynamic &outResult)
+bool ScriptableField(hx::Object *inObj, const ::String &inName,bool inCallProp,Dynamic &outResult)
 {
+   ScriptHandler *handler = inObj->__GetScriptHandler();
+   if (!handler || !inName.__s)
+      return false;
+   ScriptMember member = handler->findMember(std::string(inName.__s));
+   if (member.field>=0)
+   {
+      FieldInfo &field = handler->mFields[member.field];
+      outResult = field.mGetter(inObj->__GetScriptData() + field.mOffset);
+      return true;
+   }
+   if (member.getter && inCallProp)
+   {
+      outResult = CallMethod(member.getter,inObj,0,0);
+      return true;
+   }
+   if (member.method)
+   {
+      outResult = new ABCFunction(member.method,inObj);
+      return true;
+   }
    return false;
 }
 
@@ -1440,10 +3707,35 @@ bool ScriptableField(hx::Object *, int inName,bool inCallProp,Dynamic &outResult
 
 void ScriptableGetFields(hx::Object *inObject, Array< ::String> &outFields)
 {
+   ScriptHandler *handler = inObject->__GetScriptHandler();
+   if (!handler)
+      return;
+   for(int f=0;f<(int)handler->mFields.size();f++)
+   {
+      const std::string &name = handler->mFields[f].mName;
+      outFields->push( String(name.c_str(),name.size()).dup() );
+   }
 }
 
-bool ScriptableSetField(hx::Object *, const ::String &, Dynamic inValue,bool inCallProp, Dynamic &outValue)
+bool ScriptableSetField(hx::Object *inObj, const ::String &inName, Dynamic inValue,bool inCallProp, Dynamic &outValue)
 {
+   ScriptHandler *handler = inObj->__GetScriptHandler();
+   if (!handler || !inName.__s)
+      return false;
+   ScriptMember member = handler->findMember(std::string(inName.__s));
+   if (member.field>=0)
+   {
+      FieldInfo &field = handler->mFields[member.field];
+      field.mSetter(inObj->__GetScriptData() + field.mOffset, inValue);
+      outValue = inValue;
+      return true;
+   }
+   if (member.setter && inCallProp)
+   {
+      CallMethod(member.setter,inObj,&inValue,1);
+      outValue = inValue;
+      return true;
+   }
    return false;
 }
 
@@ -1471,8 +3763,31 @@ void LoadABC(const unsigned char *inBytes, int inLen)
    try
    {
       stream.read(abc);
+      ResolveNames(abc);
+
+      // Every body is decoded and verified now, rather than on its first call.  So a script
+      //  that uses anything the interpreter lacks - newfunction, activations, arguments,
+      //  rest, callsuper, for-in ops, XML - is refused whole, before any of its classes
+      //  are registered.
+      for(int b=0;b<(int)abc.mMethodBody.size();b++)
+      {
+         Method &method = abc.mMethods[ abc.mMethodBody[b].method ];
+         try
+         {
+            abcDecode(&method);
+         }
+         catch(Dynamic e)
+         {
+            String name = method.name>0 && method.name<(int)abc.mStrings.size() ?
+                              abc.mStrings[method.name] : HX_CSTRING("<anonymous>");
+            hx::Throw( HX_CSTRING("Method ") + name + HX_CSTRING(": ") + e->toString() );
+         }
+      }
 
-      for(int i=0;i<abc.mInstanceInfo.size();i++)
+      abc.mGlobal = new ABCGlobalObject(abcInstance);
+      GCAddRoot((hx::Object **)&abc.mGlobal);
+
+      for(int i=0;i<(int)abc.mInstanceInfo.size();i++)
       {
          InstanceInfo &inst = abc.mInstanceInfo[i];
          String className = abc.getMultiName(inst.name);
@@ -1482,56 +3797,52 @@ void LoadABC(const unsigned char *inBytes, int inLen)
          {
             ABCClass cls = new ABCClass_obj(abc, inst, abc.mClassInfo[i]);
             RegisterClass(className,cls);
+            abc.mClasses.push_back(cls.GetPtr());
          }
          else
          {
             DBGLOG("Already defined %s\n", className.__s);
+            abc.mClasses.push_back(cls.GetPtr());
          }
       }
 
-      for(int i=0;i<abc.mScriptInfo.size();i++)
+      ABCGlobalObject *global = abc.mGlobal;
+      for(int i=0;i<(int)abc.mScriptInfo.size();i++)
       {
          TraitSet &traits = abc.mScriptInfo[i];
-         int scriptInit = traits.init;
-         //printf("Init function %p (%d)\n", &abc.mMethods[scriptInit], scriptInit);
 
-         for(int t=0;t<traits.traits.size();t++)
+         for(int t=0;t<(int)traits.traits.size();t++)
          {
             Trait &trait = traits.traits[t];
-            String name = abc.getMultiName(trait.name);
+            String name = abc.mNames[trait.name].name;
+            if (!name.__s)
+               continue;
+            int slot = global->add(name.__s);
+            global->setSlotId(trait.slot,slot);
             switch(trait.kind)
             {
                case Trait_Slot:
-                  {
-                  printf(" script var %s\n", name.__s );
-                  }
+               case Trait_Const:
+                  DBGLOG(" script var %s\n", name.__s);
+                  if (trait.vkind!=ConstantUndefined)
+                     global->set(slot,abc.getConst(trait));
                   break;
                case Trait_Method:
-               case Trait_Getter:
-               case Trait_Setter:
-                  {
-                  printf(" script function %s ?\n", name.__s );
-                  }
-                  break;
-               case Trait_Class:
-                  //printf(" script class %d->%d\n", trait.index, trait.slot);
-                  break;
                case Trait_Function:
-                  //printf(" script function %d->%d\n", trait.index, trait.slot);
+                  DBGLOG(" script function %s\n", name.__s);
+                  global->setFunction(slot,&abc.mMethods[trait.index]);
                   break;
-               case Trait_Const:
-                  {
-                  printf(" script const %s %s\n",name.__s, abc.getConst(trait)->toString().__s);
-                  }
+               case Trait_Class:
+                  // Set by the script init, through initproperty
                   break;
+               default:
+                  DBGLOG(" script accessor %s not supported\n", name.__s);
              }
           }
       }
 
       int entry = abc.mScriptInfo[ abc.mScriptInfo.size()-1 ].init;
-
-      CreateABCContext(new ABCGlobalObject(abcInstance));
-      ScriptableCall0(&abc.mMethods[entry],0);
+      CallMethod(&abc.mMethods[entry],0,0,0);
    }
    catch (Dynamic d)
    {
@@ -25,7 +25,7 @@ typedef int64_t __int64;
 #include <map>
 #include <time.h>
 
-void __hx_stack_set_last_exception();
+void __hx_stack_set_last_exception(hx::Object *inException);
 
 namespace hx
 {
@@ -33,7 +33,7 @@ namespace hx
 Dynamic Throw(Dynamic inDynamic)
 {
    #ifdef HXCPP_STACK_TRACE
-   __hx_stack_set_last_exception();
+   __hx_stack_set_last_exception(inDynamic.mPtr);
    #endif
    throw inDynamic;
    return null();
@@ -3,6 +3,14 @@
 #include <hx/Thread.h>
 #include <time.h>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#endif
+
 #ifdef HX_WINRT
 using namespace Windows::Foundation;
 using namespace Windows::System::Threading;
@@ -17,132 +25,592 @@ static int g_nextThreadNumber = 1;
 
 
 // --- Deque ----------------------------------------------------------
+//
+// Lock-free multi-producer/multi-consumer queue made of fixed-size segments.
+// Producers claim a slot with a fetch-and-add on the tail segment and consumers
+//  claim one on the head segment, swapping in sTakenItem.  Segments are only
+//  released or reused during a collection, when no thread can be part way through
+//  an operation (nothing here allocates from the GC, so there is no safe point
+//  inside), which avoids the usual reclamation/ABA problems.
+// Segments are malloc'd, so growth is reported to the collector (after the push, where
+//  collecting is safe) to make up for it not seeing them.  Spares beyond
+//  DEQUE_MAX_SPARES are freed when recycled.
+// PushFront goes to a separate ring, a Chase-Lev work-stealing deque, which is drained
+//  first, newest first.  Steal takes from its other end, oldest first, with a single
+//  cas, for a thread pool's idle workers.  The owner end of the ring is unlocked when
+//  the deque is created front-owned (only one thread pushes to and pops the front, as
+//  a pool worker does with its own queue), and otherwise serialised with mFrontLock.
+//  The ring is indexed by free-running counters and doubles when full; replaced rings
+//  are retired and freed during a collection, like the segments.
+// A single-consumer deque (eg. a thread's message queue) pops with plain loads and
+//  stores instead, and must only be popped by one thread.  A bounded deque makes
+//  producers wait while it holds its capacity.
+
+#define DEQUE_NODE_SIZE 256
+#define DEQUE_SPINS     100
+#define DEQUE_MAX_SPARES 4
+#define DEQUE_RING_SIZE  32
+
+static char sNullItem;
+static char sTakenItem;
+
+struct DequeNode
+{
+	void * volatile     items[DEQUE_NODE_SIZE];
+	volatile int        enqIdx;
+	volatile int        deqIdx;
+	DequeNode *volatile next;
+	DequeNode           *retiredNext;
+};
+
+struct DequeRing
+{
+	int             mask;
+	DequeRing       *retiredNext;
+	void * volatile items[1];
+
+	static DequeRing *Create(int inSize)
+	{
+		DequeRing *ring = (DequeRing *)calloc(1,Bytes(inSize));
+		ring->mask = inSize-1;
+		return ring;
+	}
+	static int Bytes(int inSize) { return sizeof(DequeRing) + (inSize-1)*sizeof(void *); }
+	int Size() { return mask+1; }
+};
 
-struct Deque : public Array_obj<Dynamic>
+// The ring counters run freely and wrap, so only their difference is meaningful
+static inline int RingCount(int inTop,int inBottom) { return (int)((unsigned int)inBottom - (unsigned int)inTop); }
+
+struct Deque : public hx::Object
 {
-	Deque() : Array_obj<Dynamic>(0,0) { }
+	Deque(int inCapacity,bool inSingleConsumer,bool inFrontOwned) :
+		mRetired(0), mSpare(0), mSpareCount(0), mNodeCount(0), mRetiredRings(0), mTop(0), mBottom(0),
+		mFrontOwned(inFrontOwned), mWaiting(0),
+		mCapacity(inCapacity), mCount(0), mSpaceWaiting(0), mSingleConsumer(inSingleConsumer)
+	{
+		int grown = 0;
+		mHead = mTail = NewNode(0,grown);
+		mRing = DequeRing::Create(DEQUE_RING_SIZE);
+	}
 
-	static Deque *Create()
+	static Deque *Create(int inCapacity=0,bool inSingleConsumer=false,bool inFrontOwned=false)
 	{
-		Deque *result = new Deque();
+		Deque *result = new Deque(inCapacity,inSingleConsumer,inFrontOwned);
 		result->mFinalizer = new hx::InternalFinalizer(result);
 		result->mFinalizer->mFinalizer = clean;
+		hx::GCChangeExternalMemory(sizeof(DequeNode) + DequeRing::Bytes(DEQUE_RING_SIZE));
 		return result;
 	}
 	static void clean(hx::Object *inObj)
 	{
-		Deque *d = dynamic_cast<Deque *>(inObj);
-		if (d) d->Clean();
+		Deque *d = hx::DynamicCast<Deque>(inObj);
+		if (d)
+		{
+			d->Clean();
+			d->FreeNodes();
+		}
 	}
 	void Clean()
 	{
-		#ifdef HX_WINDOWS
-		mMutex.Clean();
-		#endif
+		mFrontLock.Clean();
 		mSemaphore.Clean();
+		mSpace.Clean();
+	}
+	void FreeNodes()
+	{
+		FreeList(mRetired);
+		FreeList(mSpare);
+		for(DequeNode *n = mHead; n; )
+		{
+			DequeNode *next = n->next;
+			free(n);
+			n = next;
+		}
+		mHead = mTail = 0;
+		mRetired = mSpare = 0;
+		hx::GCChangeExternalMemory(-mNodeCount*(int)sizeof(DequeNode));
+		mNodeCount = 0;
+		FreeRetiredRings();
+		if (mRing)
+		{
+			hx::GCChangeExternalMemory(-DequeRing::Bytes(mRing->Size()));
+			free(mRing);
+			mRing = 0;
+		}
 	}
 
-	void __Mark(hx::MarkContext *__inCtx)
+	void FreeRetiredRings()
 	{
-		Array_obj<Dynamic>::__Mark(__inCtx);
-		mFinalizer->Mark();
+		int freed = 0;
+		while(mRetiredRings)
+		{
+			DequeRing *ring = mRetiredRings;
+			mRetiredRings = ring->retiredNext;
+			freed += DequeRing::Bytes(ring->Size());
+			free(ring);
+		}
+		if (freed)
+			hx::GCChangeExternalMemory(-freed);
 	}
 
-   #ifdef HXCPP_VISIT_ALLOCS
-  	void __Visit(hx::VisitContext *__inCtx)
+	static void FreeList(DequeNode *inList)
 	{
-		Array_obj<Dynamic>::__Visit(__inCtx);
-		mFinalizer->Visit(__inCtx);
+		while(inList)
+		{
+			DequeNode *next = inList->retiredNext;
+			free(inList);
+			inList = next;
+		}
 	}
-   #endif
 
+	// Adds to ioGrown for a newly malloc'd node
+	DequeNode *NewNode(void *inFirst,int &ioGrown)
+	{
+		DequeNode *node = mSpare;
+		// Spares are only added during a collection, so a concurrent pop can not see ABA
+		while(node && !HxAtomicCasPtr((void * volatile *)&mSpare,node,node->retiredNext))
+			node = mSpare;
+		if (node)
+		{
+			HxAtomicAdd(&mSpareCount,-1);
+			memset(node,0,sizeof(DequeNode));
+		}
+		else
+		{
+			node = (DequeNode *)calloc(1,sizeof(DequeNode));
+			HxAtomicAdd(&mNodeCount,1);
+			ioGrown++;
+		}
+		if (inFirst)
+		{
+			node->items[0] = inFirst;
+			node->enqIdx = 1;
+		}
+		return node;
+	}
 
-	#ifdef HX_WINDOWS
-	MyMutex     mMutex;
-	void PushBack(Dynamic inValue)
+	// Returns the number of nodes malloc'd
+	int Enqueue(void *inItem)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mMutex);
-		hx::ExitGCFreeZone();
+		int grown = 0;
+		while(true)
+		{
+			DequeNode *tail = mTail;
+			int idx = HxAtomicAdd(&tail->enqIdx,1);
+			if (idx<DEQUE_NODE_SIZE)
+			{
+				if (HxAtomicCasPtr(&tail->items[idx],0,inItem))
+					return grown;
+				continue;
+			}
+			if (tail!=mTail)
+				continue;
+			DequeNode *next = tail->next;
+			if (!next)
+			{
+				DequeNode *node = NewNode(inItem,grown);
+				if (HxAtomicCasPtr((void * volatile *)&tail->next,0,node))
+				{
+					HxAtomicCasPtr((void * volatile *)&mTail,tail,node);
+					return grown;
+				}
+				free(node);
+				HxAtomicAdd(&mNodeCount,-1);
+				grown--;
+			}
+			else
+				HxAtomicCasPtr((void * volatile *)&mTail,tail,next);
+		}
+	}
 
-		push(inValue);
-		mSemaphore.Set();
+	bool Dequeue(Dynamic &outValue)
+	{
+		while(true)
+		{
+			DequeNode *head = mHead;
+			if (head->deqIdx>=head->enqIdx && !head->next)
+				return false;
+			int idx = HxAtomicAdd(&head->deqIdx,1);
+			if (idx<DEQUE_NODE_SIZE)
+			{
+				void *item = HxAtomicExchangePtr(&head->items[idx],&sTakenItem);
+				if (!item)
+					continue;
+				ToDynamic(item,outValue);
+				return true;
+			}
+			DequeNode *next = head->next;
+			if (!next)
+				return false;
+			if (HxAtomicCasPtr((void * volatile *)&mHead,head,next))
+				Retire(head);
+		}
 	}
-	void PushFront(Dynamic inValue)
+
+	bool DequeueSingle(Dynamic &outValue)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mMutex);
-		hx::ExitGCFreeZone();
+		while(true)
+		{
+			DequeNode *head = mHead;
+			int idx = head->deqIdx;
+			if (idx<DEQUE_NODE_SIZE)
+			{
+				void *item = HxAtomicLoadAcquirePtr(&head->items[idx]);
+				if (!item)
+				{
+					if (idx>=head->enqIdx)
+						return false;
+					// Claimed but not written yet - take the slot so the producer goes elsewhere
+					if (HxAtomicCasPtr(&head->items[idx],0,&sTakenItem))
+					{
+						head->deqIdx = idx+1;
+						continue;
+					}
+					item = head->items[idx];
+				}
+				head->items[idx] = &sTakenItem;
+				head->deqIdx = idx+1;
+				ToDynamic(item,outValue);
+				return true;
+			}
+			DequeNode *next = head->next;
+			if (!next)
+				return false;
+			mHead = next;
+			Retire(head);
+		}
+	}
 
-		unshift(inValue);
-		mSemaphore.Set();
+	void Retire(DequeNode *inNode)
+	{
+		DequeNode *retired;
+		do {
+			retired = mRetired;
+			inNode->retiredNext = retired;
+		} while(!HxAtomicCasPtr((void * volatile *)&mRetired,retired,inNode));
 	}
 
-	
-	Dynamic PopFront(bool inBlock)
+	// Owner end of the ring - only one thread at a time, see LockFront.
+	//  Returns the number of bytes malloc'd for a bigger ring.
+	int FrontPush(void *inItem)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mMutex);
-		if (!inBlock)
+		int b = mBottom;
+		int t = mTop;
+		DequeRing *ring = mRing;
+		int grown = 0;
+		if (RingCount(t,b)>ring->mask)
 		{
-			hx::ExitGCFreeZone();
-			return shift();
+			DequeRing *bigger = DequeRing::Create(ring->Size()*2);
+			for(unsigned int i=t; i!=(unsigned int)b; i++)
+				bigger->items[i & bigger->mask] = ring->items[i & ring->mask];
+			// Thieves may still be reading the old ring, so it is kept until a collection
+			ring->retiredNext = mRetiredRings;
+			mRetiredRings = ring;
+			HxAtomicStoreReleasePtr((void * volatile *)&mRing,bigger);
+			grown = DequeRing::Bytes(bigger->Size());
+			ring = bigger;
 		}
-		// Ok - wait for something on stack...
-		while(!length)
+		ring->items[b & ring->mask] = inItem;
+		// The item must be visible before the thieves see the new bottom
+		HxMemoryBarrier();
+		mBottom = b+1;
+		return grown;
+	}
+
+	bool FrontPop(void *&outItem)
+	{
+		int b = mBottom-1;
+		DequeRing *ring = mRing;
+		// Full barrier - the bottom must be published before the top is read
+		HxAtomicExchange(&mBottom,b);
+		int t = mTop;
+		int count = RingCount(t,b);
+		if (count<0)
 		{
-			mSemaphore.Reset();
-			lock.Unlock();
-			mSemaphore.Wait();
-			lock.Lock();
+			mBottom = b+1;
+			return false;
 		}
-		hx::ExitGCFreeZone();
-		if (length==1)
-			mSemaphore.Reset();
-		return shift();
+		outItem = ring->items[b & ring->mask];
+		if (count>0)
+			return true;
+		// The last item - race the thieves for it
+		bool won = HxAtomicCas(&mTop,t,t+1);
+		mBottom = b+1;
+		return won;
 	}
-	#else
+
+	// Any thread
+	bool FrontSteal(void *&outItem)
+	{
+		while(true)
+		{
+			int t = mTop;
+			HxMemoryBarrier();
+			int b = mBottom;
+			if (RingCount(t,b)<=0)
+				return false;
+			DequeRing *ring = (DequeRing *)HxAtomicLoadAcquirePtr((void * volatile *)&mRing);
+			void *item = ring->items[t & ring->mask];
+			if (HxAtomicCas(&mTop,t,t+1))
+			{
+				outItem = item;
+				return true;
+			}
+		}
+	}
+
+	// Nothing inside the lock reaches a safe point, so it needs no GC-free zone
+	void LockFront() { if (!mFrontOwned) mFrontLock.Lock(); }
+	void UnlockFront() { if (!mFrontOwned) mFrontLock.Unlock(); }
+
+	static void ToDynamic(void *inItem,Dynamic &outValue)
+	{
+		outValue = inItem==&sNullItem ? 0 : (hx::Object *)inItem;
+	}
+
+	void ReserveSpace()
+	{
+		for(int spin=0; ; spin++)
+		{
+			int count = mCount;
+			if (count<mCapacity)
+			{
+				if (!HxAtomicCas(&mCount,count,count+1))
+					continue;
+				// Sets can coalesce, so pass the wake on if there is more room
+				if (mSpaceWaiting>0 && count+1<mCapacity)
+					mSpace.Set();
+				return;
+			}
+			if (spin<DEQUE_SPINS)
+				continue;
+
+			HxAtomicAdd(&mSpaceWaiting,1);
+			if (mCount>=mCapacity)
+			{
+				hx::EnterGCFreeZone();
+				mSpace.Wait();
+				hx::ExitGCFreeZone();
+			}
+			HxAtomicAdd(&mSpaceWaiting,-1);
+			spin = 0;
+		}
+	}
+
+	void ReleaseSpace()
+	{
+		HxAtomicAdd(&mCount,-1);
+		if (mSpaceWaiting>0)
+			mSpace.Set();
+	}
+
+	bool TryPop(Dynamic &outValue)
+	{
+		if (!TryPopItem(outValue))
+			return false;
+		if (mCapacity)
+			ReleaseSpace();
+		return true;
+	}
+
+	bool TryPopItem(Dynamic &outValue)
+	{
+		if (RingCount(mTop,mBottom)>0)
+		{
+			void *item = 0;
+			LockFront();
+			bool popped = FrontPop(item);
+			UnlockFront();
+			if (popped)
+			{
+				ToDynamic(item,outValue);
+				return true;
+			}
+		}
+		return mSingleConsumer ? DequeueSingle(outValue) : Dequeue(outValue);
+	}
+
+	bool Steal(Dynamic &outValue)
+	{
+		if (!StealItem(outValue))
+			return false;
+		if (mCapacity)
+			ReleaseSpace();
+		return true;
+	}
+
+	bool StealItem(Dynamic &outValue)
+	{
+		if (Dequeue(outValue))
+			return true;
+		void *item = 0;
+		if (!FrontSteal(item))
+			return false;
+		ToDynamic(item,outValue);
+		return true;
+	}
+
+	bool IsEmpty()
+	{
+		DequeNode *head = mHead;
+		return RingCount(mTop,mBottom)<=0 && head->deqIdx>=head->enqIdx && !head->next;
+	}
+
+	void Wake()
+	{
+		if (mWaiting>0)
+			mSemaphore.Set();
+	}
+
 	void PushBack(Dynamic inValue)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mSemaphore);
-		hx::ExitGCFreeZone();
-		push(inValue);
-		mSemaphore.QSet();
+		if (mCapacity)
+			ReserveSpace();
+		int grown = Enqueue(inValue.mPtr ? (void *)inValue.mPtr : (void *)&sNullItem);
+		Wake();
+		if (grown)
+			hx::GCChangeExternalMemory(grown*(int)sizeof(DequeNode));
 	}
 	void PushFront(Dynamic inValue)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mSemaphore);
-		hx::ExitGCFreeZone();
-		unshift(inValue);
-		mSemaphore.QSet();
+		if (mCapacity)
+			ReserveSpace();
+		LockFront();
+		int grown = FrontPush(inValue.mPtr ? (void *)inValue.mPtr : (void *)&sNullItem);
+		UnlockFront();
+		Wake();
+		if (grown)
+			hx::GCChangeExternalMemory(grown);
 	}
 
-	
 	Dynamic PopFront(bool inBlock)
 	{
-		hx::EnterGCFreeZone();
-		AutoLock lock(mSemaphore);
-		while(inBlock && !length)
-			mSemaphore.QWait();
-		hx::ExitGCFreeZone();
-		return shift();
+		Dynamic result;
+		for(int spin=0; ; spin++)
+		{
+			if (TryPop(result))
+			{
+				// Sets can coalesce, so pass the wake on if there is more to do
+				if (!IsEmpty())
+					Wake();
+				return result;
+			}
+			if (!inBlock)
+				return null();
+			if (spin<DEQUE_SPINS)
+				continue;
+
+			HxAtomicAdd(&mWaiting,1);
+			if (TryPop(result))
+			{
+				HxAtomicAdd(&mWaiting,-1);
+				return result;
+			}
+			hx::EnterGCFreeZone();
+			mSemaphore.Wait();
+			hx::ExitGCFreeZone();
+			HxAtomicAdd(&mWaiting,-1);
+			spin = 0;
+		}
+		return result;
 	}
-	#endif
+
+	static inline bool IsObject(void *inItem)
+	{
+		return inItem && inItem!=&sNullItem && inItem!=&sTakenItem;
+	}
+
+	// Called while the world is stopped - safe to recycle retired segments here
+	void RecycleRetired()
+	{
+		int freed = 0;
+		while(mRetired)
+		{
+			DequeNode *node = mRetired;
+			mRetired = node->retiredNext;
+			if (mSpareCount>=DEQUE_MAX_SPARES)
+			{
+				free(node);
+				freed++;
+				continue;
+			}
+			node->retiredNext = mSpare;
+			mSpare = node;
+			mSpareCount++;
+		}
+		if (freed)
+		{
+			mNodeCount -= freed;
+			hx::GCChangeExternalMemory(-freed*(int)sizeof(DequeNode));
+		}
+		FreeRetiredRings();
+	}
+
+	void __Mark(hx::MarkContext *__inCtx)
+	{
+		RecycleRetired();
+		for(unsigned int i=mTop; i!=(unsigned int)mBottom; i++)
+		{
+			hx::Object *obj = (hx::Object *)mRing->items[i & mRing->mask];
+			if (IsObject(obj))
+				HX_MARK_OBJECT(obj);
+		}
+		for(DequeNode *n = mHead; n; n = n->next)
+			for(int i=0;i<DEQUE_NODE_SIZE;i++)
+			{
+				hx::Object *obj = (hx::Object *)n->items[i];
+				if (IsObject(obj))
+					HX_MARK_OBJECT(obj);
+			}
+		mFinalizer->Mark();
+	}
+
+   #ifdef HXCPP_VISIT_ALLOCS
+  	void __Visit(hx::VisitContext *__inCtx)
+	{
+		for(unsigned int i=mTop; i!=(unsigned int)mBottom; i++)
+			if (IsObject(mRing->items[i & mRing->mask]))
+				__inCtx->visitObject( (hx::Object **)&mRing->items[i & mRing->mask] );
+		for(DequeNode *n = mHead; n; n = n->next)
+			for(int i=0;i<DEQUE_NODE_SIZE;i++)
+				if (IsObject(n->items[i]))
+					__inCtx->visitObject( (hx::Object **)&n->items[i] );
+		mFinalizer->Visit(__inCtx);
+	}
+   #endif
+
+	DequeNode *volatile mHead;
+	DequeNode *volatile mTail;
+	DequeNode *volatile mRetired;
+	DequeNode *volatile mSpare;
+	volatile int        mSpareCount;
+	volatile int        mNodeCount;
+	DequeRing *volatile mRing;
+	DequeRing           *mRetiredRings;
+	volatile int        mTop;
+	volatile int        mBottom;
+	bool                mFrontOwned;
+	MyMutex             mFrontLock;
+	volatile int        mWaiting;
+	int                 mCapacity;
+	volatile int        mCount;
+	volatile int        mSpaceWaiting;
+	bool                mSingleConsumer;
 
 	hx::InternalFinalizer *mFinalizer;
 	MySemaphore mSemaphore;
+	MySemaphore mSpace;
 };
 
-Dynamic __hxcpp_deque_create()
+Dynamic __hxcpp_deque_create(int inCapacity,bool inSingleConsumer)
 {
-	return Deque::Create();
+	return Deque::Create(inCapacity>0 ? inCapacity : 0,inSingleConsumer);
 }
 
 void __hxcpp_deque_add(Dynamic q,Dynamic inVal)
 {
-	Deque *d = dynamic_cast<Deque *>(q.mPtr);
+	Deque *d = hx::DynamicCast<Deque>(q.mPtr);
 	if (!d)
 		throw HX_INVALID_OBJECT;
 	d->PushBack(inVal);
@@ -150,7 +618,7 @@ void __hxcpp_deque_add(Dynamic q,Dynamic inVal)
 
 void __hxcpp_deque_push(Dynamic q,Dynamic inVal)
 {
-	Deque *d = dynamic_cast<Deque *>(q.mPtr);
+	Deque *d = hx::DynamicCast<Deque>(q.mPtr);
 	if (!d)
 		throw HX_INVALID_OBJECT;
 	d->PushFront(inVal);
@@ -158,7 +626,7 @@ void __hxcpp_deque_push(Dynamic q,Dynamic inVal)
 
 Dynamic __hxcpp_deque_pop(Dynamic q,bool block)
 {
-	Deque *d = dynamic_cast<Deque *>(q.mPtr);
+	Deque *d = hx::DynamicCast<Deque>(q.mPtr);
 	if (!d)
 		throw HX_INVALID_OBJECT;
 	return d->PopFront(block);
@@ -175,12 +643,13 @@ public:
         : mFunction(inFunction), mThreadNumber(inThreadNumber), mTLS(0,0)
 	{
 		mSemaphore = new MySemaphore;
-		mDeque = Deque::Create();
+		// Only the thread itself reads its messages
+		mDeque = Deque::Create(0,true);
 	}
 	hxThreadInfo()
 	{
 		mSemaphore = 0;
-		mDeque = Deque::Create();
+		mDeque = Deque::Create(0,true);
 	}
     int GetThreadNumber() const
     {
@@ -249,6 +718,7 @@ THREAD_FUNC_TYPE hxThreadFunc( void *inInfo )
 	if ( info->mFunction.GetPtr() )
 	{
 		// Try ... catch
+		HX_TRACE_SCOPE("Thread");
 		info->mFunction->__run();
 	}
 
@@ -273,6 +743,7 @@ Dynamic __hxcpp_thread_create(Dynamic inStart)
 	hxThreadInfo *info = new hxThreadInfo(inStart, threadNumber);
 
 	hx::GCPrepareMultiThreaded();
+	HX_TRACE_INSTANT("ThreadCreate");
 
    #if defined(HX_WINRT)
 
@@ -328,7 +799,7 @@ Dynamic __hxcpp_thread_current()
 
 void __hxcpp_thread_send(Dynamic inThread, Dynamic inMessage)
 {
-	hxThreadInfo *info = dynamic_cast<hxThreadInfo *>(inThread.mPtr);
+	hxThreadInfo *info = hx::DynamicCast<hxThreadInfo>(inThread.mPtr);
 	if (!info)
 		throw HX_INVALID_OBJECT;
 	info->Send(inMessage);
@@ -382,7 +853,7 @@ public:
 
 	static void clean(hx::Object *inObj)
 	{
-		hxMutex *m = dynamic_cast<hxMutex *>(inObj);
+		hxMutex *m = hx::DynamicCast<hxMutex>(inObj);
 		if (m) m->mMutex.Clean();
 	}
 	bool Try()
@@ -412,21 +883,21 @@ Dynamic __hxcpp_mutex_create()
 }
 void __hxcpp_mutex_acquire(Dynamic inMutex)
 {
-	hxMutex *mutex = dynamic_cast<hxMutex *>(inMutex.mPtr);
+	hxMutex *mutex = hx::DynamicCast<hxMutex>(inMutex.mPtr);
 	if (!mutex)
 		throw HX_INVALID_OBJECT;
 	mutex->Acquire();
 }
 bool __hxcpp_mutex_try(Dynamic inMutex)
 {
-	hxMutex *mutex = dynamic_cast<hxMutex *>(inMutex.mPtr);
+	hxMutex *mutex = hx::DynamicCast<hxMutex>(inMutex.mPtr);
 	if (!mutex)
 		throw HX_INVALID_OBJECT;
 	return mutex->Try();
 }
 void __hxcpp_mutex_release(Dynamic inMutex)
 {
-	hxMutex *mutex = dynamic_cast<hxMutex *>(inMutex.mPtr);
+	hxMutex *mutex = hx::DynamicCast<hxMutex>(inMutex.mPtr);
 	if (!mutex)
 		throw HX_INVALID_OBJECT;
 	return mutex->Release();
@@ -473,7 +944,7 @@ public:
 
 	static void clean(hx::Object *inObj)
 	{
-		hxLock *l = dynamic_cast<hxLock *>(inObj);
+		hxLock *l = hx::DynamicCast<hxLock>(inObj);
 		if (l)
 		{
 			l->mNotEmpty.Clean();
@@ -532,20 +1003,1010 @@ Dynamic __hxcpp_lock_create()
 }
 bool __hxcpp_lock_wait(Dynamic inlock,double inTime)
 {
-	hxLock *lock = dynamic_cast<hxLock *>(inlock.mPtr);
+	hxLock *lock = hx::DynamicCast<hxLock>(inlock.mPtr);
 	if (!lock)
 		throw HX_INVALID_OBJECT;
 	return lock->Wait(inTime);
 }
 void __hxcpp_lock_release(Dynamic inlock)
 {
-	hxLock *lock = dynamic_cast<hxLock *>(inlock.mPtr);
+	hxLock *lock = hx::DynamicCast<hxLock>(inlock.mPtr);
 	if (!lock)
 		throw HX_INVALID_OBJECT;
 	lock->Release();
 }
 
 
+// --- Futex ------------------------------------------------------------------
+//
+// Wait until an int changes from an expected value, and wake such waiters.  Linux
+//  uses the futex syscall; elsewhere each thread parks its own semaphore in a
+//  hashed bucket.  Wakes may be spurious, so callers re-check their condition.
+
+struct hxThreadWaiter
+{
+	hxThreadWaiter() : mNext(0), mAddress(0) { }
+
+	hxThreadWaiter *mNext;
+	volatile int   *mAddress;
+	MySemaphore    mSemaphore;
+};
+
+DECLARE_TLS_DATA(hxThreadWaiter, tlsThreadWaiter);
+
+// One per thread, until the thread unregisters.  Also used as the thread's identity.
+static hxThreadWaiter *GetThreadWaiter()
+{
+	hxThreadWaiter *waiter = tlsThreadWaiter;
+	if (!waiter)
+	{
+		waiter = new hxThreadWaiter();
+		tlsThreadWaiter = waiter;
+	}
+	return waiter;
+}
+
+void __hxcpp_thread_release_waiter()
+{
+	hxThreadWaiter *waiter = tlsThreadWaiter;
+	if (waiter)
+	{
+		tlsThreadWaiter = 0;
+		waiter->mSemaphore.Clean();
+		delete waiter;
+	}
+}
+
+static double MonotonicNow()
+{
+	#if defined(HX_WINDOWS)
+	static LARGE_INTEGER freq;
+	if (!freq.QuadPart)
+		QueryPerformanceFrequency(&freq);
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return (double)now.QuadPart/freq.QuadPart;
+	#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase;
+	if (!timebase.denom)
+		mach_timebase_info(&timebase);
+	return (double)mach_absolute_time()*timebase.numer/timebase.denom*1e-9;
+	#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+	#endif
+}
+
+#ifdef __linux__
+
+// Returns false on timeout.  A negative timeout waits forever.
+static bool FutexWait(volatile int *inAddress,int inExpected,double inTimeout)
+{
+	struct timespec ts;
+	struct timespec *timeout = 0;
+	if (inTimeout>=0)
+	{
+		ts.tv_sec = (time_t)inTimeout;
+		ts.tv_nsec = (long)((inTimeout-ts.tv_sec)*1e9);
+		timeout = &ts;
+	}
+	int result = syscall(SYS_futex,inAddress,FUTEX_WAIT_PRIVATE,inExpected,timeout,0,0);
+	return !(result==-1 && errno==ETIMEDOUT);
+}
+
+static void FutexWake(volatile int *inAddress,int inCount)
+{
+	syscall(SYS_futex,inAddress,FUTEX_WAKE_PRIVATE,inCount,0,0,0);
+}
+
+#else
+
+#define FUTEX_BUCKETS 64
+
+struct FutexBucket
+{
+	FutexBucket() : mWaiters(0) { }
+
+	MyMutex        mLock;
+	hxThreadWaiter *mWaiters;
+};
+
+static FutexBucket sFutexBuckets[FUTEX_BUCKETS];
+
+static FutexBucket &GetFutexBucket(volatile int *inAddress)
+{
+	size_t key = (size_t)inAddress;
+	return sFutexBuckets[ ((key>>2) ^ (key>>9)) % FUTEX_BUCKETS ];
+}
+
+static bool FutexWait(volatile int *inAddress,int inExpected,double inTimeout)
+{
+	FutexBucket &bucket = GetFutexBucket(inAddress);
+	hxThreadWaiter *me = GetThreadWaiter();
+
+	bucket.mLock.Lock();
+	if (*inAddress!=inExpected)
+	{
+		bucket.mLock.Unlock();
+		return true;
+	}
+	me->mAddress = inAddress;
+	me->mNext = bucket.mWaiters;
+	bucket.mWaiters = me;
+	bucket.mLock.Unlock();
+
+	bool signalled = true;
+	if (inTimeout<0)
+		me->mSemaphore.Wait();
+	else
+		signalled = me->mSemaphore.WaitFor(inTimeout*1000.0);
+
+	// Still linked after a timeout or a stale set left over from an earlier wait
+	bool linked = false;
+	bucket.mLock.Lock();
+	for(hxThreadWaiter **w = &bucket.mWaiters; *w; w = &(*w)->mNext)
+		if (*w==me)
+		{
+			*w = me->mNext;
+			linked = true;
+			break;
+		}
+	bucket.mLock.Unlock();
+	return signalled || !linked;
+}
+
+static void FutexWake(volatile int *inAddress,int inCount)
+{
+	FutexBucket &bucket = GetFutexBucket(inAddress);
+	bucket.mLock.Lock();
+	hxThreadWaiter **w = &bucket.mWaiters;
+	while(*w && inCount>0)
+	{
+		hxThreadWaiter *waiter = *w;
+		if (waiter->mAddress==inAddress)
+		{
+			*w = waiter->mNext;
+			waiter->mSemaphore.Set();
+			inCount--;
+		}
+		else
+			w = &waiter->mNext;
+	}
+	bucket.mLock.Unlock();
+}
+
+#endif
+
+// Blocking waits leave the GC free to collect without us
+static bool FutexWaitFree(volatile int *inAddress,int inExpected,double inTimeout)
+{
+	hx::EnterGCFreeZone();
+	bool result = FutexWait(inAddress,inExpected,inTimeout);
+	hx::ExitGCFreeZone();
+	return result;
+}
+
+
+// --- FastMutex --------------------------------------------------------------
+//
+// Recursive mutex without OS objects or finalizer.  mState is 0 when free, 1 when
+//  held and 2 when held with (possible) sleepers.  Contended acquires spin first.
+
+#define SYNC_SPINS 100
+
+static void FutexLock(volatile int *ioState)
+{
+	if (HxAtomicCas(ioState,0,1))
+		return;
+	for(int spin=0;spin<SYNC_SPINS;spin++)
+		if (*ioState==0 && HxAtomicCas(ioState,0,1))
+			return;
+	if (HxAtomicExchange(ioState,2)!=0)
+	{
+		hx::EnterGCFreeZone();
+		do
+		{
+			FutexWait(ioState,2,-1);
+		} while(HxAtomicExchange(ioState,2)!=0);
+		hx::ExitGCFreeZone();
+	}
+}
+
+static void FutexUnlock(volatile int *ioState)
+{
+	if (HxAtomicAdd(ioState,-1)!=1)
+	{
+		HxAtomicExchange(ioState,0);
+		FutexWake(ioState,1);
+	}
+}
+
+class hxFastMutex : public hx::Object
+{
+public:
+	hxFastMutex() : mState(0), mOwner(0), mCount(0) { }
+
+	void Acquire()
+	{
+		hxThreadWaiter *me = GetThreadWaiter();
+		if (mOwner==me)
+		{
+			mCount++;
+			return;
+		}
+		FutexLock(&mState);
+		mOwner = me;
+		mCount = 1;
+	}
+
+	bool Try()
+	{
+		hxThreadWaiter *me = GetThreadWaiter();
+		if (mOwner==me)
+		{
+			mCount++;
+			return true;
+		}
+		if (!HxAtomicCas(&mState,0,1))
+			return false;
+		mOwner = me;
+		mCount = 1;
+		return true;
+	}
+
+	void Release()
+	{
+		if (mOwner!=GetThreadWaiter())
+			hx::Throw( HX_CSTRING("Mutex released by a thread that does not own it") );
+		if (--mCount>0)
+			return;
+		mOwner = 0;
+		FutexUnlock(&mState);
+	}
+
+	volatile int   mState;
+	hxThreadWaiter *volatile mOwner;
+	int            mCount;
+};
+
+
+// --- RWLock -----------------------------------------------------------------
+//
+// mState is the reader count, or -1 while a writer holds it.  Waiting writers hold
+//  off new readers.  Not recursive.
+
+class hxRWLock : public hx::Object
+{
+public:
+	hxRWLock() : mState(0), mWritersWaiting(0), mSleepers(0) { }
+
+	void ReadAcquire()
+	{
+		for(int spin=0; ;spin++)
+		{
+			int state = mState;
+			if (state>=0 && mWritersWaiting==0)
+			{
+				if (HxAtomicCas(&mState,state,state+1))
+					return;
+			}
+			else if (spin>=SYNC_SPINS)
+				Sleep(state);
+		}
+	}
+
+	void ReadRelease()
+	{
+		if (HxAtomicAdd(&mState,-1)==1 && mSleepers>0)
+			FutexWake(&mState,0x7fffffff);
+	}
+
+	void WriteAcquire()
+	{
+		HxAtomicAdd(&mWritersWaiting,1);
+		for(int spin=0; ;spin++)
+		{
+			int state = mState;
+			if (state==0)
+			{
+				if (HxAtomicCas(&mState,0,-1))
+					break;
+			}
+			else if (spin>=SYNC_SPINS)
+				Sleep(state);
+		}
+		HxAtomicAdd(&mWritersWaiting,-1);
+	}
+
+	void WriteRelease()
+	{
+		HxAtomicExchange(&mState,0);
+		if (mSleepers>0)
+			FutexWake(&mState,0x7fffffff);
+	}
+
+	void Sleep(int inState)
+	{
+		HxAtomicAdd(&mSleepers,1);
+		FutexWaitFree(&mState,inState,-1);
+		HxAtomicAdd(&mSleepers,-1);
+	}
+
+	volatile int mState;
+	volatile int mWritersWaiting;
+	volatile int mSleepers;
+};
+
+
+// --- Condition --------------------------------------------------------------
+//
+// Used with a FastMutex.  Waiters sleep on a sequence number bumped by each signal.
+
+class hxCondition : public hx::Object
+{
+public:
+	hxCondition() : mSeq(0) { }
+
+	// Returns false on timeout.  Like any condition variable, may wake spuriously.
+	bool Wait(hxFastMutex *inMutex,double inTimeout)
+	{
+		if (inMutex->mOwner!=GetThreadWaiter())
+			hx::Throw( HX_CSTRING("Condition waited on without holding its mutex") );
+		int seq = mSeq;
+		int count = inMutex->mCount;
+		inMutex->mCount = 0;
+		inMutex->mOwner = 0;
+		FutexUnlock(&inMutex->mState);
+
+		bool result = mSeq!=seq || FutexWaitFree(&mSeq,seq,inTimeout);
+
+		FutexLock(&inMutex->mState);
+		inMutex->mOwner = GetThreadWaiter();
+		inMutex->mCount = count;
+		return result;
+	}
+
+	void Signal()
+	{
+		HxAtomicAdd(&mSeq,1);
+		FutexWake(&mSeq,1);
+	}
+
+	void Broadcast()
+	{
+		HxAtomicAdd(&mSeq,1);
+		FutexWake(&mSeq,0x7fffffff);
+	}
+
+	volatile int mSeq;
+};
+
+
+// --- Latch ------------------------------------------------------------------
+
+class hxLatch : public hx::Object
+{
+public:
+	hxLatch(int inCount) : mCount(inCount) { }
+
+	void CountDown()
+	{
+		if (HxAtomicAdd(&mCount,-1)==1)
+			FutexWake(&mCount,0x7fffffff);
+	}
+
+	// Returns false on timeout
+	bool Wait(double inTimeout)
+	{
+		if (mCount<=0)
+			return true;
+		double stop = inTimeout<0 ? 0 : MonotonicNow() + inTimeout;
+		bool result = true;
+		hx::EnterGCFreeZone();
+		int count;
+		while( (count=mCount)>0 )
+		{
+			double wait = -1;
+			if (inTimeout>=0)
+			{
+				wait = stop - MonotonicNow();
+				if (wait<=0)
+				{
+					result = false;
+					break;
+				}
+			}
+			FutexWait(&mCount,count,wait);
+		}
+		hx::ExitGCFreeZone();
+		return result;
+	}
+
+	volatile int mCount;
+};
+
+
+Dynamic __hxcpp_fast_mutex_create()
+{
+	return new hxFastMutex;
+}
+void __hxcpp_fast_mutex_acquire(Dynamic inMutex)
+{
+	hxFastMutex *mutex = hx::DynamicCast<hxFastMutex>(inMutex.mPtr);
+	if (!mutex)
+		throw HX_INVALID_OBJECT;
+	mutex->Acquire();
+}
+bool __hxcpp_fast_mutex_try(Dynamic inMutex)
+{
+	hxFastMutex *mutex = hx::DynamicCast<hxFastMutex>(inMutex.mPtr);
+	if (!mutex)
+		throw HX_INVALID_OBJECT;
+	return mutex->Try();
+}
+void __hxcpp_fast_mutex_release(Dynamic inMutex)
+{
+	hxFastMutex *mutex = hx::DynamicCast<hxFastMutex>(inMutex.mPtr);
+	if (!mutex)
+		throw HX_INVALID_OBJECT;
+	mutex->Release();
+}
+
+Dynamic __hxcpp_rwlock_create()
+{
+	return new hxRWLock;
+}
+void __hxcpp_rwlock_read_acquire(Dynamic inLock)
+{
+	hxRWLock *lock = hx::DynamicCast<hxRWLock>(inLock.mPtr);
+	if (!lock)
+		throw HX_INVALID_OBJECT;
+	lock->ReadAcquire();
+}
+void __hxcpp_rwlock_read_release(Dynamic inLock)
+{
+	hxRWLock *lock = hx::DynamicCast<hxRWLock>(inLock.mPtr);
+	if (!lock)
+		throw HX_INVALID_OBJECT;
+	lock->ReadRelease();
+}
+void __hxcpp_rwlock_write_acquire(Dynamic inLock)
+{
+	hxRWLock *lock = hx::DynamicCast<hxRWLock>(inLock.mPtr);
+	if (!lock)
+		throw HX_INVALID_OBJECT;
+	lock->WriteAcquire();
+}
+void __hxcpp_rwlock_write_release(Dynamic inLock)
+{
+	hxRWLock *lock = hx::DynamicCast<hxRWLock>(inLock.mPtr);
+	if (!lock)
+		throw HX_INVALID_OBJECT;
+	lock->WriteRelease();
+}
+
+Dynamic __hxcpp_condition_create()
+{
+	return new hxCondition;
+}
+bool __hxcpp_condition_wait(Dynamic inCondition,Dynamic inMutex,double inTimeout)
+{
+	hxCondition *condition = hx::DynamicCast<hxCondition>(inCondition.mPtr);
+	hxFastMutex *mutex = hx::DynamicCast<hxFastMutex>(inMutex.mPtr);
+	if (!condition || !mutex)
+		throw HX_INVALID_OBJECT;
+	return condition->Wait(mutex,inTimeout);
+}
+void __hxcpp_condition_signal(Dynamic inCondition)
+{
+	hxCondition *condition = hx::DynamicCast<hxCondition>(inCondition.mPtr);
+	if (!condition)
+		throw HX_INVALID_OBJECT;
+	condition->Signal();
+}
+void __hxcpp_condition_broadcast(Dynamic inCondition)
+{
+	hxCondition *condition = hx::DynamicCast<hxCondition>(inCondition.mPtr);
+	if (!condition)
+		throw HX_INVALID_OBJECT;
+	condition->Broadcast();
+}
+
+Dynamic __hxcpp_latch_create(int inCount)
+{
+	return new hxLatch(inCount);
+}
+void __hxcpp_latch_count_down(Dynamic inLatch)
+{
+	hxLatch *latch = hx::DynamicCast<hxLatch>(inLatch.mPtr);
+	if (!latch)
+		throw HX_INVALID_OBJECT;
+	latch->CountDown();
+}
+bool __hxcpp_latch_wait(Dynamic inLatch,double inTimeout)
+{
+	hxLatch *latch = hx::DynamicCast<hxLatch>(inLatch.mPtr);
+	if (!latch)
+		throw HX_INVALID_OBJECT;
+	return latch->Wait(inTimeout);
+}
+int __hxcpp_latch_count(Dynamic inLatch)
+{
+	hxLatch *latch = hx::DynamicCast<hxLatch>(inLatch.mPtr);
+	if (!latch)
+		throw HX_INVALID_OBJECT;
+	return latch->mCount;
+}
+
+
+// --- Atomics ----------------------------------------------------------------
+//
+// Boxed values for __hxcpp_atomic_*.  Loads are acquire, stores release and the
+//  read-modify-write operations are full barriers.  Updates never contain a GC safe
+//  point, so a collection always sees either the old or the new object reference.
+
+class hxAtomicInt : public hx::Object
+{
+public:
+	hxAtomicInt(int inValue) : mValue(inValue) { }
+
+	volatile int mValue;
+};
+
+class hxAtomicInt64 : public hx::Object
+{
+public:
+	hxAtomicInt64(long long inValue) { *Value() = inValue; }
+
+	// GC allocations are only 4-byte aligned on 32-bit targets
+	volatile long long *Value() { return (volatile long long *)( ((size_t)mBuffer + 7) & ~(size_t)7 ); }
+
+	char mBuffer[16];
+};
+
+class hxAtomicObject : public hx::Object
+{
+public:
+	hxAtomicObject(hx::Object *inValue) : mValue(inValue) { }
+
+	void __Mark(hx::MarkContext *__inCtx) { HX_MARK_OBJECT(mValue); }
+   #ifdef HXCPP_VISIT_ALLOCS
+	void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_OBJECT(mValue); }
+   #endif
+
+	hx::Object *volatile mValue;
+};
+
+template<typename T>
+static T *AtomicCast(Dynamic &inAtomic)
+{
+	T *result = hx::DynamicCast<T>(inAtomic.mPtr);
+	if (!result)
+		throw HX_INVALID_OBJECT;
+	return result;
+}
+
+
+Dynamic __hxcpp_atomic_int_create(int inValue)
+{
+	return new hxAtomicInt(inValue);
+}
+int __hxcpp_atomic_int_load(Dynamic inAtomic)
+{
+	int result = AtomicCast<hxAtomicInt>(inAtomic)->mValue;
+	HxMemoryBarrier();
+	return result;
+}
+void __hxcpp_atomic_int_store(Dynamic inAtomic,int inValue)
+{
+	hxAtomicInt *atomic = AtomicCast<hxAtomicInt>(inAtomic);
+	HxMemoryBarrier();
+	atomic->mValue = inValue;
+}
+int __hxcpp_atomic_int_add(Dynamic inAtomic,int inDelta)
+{
+	return HxAtomicAdd(&AtomicCast<hxAtomicInt>(inAtomic)->mValue,inDelta);
+}
+int __hxcpp_atomic_int_exchange(Dynamic inAtomic,int inValue)
+{
+	return HxAtomicExchange(&AtomicCast<hxAtomicInt>(inAtomic)->mValue,inValue);
+}
+bool __hxcpp_atomic_int_cas(Dynamic inAtomic,int inExpected,int inValue)
+{
+	return HxAtomicCas(&AtomicCast<hxAtomicInt>(inAtomic)->mValue,inExpected,inValue);
+}
+
+static inline long long Int64Of(int inHigh,int inLow)
+{
+	return (long long)( ((unsigned long long)(unsigned int)inHigh<<32) | (unsigned int)inLow );
+}
+static Array<int> Int64Halves(long long inValue)
+{
+	Array<int> result = Array_obj<int>::__new(2,2);
+	result[0] = (int)(inValue>>32);
+	result[1] = (int)inValue;
+	return result;
+}
+
+Dynamic __hxcpp_atomic_int64_create(int inHigh,int inLow)
+{
+	return new hxAtomicInt64(Int64Of(inHigh,inLow));
+}
+Array<int> __hxcpp_atomic_int64_load(Dynamic inAtomic)
+{
+	return Int64Halves(HxAtomicLoad64(AtomicCast<hxAtomicInt64>(inAtomic)->Value()));
+}
+void __hxcpp_atomic_int64_store(Dynamic inAtomic,int inHigh,int inLow)
+{
+	HxAtomicExchange64(AtomicCast<hxAtomicInt64>(inAtomic)->Value(),Int64Of(inHigh,inLow));
+}
+Array<int> __hxcpp_atomic_int64_add(Dynamic inAtomic,int inHigh,int inLow)
+{
+	return Int64Halves(HxAtomicAdd64(AtomicCast<hxAtomicInt64>(inAtomic)->Value(),Int64Of(inHigh,inLow)));
+}
+Array<int> __hxcpp_atomic_int64_exchange(Dynamic inAtomic,int inHigh,int inLow)
+{
+	return Int64Halves(HxAtomicExchange64(AtomicCast<hxAtomicInt64>(inAtomic)->Value(),Int64Of(inHigh,inLow)));
+}
+bool __hxcpp_atomic_int64_cas(Dynamic inAtomic,int inExpectedHigh,int inExpectedLow,int inHigh,int inLow)
+{
+	return HxAtomicCas64(AtomicCast<hxAtomicInt64>(inAtomic)->Value(),Int64Of(inExpectedHigh,inExpectedLow),
+	                     Int64Of(inHigh,inLow));
+}
+
+Dynamic __hxcpp_atomic_object_create(Dynamic inValue)
+{
+	return new hxAtomicObject(inValue.mPtr);
+}
+Dynamic __hxcpp_atomic_object_load(Dynamic inAtomic)
+{
+	hx::Object *result = AtomicCast<hxAtomicObject>(inAtomic)->mValue;
+	HxMemoryBarrier();
+	return result;
+}
+void __hxcpp_atomic_object_store(Dynamic inAtomic,Dynamic inValue)
+{
+	hxAtomicObject *atomic = AtomicCast<hxAtomicObject>(inAtomic);
+	HxMemoryBarrier();
+	atomic->mValue = inValue.mPtr;
+}
+Dynamic __hxcpp_atomic_object_exchange(Dynamic inAtomic,Dynamic inValue)
+{
+	hxAtomicObject *atomic = AtomicCast<hxAtomicObject>(inAtomic);
+	return (hx::Object *)HxAtomicExchangePtr((void * volatile *)&atomic->mValue,inValue.mPtr);
+}
+// Compares object identity, not value
+bool __hxcpp_atomic_object_cas(Dynamic inAtomic,Dynamic inExpected,Dynamic inValue)
+{
+	hxAtomicObject *atomic = AtomicCast<hxAtomicObject>(inAtomic);
+	return HxAtomicCasPtr((void * volatile *)&atomic->mValue,inExpected.mPtr,inValue.mPtr);
+}
+
+void __hxcpp_atomic_fence()
+{
+	HxMemoryBarrier();
+}
+
+
+// --- ThreadPool ------------------------------------------------------------
+//
+// Fixed set of GC-registered worker threads, each with its own Deque.  A worker runs
+//  the tasks it submits newest first from the front ring, which only it pushes to and
+//  pops, so the deque is front-owned and takes no lock.  Idle workers steal the oldest
+//  from the other queues with a cas.  Tasks submitted from outside the pool go to the
+//  back of a queue.  Every submit bumps mWork, so a worker that found nothing spins briefly on
+//  that one word, then parks on it with a futex (in a GC-free zone).  Submitting a
+//  task is an enqueue plus a wake when some worker is parked.
+// Shutdown lets the workers drain the queues, and returns once they have all left
+//  their loop.
+// Getting a future that has not started runs it inline, and a worker waiting on one
+//  that has keeps running queued tasks, so tasks can wait on their subtasks.
+
+#define POOL_SPINS     64
+#define POOL_HELP_WAIT 0.001
+
+class hxFuture : public hx::Object
+{
+public:
+	hxFuture(Dynamic inFunc) : mFunc(inFunc), mFailed(false), mStarted(inFunc.mPtr ? 0 : 1),
+	                           mClaimed(0), mDone(0), mSleepers(0) { }
+
+	bool IsDone() { return mDone; }
+
+	// The queue entry may outlive a Get that ran the task inline
+	void Run()
+	{
+		if (HxAtomicCas(&mStarted,0,1))
+			Execute();
+	}
+
+	void Execute()
+	{
+		Dynamic func = mFunc;
+		mFunc = null();
+		try
+		{
+			Complete(func->__run(),false);
+		}
+		catch(Dynamic e)
+		{
+			Complete(e,true);
+		}
+	}
+
+	bool Complete(Dynamic inValue,bool inFailed)
+	{
+		if (!HxAtomicCas(&mClaimed,0,1))
+			return false;
+		mValue = inValue;
+		mFailed = inFailed;
+		HxAtomicExchange(&mDone,1);
+		if (mSleepers>0)
+			FutexWake(&mDone,0x7fffffff);
+		return true;
+	}
+
+	Dynamic Get();
+
+	void __Mark(hx::MarkContext *__inCtx)
+	{
+		HX_MARK_MEMBER(mFunc);
+		HX_MARK_MEMBER(mValue);
+	}
+   #ifdef HXCPP_VISIT_ALLOCS
+	void __Visit(hx::VisitContext *__inCtx)
+	{
+		HX_VISIT_MEMBER(mFunc);
+		HX_VISIT_MEMBER(mValue);
+	}
+   #endif
+
+	Dynamic      mFunc;
+	Dynamic      mValue;
+	bool         mFailed;
+	volatile int mStarted;
+	volatile int mClaimed;
+	volatile int mDone;
+	volatile int mSleepers;
+};
+
+
+class hxThreadPool;
+
+class hxPoolWorker : public hx::Object
+{
+public:
+	hxPoolWorker(hxThreadPool *inPool,int inIndex) : mPool(inPool), mIndex(inIndex) { }
+
+	Dynamic __run();
+
+	void __Mark(hx::MarkContext *__inCtx);
+   #ifdef HXCPP_VISIT_ALLOCS
+	void __Visit(hx::VisitContext *__inCtx);
+   #endif
+
+	hxThreadPool *mPool;
+	int          mIndex;
+};
+
+DECLARE_TLS_DATA(hxPoolWorker, tlsPoolWorker);
+
+
+class hxThreadPool : public hx::Object
+{
+public:
+	hxThreadPool(int inWorkers) : mQueues(0,inWorkers), mNext(0), mWork(0), mIdle(0),
+	                              mRunning(0), mShutdown(false)
+	{
+		for(int i=0;i<inWorkers;i++)
+			mQueues->push( Deque::Create(0,false,true) );
+		mWorkerCount = inWorkers;
+	}
+
+	void Start()
+	{
+		for(int i=0;i<mWorkerCount;i++)
+		{
+			HxAtomicAdd(&mRunning,1);
+			__hxcpp_thread_create( new hxPoolWorker(this,i) );
+		}
+	}
+
+	Deque *Queue(int inIndex) { return (Deque *)mQueues[inIndex].mPtr; }
+
+	void Submit(hxFuture *inTask)
+	{
+		hxPoolWorker *worker = tlsPoolWorker;
+		int q = (worker && worker->mPool==this) ? worker->mIndex :
+		           (unsigned int)HxAtomicAdd(&mNext,1) % mWorkerCount;
+		if (worker && worker->mPool==this)
+			Queue(q)->PushFront(inTask);
+		else
+			Queue(q)->PushBack(inTask);
+		// Full barrier, paired with the one on mIdle in WorkerLoop
+		HxAtomicAdd(&mWork,1);
+		if (mIdle>0)
+			FutexWake(&mWork,1);
+	}
+
+	hxFuture *Take(int inIndex)
+	{
+		Dynamic task = Queue(inIndex)->PopFront(false);
+		for(int i=1;!task.mPtr && i<mWorkerCount;i++)
+			Queue( (inIndex+i) % mWorkerCount )->Steal(task);
+		return (hxFuture *)task.mPtr;
+	}
+
+	void WorkerLoop(int inIndex)
+	{
+		while(true)
+		{
+			// Read before looking, so a submit that the look misses changes it
+			int work = mWork;
+			hxFuture *task = Take(inIndex);
+			if (task)
+			{
+				task->Run();
+				continue;
+			}
+			if (mShutdown)
+				break;
+
+			for(int spin=0; spin<POOL_SPINS && mWork==work; spin++) { }
+			if (mWork!=work)
+				continue;
+			HxAtomicAdd(&mIdle,1);
+			FutexWaitFree(&mWork,work,-1);
+			HxAtomicAdd(&mIdle,-1);
+		}
+		HxAtomicAdd(&mRunning,-1);
+		FutexWake(&mRunning,0x7fffffff);
+	}
+
+	// Waits for the workers, except the calling one if a task shuts its own pool down
+	void Shutdown()
+	{
+		mShutdown = true;
+		HxAtomicAdd(&mWork,1);
+		FutexWake(&mWork,0x7fffffff);
+
+		hxPoolWorker *worker = tlsPoolWorker;
+		int self = (worker && worker->mPool==this) ? 1 : 0;
+		for(int running=mRunning; running>self; running=mRunning)
+			FutexWaitFree(&mRunning,running,-1);
+	}
+
+	void __Mark(hx::MarkContext *__inCtx)
+	{
+		HX_MARK_MEMBER(mQueues);
+	}
+   #ifdef HXCPP_VISIT_ALLOCS
+	void __Visit(hx::VisitContext *__inCtx)
+	{
+		HX_VISIT_MEMBER(mQueues);
+	}
+   #endif
+
+	Array<Dynamic> mQueues;
+	int            mWorkerCount;
+	volatile int   mNext;
+	volatile int   mWork;
+	volatile int   mIdle;
+	volatile int   mRunning;
+	volatile bool  mShutdown;
+};
+
+Dynamic hxPoolWorker::__run()
+{
+	tlsPoolWorker = this;
+	mPool->WorkerLoop(mIndex);
+	tlsPoolWorker = 0;
+	return null();
+}
+
+Dynamic hxFuture::Get()
+{
+	// Nothing has started it, so run it here rather than wait for a worker - possibly this one
+	if (!mDone && HxAtomicCas(&mStarted,0,1))
+		Execute();
+	for(int spin=0;!mDone && spin<POOL_SPINS;spin++) { }
+	if (!mDone)
+	{
+		hxPoolWorker *worker = tlsPoolWorker;
+		HxAtomicAdd(&mSleepers,1);
+		while(!mDone)
+		{
+			// The running task may be waiting on queued work, so a worker keeps the pool going
+			if (worker)
+			{
+				hxFuture *task = worker->mPool->Take(worker->mIndex);
+				if (task)
+				{
+					task->Run();
+					continue;
+				}
+			}
+			hx::EnterGCFreeZone();
+			FutexWait(&mDone,0,worker ? POOL_HELP_WAIT : -1);
+			hx::ExitGCFreeZone();
+		}
+		HxAtomicAdd(&mSleepers,-1);
+	}
+	if (mFailed)
+		hx::Throw(mValue);
+	return mValue;
+}
+
+void hxPoolWorker::__Mark(hx::MarkContext *__inCtx)
+{
+	HX_MARK_OBJECT(mPool);
+}
+#ifdef HXCPP_VISIT_ALLOCS
+void hxPoolWorker::__Visit(hx::VisitContext *__inCtx)
+{
+	HX_VISIT_OBJECT(mPool);
+}
+#endif
+
+
+Dynamic __hxcpp_pool_create(int inWorkers)
+{
+	if (inWorkers<1)
+		inWorkers = 1;
+	hxThreadPool *pool = new hxThreadPool(inWorkers);
+	pool->Start();
+	return pool;
+}
+
+Dynamic __hxcpp_pool_submit(Dynamic inPool,Dynamic inFunc)
+{
+	hxThreadPool *pool = hx::DynamicCast<hxThreadPool>(inPool.mPtr);
+	if (!pool || pool->mShutdown)
+		throw HX_INVALID_OBJECT;
+	hxFuture *future = new hxFuture(inFunc);
+	pool->Submit(future);
+	return future;
+}
+
+void __hxcpp_pool_shutdown(Dynamic inPool)
+{
+	hxThreadPool *pool = hx::DynamicCast<hxThreadPool>(inPool.mPtr);
+	if (!pool)
+		throw HX_INVALID_OBJECT;
+	pool->Shutdown();
+}
+
+Dynamic __hxcpp_future_create()
+{
+	return new hxFuture(null());
+}
+
+bool __hxcpp_future_complete(Dynamic inFuture,Dynamic inValue,bool inFailed)
+{
+	hxFuture *future = hx::DynamicCast<hxFuture>(inFuture.mPtr);
+	if (!future)
+		throw HX_INVALID_OBJECT;
+	return future->Complete(inValue,inFailed);
+}
+
+bool __hxcpp_future_done(Dynamic inFuture)
+{
+	hxFuture *future = hx::DynamicCast<hxFuture>(inFuture.mPtr);
+	if (!future)
+		throw HX_INVALID_OBJECT;
+	return future->IsDone();
+}
+
+Dynamic __hxcpp_future_get(Dynamic inFuture)
+{
+	hxFuture *future = hx::DynamicCast<hxFuture>(inFuture.mPtr);
+	if (!future)
+		throw HX_INVALID_OBJECT;
+	return future->Get();
+}
+
+
 int __hxcpp_GetCurrentThreadNumber()
 {
     // Can't allow GetCurrentInfo() to create the main thread's info
@@ -0,0 +1,139 @@
+# Minimal ABC assembler, enough to write the benchmark methods by hand.
+# Opcodes are read from the interpreter's own table.
+import os, re, struct
+
+OPS = {}
+for line in open(os.path.join(os.path.dirname(os.path.abspath(__file__)),'..','..','src','hx','AbcOpCodes.h')):
+    m = re.match(r'DEFINE_OP\((\w+),(0x[0-9a-fA-F]+)\)', line)
+    if m: OPS[m.group(1)] = int(m.group(2),16)
+OPS['throw'] = OPS['throw_op']; OPS['typeof'] = OPS['typeof_op']
+
+def u30(v):
+    v &= 0xffffffff
+    out = b''
+    while True:
+        b = v & 0x7f; v >>= 7
+        if v: out += bytes([b|0x80])
+        else: return out + bytes([b])
+
+U8 = {'pushbyte','getscopeobject'}
+U30 = {'pushshort','pushint','pushuint','pushdouble','pushstring','getlocal','setlocal','kill','inclocal','declocal',
+       'inclocal_i','declocal_i','getslot','setslot','newarray','newobject','newclass','newcatch','call','construct',
+       'constructsuper','coerce','newfunction'}
+NAME = {'getlex','findpropstrict','findproperty','getproperty','setproperty','initproperty'}
+NAMEARGS = {'callproperty','callpropvoid','constructprop','callproplex'}
+BRANCH = {'jump','iftrue','iffalse','ifeq','ifne','ifstricteq','ifstrictne','iflt','ifle','ifgt','ifge','ifnlt','ifnle','ifngt','ifnge'}
+
+class Asm:
+    def __init__(s):
+        s.ints=[]; s.uints=[]; s.doubles=[]; s.strings=[]; s.nss=[]; s.nssets=[]; s.mns=[]
+        s.methods=[]; s.instances=[]; s.classes=[]; s.scripts=[]; s.bodies=[]
+    def _idx(s, pool, v):
+        if v not in pool: pool.append(v)
+        return pool.index(v)+1
+    def string(s,v): return s._idx(s.strings,v)
+    def int_(s,v): return s._idx(s.ints,v)
+    def double(s,v): return s._idx(s.doubles,v)
+    def ns(s,name='',kind=0x16): return s._idx(s.nss,(kind,s.string(name)))
+    def qname(s,name,nsname=''): return s._idx(s.mns,(0x07,s.ns(nsname),s.string(name)))
+    def mname(s,name,nss=('',)):
+        st = tuple(s.ns(n) for n in nss)
+        return s._idx(s.mns,(0x09,s.string(name),s._idx(s.nssets,st)))
+    def mnamel(s,nss=('',)):
+        st = tuple(s.ns(n) for n in nss)
+        return s._idx(s.mns,(0x1B,s._idx(s.nssets,st)))
+    def method(s,nparams,name='',flags=0,optionals=()):
+        f = flags | (0x08 if optionals else 0)
+        s.methods.append((nparams,s.string(name),f,optionals)); return len(s.methods)-1
+    def body(s,m,code,locals_,exceptions=(),max_stack=16,max_scope=8):
+        s.bodies.append((m,max_stack,locals_,0,max_scope,code,exceptions))
+
+    def assemble(s,code):
+        def size(ins):
+            op = ins[0]
+            if op == 'label': return 0
+            n = 1
+            if op in U8: n += 1
+            elif op in U30: n += len(u30(ins[1]))
+            elif op in NAME: n += len(u30(ins[1]))
+            elif op in NAMEARGS: n += len(u30(ins[1]))+len(u30(ins[2]))
+            elif op in BRANCH: n += 3
+            elif op == 'lookupswitch': n += 3 + len(u30(len(ins[2])-1)) + 3*len(ins[2])
+            return n
+        pos = {}; p = 0; starts=[]
+        for ins in code:
+            starts.append(p)
+            if ins[0]=='label': pos[ins[1]] = p
+            p += size(ins)
+        out = b''
+        for ins,start in zip(code,starts):
+            op = ins[0]
+            if op == 'label': continue
+            out += bytes([OPS[op]])
+            if op in U8: out += bytes([ins[1] & 0xff])
+            elif op in U30 or op in NAME: out += u30(ins[1])
+            elif op in NAMEARGS: out += u30(ins[1]) + u30(ins[2])
+            elif op in BRANCH:
+                off = pos[ins[1]] - (start+4); out += struct.pack('<i',off)[:3]
+            elif op == 'lookupswitch':
+                out += struct.pack('<i',pos[ins[1]]-start)[:3] + u30(len(ins[2])-1)
+                for l in ins[2]: out += struct.pack('<i',pos[l]-start)[:3]
+        return out, pos
+
+    def traits(s,ts):
+        out = u30(len(ts))
+        for t in ts:
+            kind = t[0]
+            if kind in ('slot','const'):
+                _,name,typ,slot = t[:4]; val = t[4] if len(t)>4 else None
+                out += u30(name) + bytes([0 if kind=='slot' else 6]) + u30(slot) + u30(typ)
+                if val is None: out += u30(0)
+                else: out += u30(val[1]) + bytes([val[0]])
+            elif kind in ('method','getter','setter'):
+                _,name,m = t; out += u30(name)+bytes([{'method':1,'getter':2,'setter':3}[kind]])+u30(0)+u30(m)
+            elif kind == 'class':
+                _,name,ci,slot = t; out += u30(name)+bytes([4])+u30(slot)+u30(ci)
+            elif kind == 'function':
+                _,name,m,slot = t; out += u30(name)+bytes([5])+u30(slot)+u30(m)
+        return out
+
+    def build(s):
+        def pool(items, enc):
+            if not items: return u30(0)
+            return u30(len(items)+1) + b''.join(enc(x) for x in items)
+        out = struct.pack('<HH',16,46)
+        out += pool(s.ints, lambda v: u30(v))
+        out += pool(s.uints, lambda v: u30(v))
+        out += pool(s.doubles, lambda v: struct.pack('<d',v))
+        out += pool(s.strings, lambda v: u30(len(v.encode()))+v.encode())
+        out += pool(s.nss, lambda v: bytes([v[0]])+u30(v[1]))
+        out += pool(s.nssets, lambda v: u30(len(v))+b''.join(u30(x) for x in v))
+        def mn(v):
+            if v[0]==0x07: return bytes([7])+u30(v[1])+u30(v[2])
+            if v[0]==0x09: return bytes([9])+u30(v[1])+u30(v[2])
+            if v[0]==0x1B: return bytes([0x1B])+u30(v[1])
+        out += pool(s.mns, mn)
+        out += u30(len(s.methods))
+        for (n,name,flags,opts) in s.methods:
+            out += u30(n)+u30(0)+b''.join(u30(0) for _ in range(n))+u30(name)+bytes([flags])
+            if opts:
+                out += u30(len(opts))
+                for kind,val in opts: out += u30(val)+bytes([kind])
+        out += u30(0) # metadata
+        out += u30(len(s.instances))
+        for (name,sup,iinit,ts) in s.instances:
+            out += u30(name)+u30(sup)+bytes([0])+u30(0)+u30(iinit)+s.traits(ts)
+        for (cinit,ts) in s.classes:
+            out += u30(cinit)+s.traits(ts)
+        out += u30(len(s.scripts))
+        for (init,ts) in s.scripts:
+            out += u30(init)+s.traits(ts)
+        out += u30(len(s.bodies))
+        for (m,ms,lc,isd,msd,code,exc) in s.bodies:
+            bc,pos = s.assemble(code)
+            out += u30(m)+u30(ms)+u30(lc)+u30(isd)+u30(msd)+u30(len(bc))+bc
+            out += u30(len(exc))
+            for (fr,to,tg,typ,var) in exc:
+                out += u30(pos[fr])+u30(pos[to])+u30(pos[tg])+u30(typ)+u30(var)
+            out += u30(0)
+        return out + b'\0\0\0\0\0\0\0\0\0\0'   # reader wants slack at the end
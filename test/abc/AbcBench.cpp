@@ -0,0 +1,146 @@
+// Times the methods in Bench.abc against the same code compiled by C++, then checks that
+//  scripts the interpreter can not run are refused when loaded.
+#include <hxcpp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+void __boot_all() { }
+
+namespace hx { void LoadABC(const unsigned char *inBytes, int inLen); }
+
+static double Now()
+{
+   struct timeval tv;
+   gettimeofday(&tv,0);
+   return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+static int Fib(int n) { return n<2 ? n : Fib(n-1) + Fib(n-2); }
+
+static int LoopI(int n)
+{
+   int s = 0;
+   for(int i=0;i<n;i++)
+      s = (int)((unsigned int)(s ^ (int)((unsigned int)i*7u)) + (unsigned int)i);
+   return s;
+}
+
+static double LoopD(int n)
+{
+   double s = 0;
+   for(int i=0;i<n;i++)
+      s += i*0.5;
+   return s;
+}
+
+static int gFailed = 0;
+
+static void Report(const char *inName,double inScript,double inScriptTime,double inNative,double inNativeTime)
+{
+   if (inScript!=inNative)
+      gFailed++;
+   printf("%-10s script %-16.15g %8.4fs   c++ %-16.15g %8.4fs   x%.0f%s\n", inName,
+          inScript, inScriptTime, inNative, inNativeTime,
+          inNativeTime>0 ? inScriptTime/inNativeTime : 0.0, inScript!=inNative ? "  MISMATCH" : "");
+}
+
+static bool Load(const char *inFile)
+{
+   FILE *file = fopen(inFile,"rb");
+   if (!file)
+   {
+      printf("Could not open %s\n", inFile);
+      gFailed++;
+      return false;
+   }
+   fseek(file,0,SEEK_END);
+   int len = ftell(file);
+   fseek(file,0,SEEK_SET);
+   unsigned char *bytes = (unsigned char *)malloc(len);
+   fread(bytes,1,len,file);
+   fclose(file);
+   hx::LoadABC(bytes,len);
+   return true;
+}
+
+// The loader reports the reason itself
+static void CheckRefused(const char *inFile)
+{
+   if (!Load(inFile))
+      return;
+   if (Class_obj::Resolve(HX_CSTRING("Refused")).mPtr)
+   {
+      printf("%s was not refused\n", inFile);
+      gFailed++;
+   }
+}
+
+static void Run(const char *inFile)
+{
+   if (!Load(inFile))
+      return;
+
+   Class bench = Class_obj::Resolve(HX_CSTRING("Bench"));
+   if (!bench.mPtr)
+   {
+      printf("Bench class not loaded\n");
+      gFailed++;
+      return;
+   }
+   Dynamic fib = bench->__Field(HX_CSTRING("fib"),true);
+   Dynamic loopi = bench->__Field(HX_CSTRING("loopi"),true);
+   Dynamic loopd = bench->__Field(HX_CSTRING("loopd"),true);
+
+   // Decode everything before timing
+   fib(2); loopi(2); loopd(2);
+
+   // volatile so the compiler can not fold the native calls
+   volatile int n = 30;
+   double t0 = Now();
+   double script = fib(n);
+   double t1 = Now();
+   volatile int native = Fib(n);
+   double t2 = Now();
+   Report("fib(30)",script,t1-t0,native,t2-t1);
+
+   n = 3000000;
+   t0 = Now();
+   script = loopi(n);
+   t1 = Now();
+   native = LoopI(n);
+   t2 = Now();
+   Report("loopi",script,t1-t0,native,t2-t1);
+
+   t0 = Now();
+   script = loopd(n);
+   t1 = Now();
+   volatile double nativeD = LoopD(n);
+   t2 = Now();
+   Report("loopd",script,t1-t0,nativeD,t2-t1);
+
+   Dynamic wide = bench->__Field(HX_CSTRING("wide"),true);
+   if ((int)wide(41)!=42)
+   {
+      printf("wide frame returned the wrong value\n");
+      gFailed++;
+   }
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+   try
+   {
+      Run(argc>1 ? argv[1] : "Bench.abc");
+      for(int i=2;i<argc;i++)
+         CheckRefused(argv[i]);
+   }
+   catch(Dynamic e)
+   {
+      printf("Error %s\n", e->toString().__s);
+      gFailed++;
+   }
+   return gFailed ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+# Writes Bench.abc: a Bench class whose static methods match those in AbcBench.cpp
+#  fib(n)   - recursive calls
+#  loopi(n) - int arithmetic on locals
+#  loopd(n) - Number arithmetic on locals
+#  wide(n)  - n+1, in a frame too big for the C stack
+# Next to it go two scripts that must be refused at load, each with a Refused class:
+#  Huge.abc        - a method declaring a stack deeper than the interpreter accepts
+#  NewFunction.abc - a method using newfunction, which the interpreter lacks
+import os, sys
+sys.path.insert(0,os.path.dirname(os.path.abspath(__file__)))
+from AbcAsm import Asm
+
+A = Asm()
+Q = A.qname
+OBJ = Q('Object'); BENCH = Q('Bench')
+FIB = Q('fib'); LOOPI = Q('loopi'); LOOPD = Q('loopd'); WIDE = Q('wide')
+
+m_script = A.method(0,'script')
+m_iinit = A.method(0,'Bench')
+m_cinit = A.method(0,'Bench$cinit')
+m_fib = A.method(1,'fib')
+m_loopi = A.method(1,'loopi')
+m_loopd = A.method(1,'loopd')
+m_wide = A.method(1,'wide')
+
+A.instances.append((BENCH,OBJ,m_iinit,[]))
+A.classes.append((m_cinit,[('method',FIB,m_fib),('method',LOOPI,m_loopi),('method',LOOPD,m_loopd),
+   ('method',WIDE,m_wide)]))
+A.scripts.append((m_script,[('class',BENCH,0,1)]))
+
+S = [('getlocal_0',),('pushscope',)]
+A.body(m_script, S+[('getscopeobject',0),('getlex',OBJ),('newclass',0),('initproperty',BENCH),('returnvoid',)],1)
+A.body(m_iinit, [('getlocal_0',),('constructsuper',0),('returnvoid',)],1)
+A.body(m_cinit, [('returnvoid',)],1)
+
+# fib(n) = n<2 ? n : fib(n-1)+fib(n-2)
+A.body(m_fib, S+[('getlocal_1',),('pushbyte',2),('ifnlt','L'),('getlocal_1',),('returnvalue',),('label','L'),
+   ('findpropstrict',FIB),('getlocal_1',),('decrement_i',),('callproperty',FIB,1),
+   ('findpropstrict',FIB),('getlocal_1',),('pushbyte',2),('subtract_i',),('callproperty',FIB,1),
+   ('add',),('convert_i',),('returnvalue',)],2)
+
+# for(i=0;i<n;i++) followed by return s, around the given body
+def loop(body,init):
+   return init+[('setlocal_2',),('pushbyte',0),('setlocal_3',),('jump','C'),('label','B')]+body+[
+      ('inclocal_i',3),('label','C'),('getlocal_3',),('getlocal_1',),('iflt','B'),
+      ('getlocal_2',),('returnvalue',)]
+
+# loopi(n): s = (s ^ i*7) + i
+A.body(m_loopi, loop([('getlocal_2',),('getlocal_3',),('pushbyte',7),('multiply_i',),('bitxor',),
+   ('getlocal_3',),('add_i',),('setlocal_2',)],[('pushbyte',0)]),4)
+
+# loopd(n): s += i*0.5
+A.body(m_loopd, loop([('getlocal_2',),('getlocal_3',),('pushdouble',A.double(0.5)),('multiply',),('add',),
+   ('setlocal_2',)],[('pushbyte',0),('convert_d',)]),4)
+
+# wide(n): the last of 4000 locals holds n.  The declared stack depth is far more than
+#  the code uses, and must not count towards the frame.
+A.body(m_wide, [('getlocal_1',),('setlocal',3999),('getlocal',3999),('increment_i',),('returnvalue',)],4000,
+   max_stack=60000)
+
+out = sys.argv[1] if len(sys.argv)>1 else 'Bench.abc'
+open(out,'wb').write(A.build())
+
+# A Refused class with a fine method ok(n), and bad(n) built from inBad
+def refused(inName,inBad,inMaxStack=16):
+   R = Asm()
+   OBJ = R.qname('Object'); REFUSED = R.qname('Refused')
+   m_script = R.method(0,'script')
+   m_iinit = R.method(0,'Refused')
+   m_cinit = R.method(0,'Refused$cinit')
+   m_ok = R.method(1,'ok')
+   m_bad = R.method(1,'bad')
+   m_inner = R.method(0,'inner')
+   R.instances.append((REFUSED,OBJ,m_iinit,[]))
+   R.classes.append((m_cinit,[('method',R.qname('ok'),m_ok),('method',R.qname('bad'),m_bad)]))
+   R.scripts.append((m_script,[('class',REFUSED,0,1)]))
+   R.body(m_script, S+[('getscopeobject',0),('getlex',OBJ),('newclass',0),('initproperty',REFUSED),
+      ('returnvoid',)],1)
+   R.body(m_iinit, [('getlocal_0',),('constructsuper',0),('returnvoid',)],1)
+   R.body(m_cinit, [('returnvoid',)],1)
+   R.body(m_ok, [('getlocal_1',),('returnvalue',)],2)
+   R.body(m_inner, [('returnvoid',)],1)
+   R.body(m_bad, inBad(m_inner),2,max_stack=inMaxStack)
+   open(os.path.join(os.path.dirname(os.path.abspath(out)),inName),'wb').write(R.build())
+
+refused('Huge.abc', lambda inner: [('getlocal_1',),('returnvalue',)], 0x10000)
+refused('NewFunction.abc', lambda inner: [('newfunction',inner),('returnvalue',)])
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Builds the runtime with the ABC interpreter and runs AbcBench, which times the
+#  methods in Bench.abc against the same code compiled by C++, then checks that
+#  Huge.abc and NewFunction.abc are refused at load.
+# Extra compiler flags are passed on, eg. run.sh -DHXCPP_ABC_SWITCH_DISPATCH
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-"${TMPDIR:-/tmp}/hxcpp-abc-bench"}
+SUITE_FLAGS="-DHXCPP_SCRIPTABLE $*"
+SUITE_SOURCES="src/hx/Scriptable.cpp"
+. "$HERE/../common.sh"
+
+build_test AbcBench
+
+python3 "$HERE/GenBench.py" "$OUT/Bench.abc"
+"$OUT/AbcBench" "$OUT/Bench.abc" "$OUT/Huge.abc" "$OUT/NewFunction.abc"
@@ -0,0 +1,170 @@
+// Checks the typed array operations, including the entry points of the typed array
+//  wrappers (hxcpp.Int16Array etc).  Build with -DHXCPP_GC_MOVING as well, so callbacks
+//  that collect move the buffers being written.
+#include <hxcpp.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+
+// Collects on every call, and leaves garbage behind, so the collector has something to move
+struct CollectingDouble : public hx::Object
+{
+   Dynamic __run(const Dynamic &inValue)
+   {
+      for(int i=0;i<20;i++)
+         Array_obj<int>::__new(100,100);
+      __hxcpp_collect(true);
+      return (int)inValue * 2;
+   }
+};
+
+static double CollectingHalf(int inValue)
+{
+   __hxcpp_collect(true);
+   return inValue * 0.5;
+}
+
+static bool IsOdd(int inValue) { return inValue & 1; }
+static double Third(int inValue) { return inValue / 3.0; }
+
+// Counts the calls that come in boxed
+static int sBoxedCalls = 0;
+struct CountingOdd : public hx::TypedFunction1<bool,int>
+{
+   CountingOdd() : hx::TypedFunction1<bool,int>(IsOdd) { }
+   Dynamic __run(const Dynamic &inValue) { sBoxedCalls++; return IsOdd(inValue); }
+};
+
+static void TestMap()
+{
+   Array<int> source = Array_obj<int>::__new(0,0);
+   for(int i=0;i<50;i++)
+      source->push(i);
+
+   Dynamic doubled = source->map( new CollectingDouble() );
+   Array<Dynamic> result = doubled;
+   bool ok = result->length==50;
+   for(int i=0;ok && i<50;i++)
+      ok = (int)result[i]==i*2;
+   Check(ok,"map with a collecting callback");
+
+   Array<double> halves = source->mapTyped<double>(CollectingHalf);
+   ok = halves->length==50;
+   for(int i=0;ok && i<50;i++)
+      ok = halves[i]==i*0.5;
+   Check(ok,"mapTyped with a collecting callback");
+
+   Array<int> odd = source->filter( new CountingOdd() );
+   ok = odd->length==25 && sBoxedCalls==0;
+   for(int i=0;ok && i<25;i++)
+      ok = odd[i]==i*2+1;
+   Check(ok,"filter calls a typed function unboxed");
+
+   Dynamic third = hx::CreateTypedFunction1(Third);
+   Array<Dynamic> thirds = source->map(third);
+   ok = thirds->length==50 && (double)third(6)==2.0;
+   for(int i=0;ok && i<50;i++)
+      ok = (double)thirds[i]==i/3.0;
+   Check(ok,"map with a typed function");
+}
+
+
+// The typed array wrappers (hxcpp.Int16Array etc) use these entry points
+template<typename T>
+static bool Throws(Array<T> inArray,int inOp,int inPos,int inLen)
+{
+   try
+   {
+      switch(inOp)
+      {
+         case 0: inArray->__checked_get(inPos); break;
+         case 1: inArray->__checked_set(inPos,1); break;
+         case 2: inArray->__checked_fill(1,inPos,inLen); break;
+         case 3: inArray->__checked_blit(inPos,inArray,0,inLen); break;
+      }
+   }
+   catch(Dynamic e)
+   {
+      return true;
+   }
+   return false;
+}
+
+template<typename T,typename HAXE_TYPE>
+static void TestCompact(const char *inName,HAXE_TYPE inStored,T inExpect)
+{
+   char what[100];
+   Array<T> a = Array_obj<T>::__new(0,0);
+   a->__SetSizeExact(10);
+   sprintf(what,"%s is not scanned by the collector",inName);
+   Check(a->AllocAtomic() && a->GetElementSize()==sizeof(T),what);
+
+   a->__checked_set(3,(T)inStored);
+   a->__checked_fill((T)2,5,5);
+   a->__checked_blit(0,a,3,2);
+   __hxcpp_collect(true);
+   T expect[10] = { inExpect, 0, 0, inExpect, 0, 2, 2, 2, 2, 2 };
+   bool ok = a->length==10;
+   for(int i=0;ok && i<10;i++)
+      ok = a->__checked_get(i)==expect[i];
+   sprintf(what,"%s get/set/fill/blit",inName);
+   Check(ok,what);
+
+   sprintf(what,"%s range checks",inName);
+   Check( Throws(a,0,-1,0) && Throws(a,0,10,0) && Throws(a,1,-1,0) && Throws(a,1,10,0) &&
+          Throws(a,2,-1,2) && Throws(a,2,9,2) && Throws(a,3,-1,2) && Throws(a,3,9,2) &&
+          !Throws(a,2,8,2) && !Throws(a,3,8,2) && a->length==10, what);
+
+   Array<HAXE_TYPE> values = Array_obj<HAXE_TYPE>::__new(0,0);
+   values->push(inStored);
+   values->push(7);
+   Array<T> packed = Array_obj<T>::__new(0,0);
+   packed->__convert_from(values);
+   Array<HAXE_TYPE> back = Array_obj<HAXE_TYPE>::__new(0,0);
+   back->__convert_from(packed);
+   sprintf(what,"%s conversion",inName);
+   Check(packed->length==2 && packed[0]==inExpect && back->length==2 &&
+         back[0]==(HAXE_TYPE)inExpect && back[1]==7, what);
+}
+
+static void TestCompactTypes()
+{
+   TestCompact<signed char,int>("Int8Array",200,(signed char)-56);
+   TestCompact<short,int>("Int16Array",40000,(short)-25536);
+   TestCompact<unsigned short,int>("UInt16Array",-1,(unsigned short)65535);
+   TestCompact<float,double>("Float32Array",0.1,0.1f);
+}
+
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   TestMap();
+   TestCompactTypes();
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
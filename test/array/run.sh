@@ -0,0 +1,13 @@
+#!/bin/sh
+# Builds the runtime and runs ArrayTest, which checks the typed array operations.
+# Extra compiler flags are passed on, eg. run.sh -DHXCPP_GC_MOVING
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-"${TMPDIR:-/tmp}/hxcpp-array-test"}
+SUITE_FLAGS="$*"
+. "$HERE/../common.sh"
+
+build_test ArrayTest
+
+"$OUT/ArrayTest"
@@ -0,0 +1,37 @@
+# Shared by the run.sh scripts here, which set HERE and OUT, and optionally SUITE_FLAGS
+#  and SUITE_SOURCES, then source this.  It compiles the runtime into $OUT, listing the
+#  objects in RUNTIME, and defines build_test, which builds $HERE/<name>.cpp against them.
+
+HXCPP=$(cd "$HERE/../.." && pwd)
+mkdir -p "$OUT"
+
+case $(uname) in
+   Darwin) FLAGS="-DHX_MACOS" ;;
+   *) FLAGS="-DHX_LINUX" ;;
+esac
+if [ "$(getconf LONG_BIT)" = "64" ]; then
+   FLAGS="$FLAGS -DHXCPP_M64"
+fi
+FLAGS="$FLAGS -O2 -std=gnu++98 -DHX_UNDEFINE_H -DHXCPP_VISIT_ALLOCS $SUITE_FLAGS -I$HXCPP/include"
+case $(uname) in
+   Linux) LIBS="-lpthread -ldl -lrt" ;;
+   *) LIBS="-lpthread -ldl" ;;
+esac
+
+RUNTIME=""
+for f in src/hx/Anon.cpp src/hx/Boot.cpp src/hx/CFFI.cpp src/hx/Date.cpp src/hx/GC.cpp \
+         src/hx/GCInternal.cpp src/hx/Hash.cpp src/hx/Interface.cpp src/hx/Lib.cpp \
+         src/hx/Object.cpp src/hx/StdLibs.cpp src/hx/Debug.cpp src/hx/Thread.cpp \
+         src/hx/Fiber.cpp src/Array.cpp src/Class.cpp src/Dynamic.cpp src/Enum.cpp \
+         src/Math.cpp src/String.cpp $SUITE_SOURCES
+do
+   echo "Compiling $f"
+   ${CXX:-g++} $FLAGS -c "$HXCPP/$f" -o "$OUT/$(basename $f .cpp).o"
+   RUNTIME="$RUNTIME $OUT/$(basename $f .cpp).o"
+done
+
+build_test()
+{
+   ${CXX:-g++} $FLAGS -c "$HERE/$1.cpp" -o "$OUT/$1.obj"
+   ${CXX:-g++} -o "$OUT/$1" "$OUT/$1.obj" $RUNTIME $LIBS
+}
@@ -0,0 +1,107 @@
+// Times a call-heavy workload with the sampling profiler off and on.  Every call pushes a
+//  stack frame, as generated code does with HXCPP_STACK_TRACE, so this is the worst case
+//  for the profiler's cost.  Off and on runs alternate, each a few hundred ms, and the
+//  overhead is given from the fastest runs, the median runs and the median of the
+//  on/off ratios of neighbouring runs.
+#include <hxcpp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <sys/time.h>
+
+void __boot_all() { }
+
+static double Now()
+{
+   struct timeval tv;
+   gettimeofday(&tv,0);
+   return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+enum { DEPTH = 36, RUNS = 15 };
+
+static int Fib(int n)
+{
+   HX_STACK_FRAME("Bench","fib","Bench::fib",__FILE__,__LINE__)
+   return n<2 ? n : Fib(n-1) + Fib(n-2);
+}
+
+static double Time(int &outResult)
+{
+   double t0 = Now();
+   outResult = Fib(DEPTH);
+   return Now()-t0;
+}
+
+// Adds up the counts at the end of each collapsed-stack line
+static int CountSamples(const char *inFile)
+{
+   FILE *file = fopen(inFile,"rb");
+   if (!file)
+      return 0;
+   int samples = 0;
+   char line[4096];
+   while(fgets(line,sizeof(line),file))
+   {
+      const char *count = strrchr(line,' ');
+      if (count)
+         samples += atoi(count+1);
+   }
+   fclose(file);
+   return samples;
+}
+
+static double Median(double *ioTimes,int inCount)
+{
+   std::sort(ioTimes,ioTimes+inCount);
+   return inCount&1 ? ioTimes[inCount/2] : (ioTimes[inCount/2-1]+ioTimes[inCount/2])*0.5;
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void Run(const char *inDumpFile)
+{
+   HX_STACK_FRAME("Bench","run","Bench::run",__FILE__,__LINE__)
+   int result;
+   Time(result);
+
+   // Alternated, so drift in the machine's speed affects both alike
+   double off[RUNS];
+   double on[RUNS];
+   int samples = 0;
+   for(int r=0;r<RUNS;r++)
+   {
+      off[r] = Time(result);
+      __hxcpp_start_profiler(String(inDumpFile));
+      on[r] = Time(result);
+      __hxcpp_stop_profiler();
+      samples += CountSamples(inDumpFile);
+   }
+
+   // Each on run against the off run just before it, which shares its conditions
+   double ratio[RUNS];
+   for(int r=0;r<RUNS;r++)
+      ratio[r] = on[r]/off[r];
+   double medianRatio = Median(ratio,RUNS);
+
+   double bestOff = *std::min_element(off,off+RUNS);
+   double bestOn = *std::min_element(on,on+RUNS);
+   double medianOff = Median(off,RUNS);
+   double medianOn = Median(on,RUNS);
+   printf("%d runs of fib(%d) = %d each, %d samples taken\n", RUNS, DEPTH, result, samples);
+   printf("profiler off  best %7.1f ms  median %7.1f ms\n", bestOff*1000, medianOff*1000);
+   printf("profiler on   best %7.1f ms  median %7.1f ms\n", bestOn*1000, medianOn*1000);
+   printf("overhead      best %+6.1f%%    median %+6.1f%%    median of pairs %+6.1f%%\n",
+          (bestOn-bestOff)*100/bestOff, (medianOn-medianOff)*100/medianOff,
+          (medianRatio-1)*100);
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+   Run(argc>1 ? argv[1] : "/tmp/hxcpp-profile-bench.folded");
+   return 0;
+}
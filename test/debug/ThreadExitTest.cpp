@@ -0,0 +1,101 @@
+// Checks that a thread's call stack goes when the thread does: a profiler left running is
+//  stopped and written out, and many short threads with frames come and go cleanly.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+void __boot_all() { }
+
+enum { THREADS = 200 };
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+static char gDumpFile[256];
+static volatile int gExited = 0;
+
+static int Fib(int n)
+{
+   HX_STACK_FRAME("Test","fib","Test::fib",__FILE__,__LINE__)
+   return n<2 ? n : Fib(n-1) + Fib(n-2);
+}
+
+// Starts the profiler and returns without stopping it
+struct Profiled : public hx::Object
+{
+   Dynamic __run()
+   {
+      HX_STACK_FRAME("Test","profiled","Test::profiled",__FILE__,__LINE__)
+      __hxcpp_start_profiler(String(gDumpFile));
+      Fib(25);
+      return null();
+   }
+};
+
+struct Short : public hx::Object
+{
+   Dynamic __run()
+   {
+      HX_STACK_FRAME("Test","short","Test::short",__FILE__,__LINE__)
+      Fib(10);
+      HxAtomicAdd(&gExited,1);
+      return null();
+   }
+};
+
+static bool WaitForFile(const char *inFile)
+{
+   hx::EnterGCFreeZone();
+   bool found = false;
+   for(int wait=0; !found && wait<10000; wait++)
+   {
+      found = access(inFile,F_OK)==0;
+      if (!found)
+         usleep(1000);
+   }
+   hx::ExitGCFreeZone();
+   return found;
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   sprintf(gDumpFile,"%s/hxcpp-thread-exit-%d.folded", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp",
+           (int)getpid());
+   unlink(gDumpFile);
+   __hxcpp_thread_create(new Profiled());
+   Check(WaitForFile(gDumpFile),"a profiler left running is written when its thread exits");
+   unlink(gDumpFile);
+
+   for(int i=0;i<THREADS;i++)
+      __hxcpp_thread_create(new Short());
+   hx::EnterGCFreeZone();
+   for(int wait=0; gExited<THREADS && wait<10000; wait++)
+      usleep(1000);
+   hx::ExitGCFreeZone();
+   __hxcpp_collect(true);
+   Check(gExited==THREADS,"short threads with frames exit");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Builds the runtime with HXCPP_STACK_TRACE and runs ThreadExitTest, then ProfileBench,
+#  which times the same calls with the sampling profiler off and on.  An argument names the collapsed-stack
+#  file the profiler writes, eg. run.sh /tmp/bench.folded
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-"${TMPDIR:-/tmp}/hxcpp-debug-test"}
+SUITE_FLAGS="-DHXCPP_STACK_TRACE"
+. "$HERE/../common.sh"
+
+for t in ThreadExitTest ProfileBench
+do
+   build_test $t
+done
+
+"$OUT/ThreadExitTest"
+"$OUT/ProfileBench" "$@"
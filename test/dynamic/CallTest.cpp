@@ -0,0 +1,93 @@
+// Checks calling generated closures with more than five arguments, which go through the
+//  argument span entry point rather than an argument array.
+#include <hxcpp.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+// Written the way generated code declares a class with dynamic member and static functions
+class Summer_obj : public hx::Object
+{
+public:
+   int mBase;
+
+   Summer_obj(int inBase) : mBase(inBase) { }
+
+   int sum(Dynamic a,Dynamic b,Dynamic c,Dynamic d,Dynamic e,Dynamic f,Dynamic g)
+   {
+      return mBase + a + b*10 + c*100 + d*1000 + e*10000 + f*100000 + (g==null() ? 0 : g*1000000);
+   }
+   Dynamic sum_dyn();
+
+   static int weigh(Dynamic a,Dynamic b,Dynamic c,Dynamic d,Dynamic e,Dynamic f)
+   {
+      return a + b*2 + c*3 + d*4 + e*5 + f*6;
+   }
+   static Dynamic weigh_dyn();
+};
+
+HX_DEFINE_DYNAMIC_FUNC7(Summer_obj,sum,return)
+STATIC_HX_DEFINE_DYNAMIC_FUNC6(Summer_obj,weigh,return)
+
+HX_BEGIN_LOCAL_FUNC_S1(hx::LocalFunc,_Function_1_1,int,offset)
+int __ArgCount() const { return 6; }
+Dynamic run(Dynamic a,Dynamic b,Dynamic c,Dynamic d,Dynamic e,Dynamic f)
+{
+   return offset + a + b + c + d + e + f;
+}
+HX_END_LOCAL_FUNC6(return)
+
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   Dynamic summer = new Summer_obj(7);
+   Dynamic sum = ((Summer_obj *)summer.mPtr)->sum_dyn();
+   __hxcpp_collect(true);
+   Check( (int)sum(1,2,3,4,5,6,7)==7654328, "member closure called through Dynamic");
+
+   Dynamic args[7] = { 1, 2, 3, 4, 5, 6, 7 };
+   Check( (int)hx::RunArgs(sum.mPtr,args,7)==7654328, "member closure called with a span");
+   Check( (int)hx::RunArgs(sum.mPtr,args,6)==654328,
+          "member closure called with too few arguments gets null for the rest");
+
+   Array<Dynamic> arr = Array_obj<Dynamic>::__new(0,7);
+   for(int i=0;i<7;i++)
+      arr->push(args[i]);
+   Check( (int)sum->__Run(arr)==7654328, "member closure called with an array");
+
+   Dynamic weigh = Summer_obj::weigh_dyn();
+   Check( (int)weigh(1,1,1,1,1,2)==27, "static closure called through Dynamic");
+   Check( (int)hx::RunArgs(weigh.mPtr,args,6)==91, "static closure called with a span");
+
+   Dynamic local = new _Function_1_1(100);
+   __hxcpp_collect(true);
+   Check( (int)local(1,2,3,4,5,6)==121, "local function called through Dynamic");
+   Check( (int)hx::RunArgs(local.mPtr,args,6)==121, "local function called with a span");
+   Check( (int)local->__Run(arr)==121, "local function called with an array");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
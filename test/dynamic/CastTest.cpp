@@ -0,0 +1,64 @@
+// Checks hx::DynamicCast against dynamic_cast, for more classes than the cache has slots for
+//  a single vtable, for failed casts, and for casts that adjust the pointer.
+#include <hxcpp.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+struct Base : public hx::Object { };
+template<int N> struct Derived : public Base { };
+
+// An interface that is not the primary base, so the cast moves the pointer
+struct Extra { virtual int extra() { return 1; } };
+struct Both : public hx::Object, public Extra { };
+
+template<int N>
+static void CheckClass(hx::Object *inObj)
+{
+   Check(hx::DynamicCast< Derived<N> >(inObj)==dynamic_cast< Derived<N> *>(inObj),"exact class");
+   Check(hx::DynamicCast<Base>(inObj)==dynamic_cast<Base *>(inObj),"base class");
+   Check(hx::DynamicCast<Both>(inObj)==0,"failed cast");
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   hx::Object *objs[8] = { new Derived<0>(), new Derived<1>(), new Derived<2>(), new Derived<3>(),
+                           new Derived<4>(), new Derived<5>(), new Derived<6>(), new Derived<7>() };
+   // Twice, so the second pass comes from the cache
+   for(int pass=0;pass<2;pass++)
+   {
+      CheckClass<0>(objs[0]); CheckClass<1>(objs[1]); CheckClass<2>(objs[2]); CheckClass<3>(objs[3]);
+      CheckClass<4>(objs[4]); CheckClass<5>(objs[5]); CheckClass<6>(objs[6]); CheckClass<7>(objs[7]);
+      Check(hx::DynamicCast< Derived<1> >(objs[0])==0,"sibling class");
+
+      Both *both = new Both();
+      Check(hx::DynamicCast<Extra>((hx::Object *)both)==static_cast<Extra *>(both),"adjusted cast");
+      Check(hx::DynamicCast<Base>((hx::Object *)both)==0,"adjusted failed cast");
+   }
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
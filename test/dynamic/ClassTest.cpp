@@ -0,0 +1,107 @@
+// Checks constructing classes from an argument span, including a constructor that keeps
+//  its argument array and one with its own span entry.
+#include <hxcpp.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+// Keeps the array it was constructed with, as a constructor forwarding its args might
+struct Keeper : public hx::Object
+{
+   Array<Dynamic> mArgs;
+
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_MEMBER(mArgs); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER(mArgs); }
+   #endif
+
+   static Dynamic CreateEmpty() { return new Keeper(); }
+   static Dynamic Create(hx::DynamicArray inArgs)
+   {
+      Keeper *result = new Keeper();
+      result->mArgs = inArgs;
+      return result;
+   }
+};
+
+// Only reads its arguments, so it can be built straight from a span
+struct Pair : public hx::Object
+{
+   int mA;
+   int mB;
+
+   static int sArrayCalls;
+
+   static Dynamic CreateEmpty() { return new Pair(); }
+   static Dynamic Create(hx::DynamicArray inArgs)
+   {
+      sArrayCalls++;
+      return CreateSpan(&inArgs[0],inArgs->length);
+   }
+   static Dynamic CreateSpan(const Dynamic *inArgs,int inArgCount)
+   {
+      Pair *result = new Pair();
+      result->mA = inArgs[0];
+      result->mB = inArgs[1];
+      return result;
+   }
+};
+int Pair::sArrayCalls = 0;
+
+static String sNoFields[] = { String(null()) };
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   Class keeper = hx::RegisterClass(HX_CSTRING("Keeper"),hx::TCanCast<Keeper>,sNoFields,sNoFields,
+                                    Keeper::CreateEmpty,Keeper::Create,0);
+   Check(Class_obj::Resolve(HX_CSTRING("Keeper")).mPtr==keeper.mPtr,"resolve by name");
+
+   Dynamic first[2] = { 1, HX_CSTRING("a") };
+   Keeper *a = (Keeper *)keeper->ConstructArgs(first,2).mPtr;
+   Dynamic second[2] = { 2, HX_CSTRING("b") };
+   Keeper *b = (Keeper *)keeper->ConstructArgs(second,2).mPtr;
+   __hxcpp_collect(true);
+   Check(a->mArgs.mPtr!=b->mArgs.mPtr,"each construction gets its own argument array");
+   Check(a->mArgs->length==2 && (int)a->mArgs[0]==1 && (String)a->mArgs[1]==HX_CSTRING("a"),
+         "kept arguments survive the next construction");
+   Check(b->mArgs->length==2 && (int)b->mArgs[0]==2 && (String)b->mArgs[1]==HX_CSTRING("b"),
+         "span arguments");
+
+   Array<Dynamic> args = Array_obj<Dynamic>::__new(0,0);
+   args->push(3);
+   Keeper *c = (Keeper *)keeper->ConstructArgs(args).mPtr;
+   Check(c->mArgs.mPtr==args.mPtr,"an argument array is passed straight through");
+
+   Class pair = hx::RegisterClass(HX_CSTRING("Pair"),hx::TCanCast<Pair>,sNoFields,sNoFields,
+                                  Pair::CreateEmpty,Pair::Create,0);
+   pair->mConstructSpan = Pair::CreateSpan;
+   Dynamic pairArgs[2] = { 3, 4 };
+   Pair *p = (Pair *)pair->ConstructArgs(pairArgs,2).mPtr;
+   Check(p->mA==3 && p->mB==4 && Pair::sArrayCalls==0,"span entry builds without an array");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+#!/bin/sh
+# Builds the runtime and runs CastTest, ClassTest and CallTest
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-"${TMPDIR:-/tmp}/hxcpp-dynamic-test"}
+. "$HERE/../common.sh"
+
+for t in CastTest ClassTest CallTest
+do
+   build_test $t
+done
+
+"$OUT/CastTest"
+"$OUT/ClassTest"
+"$OUT/CallTest"
@@ -0,0 +1,216 @@
+// Checks the 64-bit atomics from several threads at once: add, cas and exchange, with
+//  values that carry between the 32-bit halves, and loads that must never see a torn
+//  value.  Both the HxAtomic*64 helpers and the hxcpp.AtomicInt64 entry points, which
+//  pass values as [high,low] halves.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+enum { THREADS = 4, ROUNDS = 100000 };
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+static const long long HIGH = 1LL<<32;
+
+static Dynamic gDone;
+static Dynamic gAtomic;
+static volatile long long gValue = 0;
+static volatile int gTorn = 0;
+static volatile int gStop = 0;
+// What each thread got back from its exchanges
+static long long gExchanged[THREADS];
+
+typedef void (*ThreadBody)(int inIndex);
+
+struct Runner : public hx::Object
+{
+   ThreadBody mBody;
+   int mIndex;
+   Runner(ThreadBody inBody,int inIndex) : mBody(inBody), mIndex(inIndex) { }
+   Dynamic __run()
+   {
+      mBody(mIndex);
+      __hxcpp_latch_count_down(gDone);
+      return null();
+   }
+};
+
+static bool RunThreads(ThreadBody inBody,int inThreads)
+{
+   gDone = __hxcpp_latch_create(inThreads);
+   for(int i=0;i<inThreads;i++)
+      __hxcpp_thread_create( new Runner(inBody,i) );
+   return __hxcpp_latch_wait(gDone,60);
+}
+
+
+static void AddBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS;i++)
+      HxAtomicAdd64(&gValue,HIGH+1);
+}
+
+static long long Join(Array<int> inHalves)
+{
+   return (long long)( ((unsigned long long)(unsigned int)inHalves[0]<<32) | (unsigned int)inHalves[1] );
+}
+static int High(long long inValue) { return (int)(inValue>>32); }
+static int Low(long long inValue) { return (int)inValue; }
+
+static void AddDynamicBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS;i++)
+      __hxcpp_atomic_int64_add(gAtomic,High(HIGH+1),Low(HIGH+1));
+}
+
+// Increments through a cas loop, starting just below the carry into the high word
+static void CasBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS;i++)
+   {
+      long long old;
+      do { old = HxAtomicLoad64(&gValue); } while(!HxAtomicCas64(&gValue,old,old+1));
+   }
+}
+
+static void CasDynamicBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS;i++)
+   {
+      long long old;
+      do { old = Join(__hxcpp_atomic_int64_load(gAtomic)); }
+      while(!__hxcpp_atomic_int64_cas(gAtomic,High(old),Low(old),High(old+1),Low(old+1)));
+   }
+}
+
+// Each thread swaps in its own values, one per round - high word the thread, low word
+//  the round.  Together with the final value, the values swapped out must be exactly
+//  the ones swapped in plus the initial one.
+static long long ExchangeValue(int inThread,int inRound) { return (inThread+1)*HIGH + inRound; }
+
+static void ExchangeBody(int inIndex)
+{
+   long long sum = 0;
+   for(int i=0;i<ROUNDS;i++)
+   {
+      long long old = HxAtomicExchange64(&gValue,ExchangeValue(inIndex,i));
+      if (old!=0 && (old/HIGH<1 || old/HIGH>THREADS || old%HIGH>=ROUNDS))
+         HxAtomicAdd(&gTorn,1);
+      sum += old;
+   }
+   gExchanged[inIndex] = sum;
+}
+
+static void ExchangeDynamicBody(int inIndex)
+{
+   long long sum = 0;
+   for(int i=0;i<ROUNDS;i++)
+   {
+      long long value = ExchangeValue(inIndex,i);
+      sum += Join(__hxcpp_atomic_int64_exchange(gAtomic,High(value),Low(value)));
+   }
+   gExchanged[inIndex] = sum;
+}
+
+static bool ExchangesMatch(long long inFinal)
+{
+   long long in = 0;
+   long long out = inFinal;
+   for(int t=0;t<THREADS;t++)
+   {
+      for(int i=0;i<ROUNDS;i++)
+         in += ExchangeValue(t,i);
+      out += gExchanged[t];
+   }
+   return in==out;
+}
+
+// Thread 0 flips the value between all bits clear and all bits set, the others load it
+static void TearBody(int inIndex)
+{
+   if (inIndex==0)
+   {
+      for(int i=0;i<ROUNDS*10;i++)
+         HxAtomicExchange64(&gValue,(i&1) ? -1 : 0);
+      gStop = 1;
+      return;
+   }
+   while(!gStop)
+   {
+      long long value = HxAtomicLoad64(&gValue);
+      if (value!=0 && value!=-1)
+         HxAtomicAdd(&gTorn,1);
+   }
+}
+
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   long long expect = (long long)THREADS*ROUNDS*(HIGH+1);
+
+   gValue = 0;
+   Check(RunThreads(AddBody,THREADS) && gValue==expect,"HxAtomicAdd64 from several threads");
+   gAtomic = __hxcpp_atomic_int64_create(0,0);
+   Check(RunThreads(AddDynamicBody,THREADS) && Join(__hxcpp_atomic_int64_load(gAtomic))==expect,
+         "AtomicInt64.add from several threads");
+
+   long long start = HIGH-(THREADS*ROUNDS)/2;
+   gValue = start;
+   Check(RunThreads(CasBody,THREADS) && gValue==start+THREADS*ROUNDS,
+         "HxAtomicCas64 increments from several threads");
+   gAtomic = __hxcpp_atomic_int64_create(High(start),Low(start));
+   Check(RunThreads(CasDynamicBody,THREADS) &&
+         Join(__hxcpp_atomic_int64_load(gAtomic))==start+THREADS*ROUNDS,
+         "AtomicInt64.cas increments from several threads");
+
+   gValue = 0;
+   gTorn = 0;
+   Check(RunThreads(ExchangeBody,THREADS) && gTorn==0 && ExchangesMatch(gValue),
+         "HxAtomicExchange64 from several threads");
+   gAtomic = __hxcpp_atomic_int64_create(0,0);
+   Check(RunThreads(ExchangeDynamicBody,THREADS) &&
+         ExchangesMatch(Join(__hxcpp_atomic_int64_load(gAtomic))),
+         "AtomicInt64.exchange from several threads");
+
+   // Beyond 2^53, where a double would round
+   long long big = (1LL<<62) + 1;
+   gAtomic = __hxcpp_atomic_int64_create(High(big),Low(big));
+   Check(Join(__hxcpp_atomic_int64_add(gAtomic,0,1))==big &&
+         Join(__hxcpp_atomic_int64_load(gAtomic))==big+1 &&
+         __hxcpp_atomic_int64_cas(gAtomic,High(big+1),Low(big+1),-1,-2) &&
+         Join(__hxcpp_atomic_int64_load(gAtomic))==-2,
+         "AtomicInt64 keeps all 64 bits");
+
+   gValue = 0;
+   gTorn = 0;
+   gStop = 0;
+   Check(RunThreads(TearBody,THREADS) && gTorn==0,"HxAtomicLoad64 never sees half a store");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+   hx::GCAddRoot(&gDone.mPtr);
+   hx::GCAddRoot(&gAtomic.mPtr);
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
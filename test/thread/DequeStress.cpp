@@ -0,0 +1,141 @@
+// Producers feed a deque while this thread pops it, blocking.  Run for a number of
+//  rounds, since a lost wakeup only shows up now and again.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+void __boot_all() { }
+
+enum { PRODUCERS = 4, ITEMS = 300000 };
+
+static Dynamic gQueue;
+static Dynamic gConsumer;
+static bool gMessages = false;
+static bool gFront = false;
+static volatile int gPopped = 0;
+static int gTimeout = 120;
+
+struct Producer : public hx::Object
+{
+   int mBase;
+
+   Producer(int inBase) : mBase(inBase) { }
+
+   Dynamic __run()
+   {
+      for(int i=0;i<ITEMS;i++)
+         if (gMessages)
+            __hxcpp_thread_send(gConsumer, Dynamic(mBase+i));
+         else if (gFront)
+            __hxcpp_deque_push(gQueue, Dynamic(mBase+i));
+         else
+            __hxcpp_deque_add(gQueue, Dynamic(mBase+i));
+      // null marks the end of this producer
+      if (gMessages)
+         __hxcpp_thread_send(gConsumer, null());
+      else if (gFront)
+         __hxcpp_deque_push(gQueue, null());
+      else
+         __hxcpp_deque_add(gQueue, null());
+      return null();
+   }
+};
+
+// Not a GC thread - just gives up if the consumer stops making progress
+static void *Watchdog(void *)
+{
+   int last = -1;
+   for(int waited=0; ; waited++)
+   {
+      sleep(1);
+      if (gPopped!=last)
+      {
+         last = gPopped;
+         waited = 0;
+      }
+      else if (waited>=gTimeout)
+      {
+         printf("No progress for %ds after %d items - hung\n", gTimeout, last);
+         fflush(stdout);
+         _exit(2);
+      }
+   }
+   return 0;
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static bool Round(const char *inName,int inRound)
+{
+   for(int p=0;p<PRODUCERS;p++)
+      __hxcpp_thread_create( new Producer(p*ITEMS) );
+
+   long long sum = 0;
+   int count = 0;
+   // Pushed to the front, a producer's null can come out before the others' items
+   for(int ended=0; ended<PRODUCERS || count<PRODUCERS*ITEMS; )
+   {
+      Dynamic v = gMessages ? __hxcpp_thread_read_message(true) : __hxcpp_deque_pop(gQueue,true);
+      if (!v.mPtr)
+         ended++;
+      else
+      {
+         sum += (int)v;
+         count++;
+         gPopped++;
+      }
+   }
+
+   long long n = (long long)PRODUCERS*ITEMS;
+   long long expect = n*(n-1)/2;
+   bool ok = count==PRODUCERS*ITEMS && sum==expect &&
+             (gMessages ? __hxcpp_thread_read_message(false) : __hxcpp_deque_pop(gQueue,false)).mPtr==0;
+   if (!ok)
+      printf("%s round %d: got %d items, sum %lld, expected %lld\n", inName, inRound, count, sum, expect);
+   return ok;
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   int rounds = argc>1 ? atoi(argv[1]) : 20;
+   if (argc>2)
+      gTimeout = atoi(argv[2]);
+   pthread_t watchdog;
+   pthread_create(&watchdog,0,Watchdog,0);
+
+   hx::GCAddRoot(&gQueue.mPtr);
+   hx::GCAddRoot(&gConsumer.mPtr);
+   gConsumer = __hxcpp_thread_current();
+
+   int failed = 0;
+   for(int r=0;r<rounds;r++)
+   {
+      gMessages = false;
+      gQueue = __hxcpp_deque_create();
+      failed += !Round("deque",r);
+
+      gQueue = __hxcpp_deque_create(64);
+      failed += !Round("bounded",r);
+
+      gQueue = __hxcpp_deque_create(0,true);
+      failed += !Round("single-consumer",r);
+
+      gFront = true;
+      gQueue = __hxcpp_deque_create();
+      failed += !Round("front",r);
+      gFront = false;
+
+      gMessages = true;
+      failed += !Round("messages",r);
+   }
+   printf("%d rounds, %d failed\n", rounds, failed);
+   return failed ? 1 : 0;
+}
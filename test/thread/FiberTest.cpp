@@ -0,0 +1,170 @@
+// Checks that the collector keeps what is only referenced from suspended stacks: several
+//  fibers suspended at once, a resumer suspended while its fiber collects, and another
+//  thread collecting while fibers switch.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+enum { FIBERS = 8, YIELDS = 20, VALUES = 1000 };
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+// Leaves garbage of the same shape behind, so anything collected by mistake is reused
+static void Churn()
+{
+   for(int i=0;i<200;i++)
+   {
+      Array<int> junk = Array_obj<int>::__new(VALUES,VALUES);
+      for(int j=0;j<VALUES;j++)
+         junk[j] = -1;
+   }
+}
+
+static Array<int> MakeValues(int inSeed)
+{
+   Array<int> values = Array_obj<int>::__new(VALUES,VALUES);
+   for(int i=0;i<VALUES;i++)
+      values[i] = inSeed*VALUES + i;
+   return values;
+}
+
+static bool ValuesOk(Array<int> inValues,int inSeed)
+{
+   if (inValues->length!=VALUES)
+      return false;
+   for(int i=0;i<VALUES;i++)
+      if (inValues[i]!=inSeed*VALUES + i)
+         return false;
+   return true;
+}
+
+// Holds its values only in locals on its own stack across every yield
+struct Body : public hx::Object
+{
+   int mSeed;
+   bool mCollect;
+   Body(int inSeed,bool inCollect) : mSeed(inSeed), mCollect(inCollect) { }
+   Dynamic __run()
+   {
+      Array<int> values = MakeValues(mSeed);
+      String name = String(mSeed) + HX_CSTRING("-fiber");
+      int good = 0;
+      for(int y=0;y<YIELDS;y++)
+      {
+         __hxcpp_fiber_yield(mSeed);
+         Churn();
+         if (mCollect)
+            __hxcpp_collect(true);
+         if (ValuesOk(values,mSeed) && name==String(mSeed) + HX_CSTRING("-fiber"))
+            good++;
+      }
+      return good;
+   }
+};
+
+
+static volatile bool gStop = false;
+static Dynamic gDone;
+
+struct Collector : public hx::Object
+{
+   Dynamic __run()
+   {
+      while(!gStop)
+      {
+         Churn();
+         __hxcpp_collect(true);
+      }
+      __hxcpp_latch_count_down(gDone);
+      return null();
+   }
+};
+
+
+// Resumes every fiber (each already at its first yield) until they finish, checking
+//  what each returns
+static void RunFibers(Array<Dynamic> inFibers,const char *inWhat)
+{
+   bool yielded = true;
+   int good = 0;
+   for(int y=1;y<YIELDS;y++)
+      for(int f=0;f<FIBERS;f++)
+         yielded = yielded && (int)__hxcpp_fiber_resume(inFibers[f],null())==f;
+   for(int f=0;f<FIBERS;f++)
+      good += (int)__hxcpp_fiber_resume(inFibers[f],null());
+   char what[100];
+   sprintf(what,"%s - yields",inWhat);
+   Check(yielded,what);
+   sprintf(what,"%s - values on the fiber stacks",inWhat);
+   Check(good==FIBERS*YIELDS,what);
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   // Collect while all of them are suspended
+   Array<Dynamic> fibers = Array_obj<Dynamic>::__new(0,0);
+   for(int f=0;f<FIBERS;f++)
+      fibers->push( __hxcpp_fiber_create(new Body(f,false),0) );
+   for(int f=0;f<FIBERS;f++)
+      __hxcpp_fiber_resume(fibers[f],null());
+   for(int i=0;i<5;i++)
+   {
+      Churn();
+      __hxcpp_collect(true);
+   }
+   RunFibers(fibers,"collecting between resumes");
+
+   // The fibers collect, while this stack and the other fibers are suspended
+   Array<int> mine = MakeValues(99);
+   fibers = Array_obj<Dynamic>::__new(0,0);
+   for(int f=0;f<FIBERS;f++)
+      fibers->push( __hxcpp_fiber_create(new Body(f,true),0) );
+   for(int f=0;f<FIBERS;f++)
+      __hxcpp_fiber_resume(fibers[f],null());
+   RunFibers(fibers,"collecting inside fibers");
+   Check(ValuesOk(mine,99),"values on the resumer's stack");
+
+   // Another thread collects while the fibers switch
+   gStop = false;
+   gDone = __hxcpp_latch_create(1);
+   __hxcpp_thread_create(new Collector());
+   for(int round=0;round<5;round++)
+   {
+      fibers = Array_obj<Dynamic>::__new(0,0);
+      for(int f=0;f<FIBERS;f++)
+         fibers->push( __hxcpp_fiber_create(new Body(f,false),0) );
+      for(int f=0;f<FIBERS;f++)
+         __hxcpp_fiber_resume(fibers[f],null());
+      RunFibers(fibers,"collecting on another thread");
+   }
+   gStop = true;
+   __hxcpp_latch_wait(gDone,-1);
+   Check(ValuesOk(mine,99),"values on the resumer's stack after the thread");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+   hx::GCAddRoot(&gDone.mPtr);
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+// Checks the thread pool: futures, tasks waiting on subtasks, stealing from a blocked
+//  worker, idle workers parking, and shutdown draining the queues.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+void __boot_all() { }
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+struct Double : public hx::Object
+{
+   int mValue;
+   Double(int inValue) : mValue(inValue) { }
+   Dynamic __run() { return mValue*2; }
+};
+
+struct Fail : public hx::Object
+{
+   Dynamic __run() { hx::Throw(HX_CSTRING("failed")); return null(); }
+};
+
+// Sums its range by splitting it into subtasks and getting them
+struct SumRange : public hx::Object
+{
+   Dynamic mPool;
+   int mFrom, mTo;
+   SumRange(Dynamic inPool,int inFrom,int inTo) : mPool(inPool), mFrom(inFrom), mTo(inTo) { }
+   Dynamic __run()
+   {
+      if (mTo-mFrom<=16)
+      {
+         int sum = 0;
+         for(int i=mFrom;i<mTo;i++)
+            sum += i;
+         return sum;
+      }
+      int mid = (mFrom+mTo)/2;
+      Dynamic left = __hxcpp_pool_submit(mPool, new SumRange(mPool,mFrom,mid));
+      Dynamic right = __hxcpp_pool_submit(mPool, new SumRange(mPool,mid,mTo));
+      return (int)__hxcpp_future_get(left) + (int)__hxcpp_future_get(right);
+   }
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_MEMBER(mPool); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER(mPool); }
+   #endif
+};
+
+
+enum { SUBTASKS = 8 };
+static pthread_t gRanOn[SUBTASKS];
+static volatile int gSubtasksDone = 0;
+
+struct Record : public hx::Object
+{
+   int mSlot;
+   Record(int inSlot) : mSlot(inSlot) { }
+   Dynamic __run()
+   {
+      gRanOn[mSlot] = pthread_self();
+      HxAtomicAdd(&gSubtasksDone,1);
+      return null();
+   }
+};
+
+// Queues its subtasks on its own worker, then blocks without helping - so they only
+//  run if the other workers steal them
+struct Blocker : public hx::Object
+{
+   Dynamic mPool;
+   Blocker(Dynamic inPool) : mPool(inPool) { }
+   Dynamic __run()
+   {
+      for(int i=0;i<SUBTASKS;i++)
+         __hxcpp_pool_submit(mPool, new Record(i));
+      hx::EnterGCFreeZone();
+      for(int wait=0; gSubtasksDone<SUBTASKS && wait<10000; wait++)
+         usleep(1000);
+      hx::ExitGCFreeZone();
+      bool stolen = gSubtasksDone==SUBTASKS;
+      for(int i=0;stolen && i<SUBTASKS;i++)
+         stolen = !pthread_equal(gRanOn[i],pthread_self());
+      return stolen;
+   }
+   void __Mark(hx::MarkContext *__inCtx) { HX_MARK_MEMBER(mPool); }
+   #ifdef HXCPP_VISIT_ALLOCS
+   void __Visit(hx::VisitContext *__inCtx) { HX_VISIT_MEMBER(mPool); }
+   #endif
+};
+
+
+static volatile int gSlowDone = 0;
+
+struct Slow : public hx::Object
+{
+   Dynamic __run()
+   {
+      hx::EnterGCFreeZone();
+      usleep(2000);
+      hx::ExitGCFreeZone();
+      HxAtomicAdd(&gSlowDone,1);
+      return null();
+   }
+};
+
+
+static double CpuSeconds()
+{
+   struct rusage usage;
+   getrusage(RUSAGE_SELF,&usage);
+   return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec*1e-6 +
+          usage.ru_stime.tv_sec + usage.ru_stime.tv_usec*1e-6;
+}
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   Dynamic pool = __hxcpp_pool_create(4);
+
+   Array<Dynamic> futures = Array_obj<Dynamic>::__new(0,0);
+   for(int i=0;i<1000;i++)
+      futures->push( __hxcpp_pool_submit(pool, new Double(i)) );
+   int sum = 0;
+   for(int i=0;i<1000;i++)
+      sum += (int)__hxcpp_future_get(futures[i]);
+   Check(sum==999*1000,"futures of submitted tasks");
+
+   Dynamic failed = __hxcpp_pool_submit(pool, new Fail());
+   bool threw = false;
+   try { __hxcpp_future_get(failed); }
+   catch(Dynamic e) { threw = (String)e==HX_CSTRING("failed"); }
+   Check(threw,"a failed task rethrows from get");
+
+   Dynamic promise = __hxcpp_future_create();
+   Check(!__hxcpp_future_done(promise) && __hxcpp_future_complete(promise,7,false) &&
+         !__hxcpp_future_complete(promise,8,false) && (int)__hxcpp_future_get(promise)==7,
+         "a promise completes once");
+
+   Check((int)__hxcpp_future_get(__hxcpp_pool_submit(pool, new SumRange(pool,0,4096)))==4095*4096/2,
+         "tasks getting their subtasks");
+
+   // Wait rather than get, which would run it here instead of on a worker
+   Dynamic blocker = __hxcpp_pool_submit(pool, new Blocker(pool));
+   hx::EnterGCFreeZone();
+   for(int wait=0; !__hxcpp_future_done(blocker) && wait<20000; wait++)
+      usleep(1000);
+   hx::ExitGCFreeZone();
+   Check(__hxcpp_future_done(blocker) && (bool)__hxcpp_future_get(blocker),
+         "idle workers steal from a blocked worker");
+
+   // Idle workers should be parked, not polling the queues
+   hx::EnterGCFreeZone();
+   usleep(50000);
+   double cpu = CpuSeconds();
+   usleep(200000);
+   cpu = CpuSeconds() - cpu;
+   hx::ExitGCFreeZone();
+   if (cpu>=0.05)
+      printf("Idle pool used %.3fs cpu in 0.2s\n", cpu);
+   Check(cpu<0.05,"idle workers park");
+
+   for(int i=0;i<100;i++)
+      __hxcpp_pool_submit(pool, new Slow());
+   __hxcpp_pool_shutdown(pool);
+   Check(gSlowDone==100,"shutdown runs the queued tasks before returning");
+
+   bool refused = false;
+   try { __hxcpp_pool_submit(pool, new Double(1)); }
+   catch(Dynamic e) { refused = true; }
+   Check(refused,"submit after shutdown throws");
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
@@ -0,0 +1,263 @@
+// Checks the FastMutex, RWLock, Condition and Latch under contention: mutual exclusion,
+//  readers never overlapping a writer, condition wakeups and latch release.
+#include <hxcpp.h>
+#include <hx/Thread.h>
+#include <stdio.h>
+
+void __boot_all() { }
+
+enum { THREADS = 4, ROUNDS = 100000 };
+
+static int gFailed = 0;
+
+static void Check(bool inOk,const char *inWhat)
+{
+   if (!inOk)
+   {
+      printf("FAILED: %s\n", inWhat);
+      gFailed++;
+   }
+}
+
+static Dynamic gLock;
+static Dynamic gCondition;
+static Dynamic gDone;
+static Dynamic gGate;
+
+// Plain ints - only the lock under test protects them
+static int gInside = 0;
+static int gCount = 0;
+static int gA = 0, gB = 0;
+static volatile int gReaders = 0;
+static volatile int gWriters = 0;
+static volatile int gViolations = 0;
+static int gQueued = 0;
+static int gTaken = 0;
+static bool gOpen = false;
+static volatile int gWoken = 0;
+
+typedef void (*ThreadBody)(int inIndex);
+
+struct Runner : public hx::Object
+{
+   ThreadBody mBody;
+   int mIndex;
+   Runner(ThreadBody inBody,int inIndex) : mBody(inBody), mIndex(inIndex) { }
+   Dynamic __run()
+   {
+      mBody(mIndex);
+      __hxcpp_latch_count_down(gDone);
+      return null();
+   }
+};
+
+// Starts inThreads threads running inBody, and waits for them all
+static bool RunThreads(ThreadBody inBody,int inThreads)
+{
+   gDone = __hxcpp_latch_create(inThreads);
+   for(int i=0;i<inThreads;i++)
+      __hxcpp_thread_create( new Runner(inBody,i) );
+   return __hxcpp_latch_wait(gDone,60);
+}
+
+
+static void MutexBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS;i++)
+   {
+      bool recurse = (i&7)==0;
+      if ( (i&3)==1 )
+      {
+         while(!__hxcpp_fast_mutex_try(gLock)) { }
+      }
+      else
+         __hxcpp_fast_mutex_acquire(gLock);
+      if (recurse)
+         __hxcpp_fast_mutex_acquire(gLock);
+      if (++gInside!=1)
+         HxAtomicAdd(&gViolations,1);
+      gCount++;
+      gInside--;
+      if (recurse)
+         __hxcpp_fast_mutex_release(gLock);
+      __hxcpp_fast_mutex_release(gLock);
+   }
+}
+
+static void TestMutex()
+{
+   gLock = __hxcpp_fast_mutex_create();
+   gViolations = gCount = 0;
+   Check(RunThreads(MutexBody,THREADS),"mutex threads finish");
+   Check(gViolations==0 && gCount==THREADS*ROUNDS,"mutex excludes other threads");
+
+   bool threw = false;
+   try { __hxcpp_fast_mutex_release(gLock); }
+   catch(Dynamic e) { threw = true; }
+   Check(threw,"releasing a mutex that is not held throws");
+}
+
+
+// Threads 0 and 1 write, the rest read
+static void RWBody(int inIndex)
+{
+   for(int i=0;i<ROUNDS/4;i++)
+   {
+      if (inIndex<2)
+      {
+         __hxcpp_rwlock_write_acquire(gLock);
+         if (HxAtomicAdd(&gWriters,1)!=0 || gReaders!=0)
+            HxAtomicAdd(&gViolations,1);
+         gA++;
+         gB++;
+         HxAtomicAdd(&gWriters,-1);
+         __hxcpp_rwlock_write_release(gLock);
+      }
+      else
+      {
+         __hxcpp_rwlock_read_acquire(gLock);
+         HxAtomicAdd(&gReaders,1);
+         if (gWriters!=0 || gA!=gB)
+            HxAtomicAdd(&gViolations,1);
+         HxAtomicAdd(&gReaders,-1);
+         __hxcpp_rwlock_read_release(gLock);
+      }
+   }
+}
+
+static void TestRWLock()
+{
+   gLock = __hxcpp_rwlock_create();
+   gViolations = gA = gB = 0;
+   Check(RunThreads(RWBody,THREADS+2),"rwlock threads finish");
+   Check(gViolations==0 && gA==2*(ROUNDS/4) && gB==gA,"readers never overlap a writer");
+}
+
+
+// Thread 0 produces one item at a time, the others wait for items.  A null item
+//  per consumer ends them.
+enum { ITEMS = 20000 };
+
+static void ConditionBody(int inIndex)
+{
+   if (inIndex==0)
+   {
+      for(int i=0;i<ITEMS+THREADS;i++)
+      {
+         __hxcpp_fast_mutex_acquire(gLock);
+         gQueued++;
+         __hxcpp_condition_signal(gCondition);
+         __hxcpp_fast_mutex_release(gLock);
+      }
+      return;
+   }
+   __hxcpp_fast_mutex_acquire(gLock);
+   while(true)
+   {
+      while(gQueued==0)
+         __hxcpp_condition_wait(gCondition,gLock,-1);
+      gQueued--;
+      if (++gTaken > ITEMS)
+         break;
+   }
+   __hxcpp_fast_mutex_release(gLock);
+}
+
+static void BroadcastBody(int inIndex)
+{
+   __hxcpp_fast_mutex_acquire(gLock);
+   __hxcpp_latch_count_down(gGate);
+   while(!gOpen)
+      __hxcpp_condition_wait(gCondition,gLock,-1);
+   HxAtomicAdd(&gWoken,1);
+   __hxcpp_fast_mutex_release(gLock);
+}
+
+static void TestCondition()
+{
+   gLock = __hxcpp_fast_mutex_create();
+   gCondition = __hxcpp_condition_create();
+   gQueued = gTaken = 0;
+   Check(RunThreads(ConditionBody,THREADS+1),"condition threads finish");
+   Check(gTaken==ITEMS+THREADS && gQueued==0,"signal wakes a waiter for each item");
+
+   __hxcpp_fast_mutex_acquire(gLock);
+   bool timedOut = !__hxcpp_condition_wait(gCondition,gLock,0.05);
+   __hxcpp_fast_mutex_release(gLock);
+   Check(timedOut,"an unsignalled wait times out");
+
+   // Every waiter is inside the mutex before the broadcast, so none can miss it
+   gGate = __hxcpp_latch_create(THREADS);
+   gOpen = false;
+   gWoken = 0;
+   gDone = __hxcpp_latch_create(THREADS);
+   for(int i=0;i<THREADS;i++)
+      __hxcpp_thread_create( new Runner(BroadcastBody,i) );
+   __hxcpp_latch_wait(gGate,-1);
+   __hxcpp_fast_mutex_acquire(gLock);
+   gOpen = true;
+   __hxcpp_condition_broadcast(gCondition);
+   __hxcpp_fast_mutex_release(gLock);
+   Check(__hxcpp_latch_wait(gDone,60) && gWoken==THREADS,"broadcast wakes every waiter");
+}
+
+
+static volatile int gWork[THREADS];
+
+static void LatchBody(int inIndex)
+{
+   for(int i=0;i<1000;i++)
+      gWork[inIndex]++;
+   __hxcpp_latch_count_down(gGate);
+}
+
+static void TestLatch()
+{
+   for(int round=0;round<100;round++)
+   {
+      gGate = __hxcpp_latch_create(THREADS);
+      for(int i=0;i<THREADS;i++)
+         gWork[i] = 0;
+      Check(RunThreads(LatchBody,THREADS),"latch threads finish");
+      bool released = __hxcpp_latch_wait(gGate,60) && __hxcpp_latch_count(gGate)==0;
+      for(int i=0;released && i<THREADS;i++)
+         released = gWork[i]==1000;
+      if (!released)
+      {
+         Check(false,"latch releases once every thread has counted down");
+         break;
+      }
+   }
+
+   Dynamic closed = __hxcpp_latch_create(1);
+   Check(!__hxcpp_latch_wait(closed,0.05) && __hxcpp_latch_count(closed)==1,
+         "a latch that is not counted down times out");
+}
+
+
+// Kept out of main, since the stack is only scanned below HX_TOP_OF_STACK
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void RunTests()
+{
+   TestMutex();
+   TestRWLock();
+   TestCondition();
+   TestLatch();
+}
+
+int main(int argc,char **argv)
+{
+   HX_TOP_OF_STACK
+   hx::Boot();
+   hx::GCAddRoot(&gLock.mPtr);
+   hx::GCAddRoot(&gCondition.mPtr);
+   hx::GCAddRoot(&gDone.mPtr);
+   hx::GCAddRoot(&gGate.mPtr);
+
+   RunTests();
+
+   printf("%s\n", gFailed ? "FAILED" : "All passed");
+   return gFailed ? 1 : 0;
+}
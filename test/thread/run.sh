@@ -0,0 +1,21 @@
+#!/bin/sh
+# Builds the runtime and runs SyncTest, AtomicTest, PoolTest and FiberTest, then
+#  DequeStress, which pushes 4 x 300000 items through each kind of deque, and onto
+#  the front of one, into a blocking pop.
+# Arguments are DequeStress's number of rounds and hang timeout in seconds, eg. run.sh 100 60
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-"${TMPDIR:-/tmp}/hxcpp-thread-test"}
+. "$HERE/../common.sh"
+
+for t in SyncTest AtomicTest PoolTest FiberTest DequeStress
+do
+   build_test $t
+done
+
+"$OUT/SyncTest"
+"$OUT/AtomicTest"
+"$OUT/PoolTest"
+"$OUT/FiberTest"
+"$OUT/DequeStress" "$@"